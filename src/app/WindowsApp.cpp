@@ -93,22 +93,19 @@ void WindowsApp::processEvent() {
     }
 }
 
-void WindowsApp::updateScreenSurface(
-    const std::vector<std::vector<color>> &canvas) {
+void WindowsApp::updateScreenSurface(const ImageView &canvas) {
     // Update pixels
-    int height = canvas.size();
-    int width = canvas[0].size();
+    int height = canvas.height;
+    int width = canvas.width;
     SDL_LockSurface(m_screen_surface);
     {
         Uint32 *destPixels = (Uint32 *)m_screen_surface->pixels;
         for (int j = 0; j < height; ++j) {
-            for (int i = 0; i < width; ++i) {
-                const auto &pixel = canvas[j][i];
-
-                Uint32 color = SDL_MapRGB(m_screen_surface->format,
-                                          static_cast<uint8_t>(pixel[0] * 255),
-                                          static_cast<uint8_t>(pixel[1] * 255),
-                                          static_cast<uint8_t>(pixel[2] * 255));
+            const float *pixel = canvas.row(j);
+            for (int i = 0; i < width; ++i, pixel += 3) {
+                Uint32 color = SDL_MapRGB(
+                    m_screen_surface->format, to_display_byte(pixel[0]),
+                    to_display_byte(pixel[1]), to_display_byte(pixel[2]));
                 destPixels[(height - 1 - j) * width + i] = color;
             }
         }
@@ -0,0 +1,274 @@
+#ifndef RENDER_OPTIONS_H
+#define RENDER_OPTIONS_H
+
+#include "hittable.h"
+#include "sampler.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 命令行参数。仍兼容旧的位置参数写法
+//   <scene> <integrator> <bvh builder> <threads> <pin>
+// 以 "--" 开头的为具名参数，见 print_render_usage。
+// 值为 0 / 空表示沿用场景配置或默认值
+struct RenderOptions {
+    int scene_id = 23;
+    // 0: Path, 1: RR, 2: PBR, 3: NEE, 4: MIS, 5: Wavefront (MIS)
+    int integrator_id = 4;
+    int bvh_builder_id = 0; // 0: SAH, 1: Random axis, 2: LBVH, 3: LBVH + SAH
+    int num_threads = 0;    // 0: 使用全部硬件线程
+    bool pin_threads = false;
+    int samples_per_pixel = 0; // 0: 使用场景的 samples_per_pixel
+    int width = 0;             // 只给宽度时按场景宽高比计算高度
+    int height = 0;
+    int max_depth = 50;
+    uint64_t seed = 0;
+    // 时间预算 (秒) 和噪声目标，大于 0 时生效，见 Renderer::Settings
+    double time_budget = 0.0;
+    double noise_target = 0.0;
+    bool headless = false;
+    bool sort_rays = false; // 波前积分器在求交前排序光线、着色前按材质排序
+    int packet_size = 0;    // 波前积分器的光线包大小：0 (逐条遍历)、8 或 16
+    bool aovs = false;      // 在 EXR 中附带全部 AOV，默认只输出颜色
+    bool denoise = false;   // 额外输出一张 AOV 引导的降噪结果
+    // 自适应采样，见 Renderer::Settings；关闭时每像素固定 spp 个样本
+    bool adaptive = false;
+    SamplerType sampler = SamplerType::independent;
+    // 输出文件名，不含扩展名时按 formats 逐个添加；为空时写到
+    // output/sceneXX_integratorY_<时间戳>
+    std::string output;
+    std::vector<std::string> formats; // png / jpg / pfm / exr
+    bool show_help = false;
+};
+
+inline void print_render_usage(const char *program) {
+    std::cout
+        << "Usage: " << program << " [scene [integrator [bvh [threads [pin]]]]]"
+        << " [options]\n"
+        << "  --scene N         scene id\n"
+        << "  --integrator N    0 path, 1 rr, 2 pbr, 3 nee, 4 mis,"
+        << " 5 wavefront\n"
+        << "  --bvh N           0 sah, 1 random axis, 2 lbvh, 3 lbvh + sah\n"
+        << "  --spp N           samples per pixel\n"
+        << "  --resolution WxH  image size (or --width W / --height H)\n"
+        << "  --threads N       worker threads, 0 = all hardware threads\n"
+        << "  --pin             pin worker threads to cores\n"
+        << "  --max-depth N     maximum path length\n"
+        << "  --seed N          random stream seed\n"
+        << "  --sampler NAME    independent (default), stratified, sobol"
+        << " or halton\n"
+        << "  --time-budget S   add passes until S seconds are spent\n"
+        << "  --noise-target E  stop once the mean relative error is below E\n"
+        << "  --output PATH     output file; extension selects the format\n"
+        << "  --format LIST     comma separated png,jpg,pfm,exr (default png)\n"
+        << "  --headless        render without opening a window\n"
+        << "  --sort-rays       wavefront: sort rays and hits per stage\n"
+        << "  --packet N        wavefront: trace camera / shadow rays in"
+        << " packets of N (8 or 16)\n"
+        << "  --aovs            write all AOV layers to the EXR output\n"
+        << "  --denoise         also write an AOV guided denoised png\n"
+        << "  --adaptive        spend the sample budget where the noise is\n"
+        << "  --help            print this message" << std::endl;
+}
+
+// 文件名的扩展名 (小写、不含点)，没有扩展名时返回空串
+inline std::string render_output_extension(const std::string &path) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos ||
+        (slash != std::string::npos && dot < slash)) {
+        return "";
+    }
+    std::string ext = path.substr(dot + 1);
+    for (char &c : ext) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return ext;
+}
+
+inline bool is_render_output_format(const std::string &format) {
+    return format == "png" || format == "jpg" || format == "pfm" ||
+           format == "exr";
+}
+
+inline bool parse_sampler_type(const std::string &name, SamplerType &type) {
+    if (name == "independent") {
+        type = SamplerType::independent;
+    } else if (name == "stratified") {
+        type = SamplerType::stratified;
+    } else if (name == "sobol") {
+        type = SamplerType::sobol;
+    } else if (name == "halton") {
+        type = SamplerType::halton;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 解析命令行，出错时打印原因并返回 false
+inline bool parse_render_options(int argc, char *argv[],
+                                 RenderOptions &options) {
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            // 旧的位置参数
+            switch (positional++) {
+            case 0:
+                options.scene_id = std::atoi(argv[i]);
+                break;
+            case 1:
+                options.integrator_id = std::atoi(argv[i]);
+                break;
+            case 2:
+                options.bvh_builder_id = std::atoi(argv[i]);
+                break;
+            case 3:
+                options.num_threads = std::atoi(argv[i]);
+                break;
+            case 4:
+                options.pin_threads = std::atoi(argv[i]) != 0;
+                break;
+            default:
+                std::cerr << "Unexpected argument: " << arg << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        if (arg == "--help") {
+            options.show_help = true;
+            continue;
+        }
+        if (arg == "--headless") {
+            options.headless = true;
+            continue;
+        }
+        if (arg == "--pin") {
+            options.pin_threads = true;
+            continue;
+        }
+        if (arg == "--sort-rays") {
+            options.sort_rays = true;
+            continue;
+        }
+        if (arg == "--aovs") {
+            options.aovs = true;
+            continue;
+        }
+        if (arg == "--denoise") {
+            options.denoise = true;
+            continue;
+        }
+        if (arg == "--adaptive") {
+            options.adaptive = true;
+            continue;
+        }
+
+        static const char *const value_options[] = {
+            "--scene",   "--integrator", "--bvh",  "--spp",
+            "--width",   "--height",     "--resolution",
+            "--threads", "--max-depth",  "--seed", "--time-budget",
+            "--noise-target", "--packet", "--sampler", "--output",
+            "--format"};
+        bool takes_value = false;
+        for (const char *name : value_options) {
+            takes_value = takes_value || arg == name;
+        }
+        if (!takes_value) {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        const char *value = argv[++i];
+        if (arg == "--scene") {
+            options.scene_id = std::atoi(value);
+        } else if (arg == "--integrator") {
+            options.integrator_id = std::atoi(value);
+        } else if (arg == "--bvh") {
+            options.bvh_builder_id = std::atoi(value);
+        } else if (arg == "--spp") {
+            options.samples_per_pixel = std::atoi(value);
+        } else if (arg == "--width") {
+            options.width = std::atoi(value);
+        } else if (arg == "--height") {
+            options.height = std::atoi(value);
+        } else if (arg == "--resolution") {
+            const char *x = std::strchr(value, 'x');
+            options.width = std::atoi(value);
+            options.height = x ? std::atoi(x + 1) : 0;
+        } else if (arg == "--threads") {
+            options.num_threads = std::atoi(value);
+        } else if (arg == "--max-depth") {
+            options.max_depth = std::atoi(value);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--time-budget") {
+            options.time_budget = std::atof(value);
+        } else if (arg == "--noise-target") {
+            options.noise_target = std::atof(value);
+        } else if (arg == "--packet") {
+            options.packet_size = std::atoi(value);
+        } else if (arg == "--sampler") {
+            if (!parse_sampler_type(value, options.sampler)) {
+                std::cerr << "Unknown sampler: " << value << std::endl;
+                return false;
+            }
+        } else if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--format") {
+            options.formats.clear();
+            std::string list = value;
+            size_t begin = 0;
+            while (begin <= list.size()) {
+                size_t end = list.find(',', begin);
+                if (end == std::string::npos) {
+                    end = list.size();
+                }
+                std::string format = list.substr(begin, end - begin);
+                if (!is_render_output_format(format)) {
+                    std::cerr << "Unknown output format: " << format
+                              << std::endl;
+                    return false;
+                }
+                options.formats.push_back(format);
+                begin = end + 1;
+            }
+        }
+    }
+
+    if (options.samples_per_pixel < 0 || options.width < 0 ||
+        options.height < 0 || options.max_depth < 1 ||
+        options.num_threads < 0 || options.time_budget < 0 ||
+        (options.packet_size != 0 && options.packet_size != 8 &&
+         options.packet_size != kMaxRayPacketSize) ||
+        options.noise_target < 0) {
+        std::cerr << "Invalid spp, resolution, thread count, max depth, "
+                     "budget or packet size"
+                  << std::endl;
+        return false;
+    }
+
+    // 输出格式：--format 优先，其次是 --output 的扩展名，默认只输出 png；
+    // HDR 结果 (pfm / exr) 需要显式指定
+    if (options.formats.empty()) {
+        std::string ext = render_output_extension(options.output);
+        if (is_render_output_format(ext)) {
+            options.formats.push_back(ext);
+        } else {
+            options.formats = {"png"};
+        }
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// C++14 的 std::allocator 不保证超过 16 字节的对齐，
+// BVH 节点、帧缓冲等需要按缓存行 / SIMD 宽度对齐的数组使用此分配器
+template <typename T, std::size_t Alignment> class aligned_allocator {
+  public:
+    using value_type = T;
+
+    template <typename U> struct rebind {
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() noexcept = default;
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment> &) noexcept {
+    }
+
+    T *allocate(std::size_t n) {
+        void *p = nullptr;
+#ifdef _WIN32
+        p = _aligned_malloc(n * sizeof(T), Alignment);
+#else
+        if (posix_memalign(&p, Alignment, n * sizeof(T)) != 0) {
+            p = nullptr;
+        }
+#endif
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, std::size_t) noexcept {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, Alignment> &) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const aligned_allocator<U, Alignment> &) const noexcept {
+        return false;
+    }
+};
+
+// 默认 32 字节对齐；元素类型要求更大的对齐 (如按缓存行对齐的 BVH 节点)
+// 时取元素的对齐
+template <typename T,
+          std::size_t Alignment = (alignof(T) > 32 ? alignof(T) : 32)>
+using aligned_vector = std::vector<T, aligned_allocator<T, Alignment>>;
+
+#endif
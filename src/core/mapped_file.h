@@ -0,0 +1,119 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <memory>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 只读内存映射文件。映射的生命周期由 shared_ptr 管理，
+// 直接引用映射内存的对象持有它即可保证数据有效
+class mapped_file {
+  public:
+    // 打开失败或文件为空时返回 nullptr
+    static std::shared_ptr<mapped_file> open(const char *path);
+
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    const char *data() const {
+        return static_cast<const char *>(address);
+    }
+    size_t size() const {
+        return length;
+    }
+
+  private:
+    mapped_file() = default;
+
+    void *address = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+};
+
+#ifdef _WIN32
+
+inline std::shared_ptr<mapped_file> mapped_file::open(const char *path) {
+    std::shared_ptr<mapped_file> result(new mapped_file());
+    result->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (result->file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(result->file, &file_size) || file_size.QuadPart == 0) {
+        return nullptr;
+    }
+    result->length = static_cast<size_t>(file_size.QuadPart);
+    result->mapping = CreateFileMappingA(result->file, nullptr, PAGE_READONLY,
+                                         0, 0, nullptr);
+    if (!result->mapping) {
+        return nullptr;
+    }
+    result->address =
+        MapViewOfFile(result->mapping, FILE_MAP_READ, 0, 0, 0);
+    return result->address ? result : nullptr;
+}
+
+inline mapped_file::~mapped_file() {
+    if (address) {
+        UnmapViewOfFile(address);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+}
+
+#else
+
+inline std::shared_ptr<mapped_file> mapped_file::open(const char *path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    std::shared_ptr<mapped_file> result(new mapped_file());
+    result->length = static_cast<size_t>(st.st_size);
+    void *address =
+        mmap(nullptr, result->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后即可关闭文件描述符
+    close(fd);
+    if (address == MAP_FAILED) {
+        return nullptr;
+    }
+    result->address = address;
+    return result;
+}
+
+inline mapped_file::~mapped_file() {
+    if (address) {
+        munmap(address, length);
+    }
+}
+
+#endif
+
+#endif
@@ -3,6 +3,8 @@
 
 #include "vec3.h"
 
+// 三个向量放在最前面并按 vec3 的对齐排列 (float 模式下各占一个 16 字节的
+// SSE 寄存器宽度)，求交时 origin / inv_direction 可以直接对齐加载
 class ray {
   public:
     ray() = default;
@@ -15,13 +17,13 @@ class ray {
         dir_sign[2] = (inv_dir.z() < 0);
     }
 
-    point3 origin() const noexcept {
+    const point3 &origin() const noexcept {
         return orig;
     }
-    vec3 direction() const noexcept {
+    const vec3 &direction() const noexcept {
         return dir;
     }
-    vec3 inv_direction() const noexcept {
+    const vec3 &inv_direction() const noexcept {
         return inv_dir;
     }
     const int *direction_sign() const noexcept {
@@ -39,8 +41,40 @@ class ray {
     point3 orig;
     vec3 dir;
     vec3 inv_dir;
-    int dir_sign[3];
     double tm = 0.0;
+    int dir_sign[3];
 };
 
-#endif
\ No newline at end of file
+// 从表面上的点 p 出发、方向为 w 的光线起点，p_error 为求交的图元给出的
+// p 各坐标的绝对误差界。float 模式下交点坐标的误差随坐标的量级增长，
+// 固定的 t_min = 0.001 在远离原点处不足以避开自相交，因此沿法线 n 向
+// w 所在的一侧偏移 dot(|n|, p_error)，使起点越过误差范围 (PBRT 3.9.5)。
+// double 模式下误差远小于 t_min，直接返回 p，结果与偏移前一致
+inline point3 offset_ray_origin(const point3 &p, const vec3 &p_error,
+                                const vec3 &n, const vec3 &w) {
+#ifdef RT_USE_FLOAT
+    vec3 offset = dot(abs(n), p_error) * n;
+    if (dot(w, n) < 0) {
+        offset = -offset;
+    }
+    // 相加的舍入可能让起点退回误差范围内，按偏移方向再取下一个可表示的值
+    point3 origin = p + offset;
+    for (int i = 0; i < 3; ++i) {
+        if (offset[i] > 0) {
+            origin[i] = std::nextafter(origin[i],
+                                       std::numeric_limits<real>::infinity());
+        } else if (offset[i] < 0) {
+            origin[i] = std::nextafter(origin[i],
+                                       -std::numeric_limits<real>::infinity());
+        }
+    }
+    return origin;
+#else
+    (void)p_error;
+    (void)n;
+    (void)w;
+    return p;
+#endif
+}
+
+#endif
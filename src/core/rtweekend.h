@@ -2,6 +2,7 @@
 #define RTWEEKEND_H
 
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <limits>
 #include <memory>
@@ -14,6 +15,22 @@ using std::shared_ptr;
 using std::sqrt;
 using std::unique_ptr;
 
+// 几何数据 (vec3 / ray / aabb) 使用的标量类型。定义 RT_USE_FLOAT 时为
+// float，几何和 BVH 节点的内存占用与带宽随之减小；默认 double。
+// 光线参数 t、点积和长度等标量结果、采样值仍用 double
+#ifdef RT_USE_FLOAT
+using real = float;
+#else
+using real = double;
+#endif
+
+// 以 real 做 n 次运算的相对舍入误差界 gamma(n) = n u / (1 - n u)，
+// u 为单位舍入误差 (PBRT 3.9)，用于估计交点坐标的误差
+inline constexpr real error_gamma(int n) {
+    return n * (std::numeric_limits<real>::epsilon() / 2) /
+           (1 - n * (std::numeric_limits<real>::epsilon() / 2));
+}
+
 constexpr double infinity = std::numeric_limits<double>::infinity();
 constexpr double pi = 3.1415926535897932385;
 
@@ -21,16 +38,73 @@ inline constexpr double degrees_to_radians(double degrees) {
     return degrees * pi / 180.0;
 }
 
-inline double random_double() {
+// 64 位整数的混合哈希 (splitmix64 的终结步骤)
+inline uint64_t mix_bits(uint64_t v) {
+    v ^= v >> 31;
+    v *= 0x7fb5d329728ea185ull;
+    v ^= v >> 27;
+    v *= 0x81dadef4bc2dd44dull;
+    v ^= v >> 33;
+    return v;
+}
 
-    static thread_local uint32_t seed =
-        std::hash<std::thread::id>{}(std::this_thread::get_id());
+inline uint64_t hash_values(uint64_t a, uint64_t b, uint64_t c = 0,
+                            uint64_t d = 0) {
+    uint64_t h = mix_bits(a + 0x9e3779b97f4a7c15ull);
+    h = mix_bits(h ^ (b + 0x9e3779b97f4a7c15ull));
+    h = mix_bits(h ^ (c + 0x9e3779b97f4a7c15ull));
+    return mix_bits(h ^ (d + 0x9e3779b97f4a7c15ull));
+}
 
-    seed ^= seed << 13;
-    seed ^= seed >> 17;
-    seed ^= seed << 5;
+// 计数器式随机流：第 n 个随机数为 hash(key, n)，没有跨调用的递推状态，
+// 同一 key 得到的序列与哪个线程、按什么顺序执行无关。
+// 渲染器在每个像素样本开始时用 (像素, 样本序号, 种子) 重设当前线程的流，
+// 其余时候 (如在主线程构建场景) 使用固定的默认 key
+struct random_stream {
+    uint64_t key = 0;
+    uint64_t counter = 0;
+};
 
-    return seed * 2.3283064365386963e-10;
+inline random_stream &thread_random_stream() {
+    static thread_local random_stream stream;
+    return stream;
+}
+
+inline void seed_random_stream(uint64_t key) {
+    random_stream &stream = thread_random_stream();
+    stream.key = key;
+    stream.counter = 0;
+}
+
+// 在作用域内把当前线程的随机流换成 *stream，离开时把推进后的状态写回
+// *stream 并恢复原来的随机流；stream 为空时什么也不做
+class random_stream_scope {
+  public:
+    explicit random_stream_scope(random_stream *stream) : m_stream(stream) {
+        if (m_stream) {
+            m_saved = thread_random_stream();
+            thread_random_stream() = *m_stream;
+        }
+    }
+    ~random_stream_scope() {
+        if (m_stream) {
+            *m_stream = thread_random_stream();
+            thread_random_stream() = m_saved;
+        }
+    }
+    random_stream_scope(const random_stream_scope &) = delete;
+    random_stream_scope &operator=(const random_stream_scope &) = delete;
+
+  private:
+    random_stream *m_stream;
+    random_stream m_saved;
+};
+
+inline double random_double() {
+    random_stream &stream = thread_random_stream();
+    uint64_t bits =
+        mix_bits(stream.key ^ (++stream.counter * 0x9e3779b97f4a7c15ull));
+    return (bits >> 11) * 1.1102230246251565e-16; // 2^-53，结果在 [0, 1)
 }
 
 inline double random_double(double min, double max) noexcept {
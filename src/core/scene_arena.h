@@ -0,0 +1,266 @@
+#ifndef SCENE_ARENA_H
+#define SCENE_ARENA_H
+
+#include "aligned_allocator.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class hittable;
+class hittable_list;
+class bvh_node;
+class linear_bvh;
+template <int N> class wide_bvh;
+class material;
+class texture;
+class Light;
+
+// 场景内存池中的对象类别，每个类别占用各自连续的内存块
+enum class scene_arena_category {
+    primitives,
+    acceleration, // bvh_node / linear_bvh / wide_bvh / hittable_list
+    materials,
+    textures,
+    lights,
+    other,
+};
+constexpr int kSceneArenaCategoryCount = 6;
+
+inline const char *scene_arena_category_name(scene_arena_category category) {
+    switch (category) {
+    case scene_arena_category::primitives:
+        return "primitives";
+    case scene_arena_category::acceleration:
+        return "acceleration";
+    case scene_arena_category::materials:
+        return "materials";
+    case scene_arena_category::textures:
+        return "textures";
+    case scene_arena_category::lights:
+        return "lights";
+    default:
+        return "other";
+    }
+}
+
+// 按对象的静态类型归类，重载决议会选中最派生的那个基类
+constexpr scene_arena_category scene_arena_category_of(const void *) {
+    return scene_arena_category::other;
+}
+constexpr scene_arena_category scene_arena_category_of(const hittable *) {
+    return scene_arena_category::primitives;
+}
+constexpr scene_arena_category scene_arena_category_of(const hittable_list *) {
+    return scene_arena_category::acceleration;
+}
+constexpr scene_arena_category scene_arena_category_of(const bvh_node *) {
+    return scene_arena_category::acceleration;
+}
+constexpr scene_arena_category scene_arena_category_of(const linear_bvh *) {
+    return scene_arena_category::acceleration;
+}
+template <int N>
+constexpr scene_arena_category scene_arena_category_of(const wide_bvh<N> *) {
+    return scene_arena_category::acceleration;
+}
+constexpr scene_arena_category scene_arena_category_of(const material *) {
+    return scene_arena_category::materials;
+}
+constexpr scene_arena_category scene_arena_category_of(const texture *) {
+    return scene_arena_category::textures;
+}
+constexpr scene_arena_category scene_arena_category_of(const Light *) {
+    return scene_arena_category::lights;
+}
+
+// 内存块的对齐，也是池中对象所能要求的最大对齐
+constexpr size_t kSceneArenaAlignment = 64;
+
+// 场景对象的内存池。make 在所属类别的内存块中顺序放置对象，
+// 返回不持有所有权的 shared_ptr (别名构造、没有控制块)：复制句柄不触碰
+// 原子引用计数，同类对象在内存中相邻。对象不会单独释放，
+// 内存池析构时按创建的逆序析构全部对象，因此它必须比所有句柄活得久。
+// 对象内部的 std::vector 等 (网格数组、BVH 节点数组、图像) 仍在堆上，
+// 不计入统计
+class scene_arena {
+  public:
+    struct category_stats {
+        size_t objects = 0;
+        size_t bytes = 0;    // 对象占用，含对齐填充
+        size_t reserved = 0; // 已申请的内存块总大小
+        int chunks = 0;
+    };
+
+    explicit scene_arena(size_t chunk_size = 64 * 1024)
+        : m_chunk_size(chunk_size) {
+    }
+    ~scene_arena();
+    scene_arena(const scene_arena &) = delete;
+    scene_arena &operator=(const scene_arena &) = delete;
+
+    template <typename T, typename... Args>
+    std::shared_ptr<T> make(Args &&...args);
+
+    const category_stats &stats(scene_arena_category category) const {
+        return m_pools[static_cast<int>(category)].stats;
+    }
+    category_stats total_stats() const;
+    void print_report(std::ostream &out) const;
+
+    // 当前接收 make_pooled 分配的内存池，为空时 make_pooled 退回
+    // make_shared。不是线程局部的：并行构建 BVH 的工作线程也要分配到
+    // 同一个内存池，见 scene_arena_scope
+    static scene_arena *current() {
+        return current_slot().load();
+    }
+
+  private:
+    friend class scene_arena_scope;
+
+    using chunk_allocator =
+        aligned_allocator<unsigned char, kSceneArenaAlignment>;
+    struct chunk {
+        unsigned char *data;
+        size_t size;
+        size_t used;
+    };
+    struct pool {
+        std::vector<chunk> chunks;
+        category_stats stats;
+    };
+    struct destructor_entry {
+        void *object;
+        void (*destroy)(void *);
+    };
+
+    void *allocate(scene_arena_category category, size_t bytes,
+                   size_t alignment);
+
+    static std::atomic<scene_arena *> &current_slot() {
+        static std::atomic<scene_arena *> slot{nullptr};
+        return slot;
+    }
+
+    size_t m_chunk_size;
+    pool m_pools[kSceneArenaCategoryCount];
+    std::vector<destructor_entry> m_destructors;
+    std::mutex m_mutex;
+};
+
+// 在作用域内把 arena 设为 make_pooled 的目标，离开时恢复原来的内存池
+class scene_arena_scope {
+  public:
+    explicit scene_arena_scope(scene_arena *arena)
+        : m_saved(scene_arena::current_slot().exchange(arena)) {
+    }
+    ~scene_arena_scope() {
+        scene_arena::current_slot().store(m_saved);
+    }
+    scene_arena_scope(const scene_arena_scope &) = delete;
+    scene_arena_scope &operator=(const scene_arena_scope &) = delete;
+
+  private:
+    scene_arena *m_saved;
+};
+
+template <typename T, typename... Args>
+inline std::shared_ptr<T> scene_arena::make(Args &&...args) {
+    static_assert(alignof(T) <= kSceneArenaAlignment,
+                  "over-aligned type in scene_arena");
+    constexpr scene_arena_category category =
+        scene_arena_category_of(static_cast<const T *>(nullptr));
+    void *memory = allocate(category, sizeof(T), alignof(T));
+    // 构造函数中可能再分配子对象 (如 box 的六个面)，构造时不持有锁；
+    // 子对象先登记，析构时外层对象先于子对象析构
+    T *object = new (memory) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_destructors.push_back(
+            {object, [](void *p) { static_cast<T *>(p)->~T(); }});
+    }
+    return std::shared_ptr<T>(std::shared_ptr<T>(), object);
+}
+
+inline void *scene_arena::allocate(scene_arena_category category,
+                                   size_t bytes, size_t alignment) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pool &p = m_pools[static_cast<int>(category)];
+    size_t offset = 0;
+    if (!p.chunks.empty()) {
+        const chunk &last = p.chunks.back();
+        offset = (last.used + alignment - 1) / alignment * alignment;
+    }
+    if (p.chunks.empty() || offset + bytes > p.chunks.back().size) {
+        // 当前块放不下时开新块，比块还大的对象独占一块
+        size_t size = std::max(m_chunk_size, bytes);
+        unsigned char *data = chunk_allocator().allocate(size);
+        p.chunks.push_back({data, size, 0});
+        p.stats.reserved += size;
+        ++p.stats.chunks;
+        offset = 0;
+    }
+    chunk &current = p.chunks.back();
+    p.stats.bytes += offset + bytes - current.used;
+    ++p.stats.objects;
+    current.used = offset + bytes;
+    return current.data + offset;
+}
+
+inline scene_arena::~scene_arena() {
+    for (size_t i = m_destructors.size(); i-- > 0;) {
+        m_destructors[i].destroy(m_destructors[i].object);
+    }
+    for (pool &p : m_pools) {
+        for (chunk &c : p.chunks) {
+            chunk_allocator().deallocate(c.data, c.size);
+        }
+    }
+}
+
+inline scene_arena::category_stats scene_arena::total_stats() const {
+    category_stats total;
+    for (const pool &p : m_pools) {
+        total.objects += p.stats.objects;
+        total.bytes += p.stats.bytes;
+        total.reserved += p.stats.reserved;
+        total.chunks += p.stats.chunks;
+    }
+    return total;
+}
+
+inline void scene_arena::print_report(std::ostream &out) const {
+    const double mib = 1024.0 * 1024.0;
+    category_stats total = total_stats();
+    out << "Scene memory: " << total.objects << " objects, "
+        << total.bytes / mib << " MiB used, " << total.reserved / mib
+        << " MiB reserved in " << total.chunks << " chunks." << std::endl;
+    for (int c = 0; c < kSceneArenaCategoryCount; ++c) {
+        const category_stats &s = m_pools[c].stats;
+        if (s.objects == 0) {
+            continue;
+        }
+        out << "  " << scene_arena_category_name(
+                           static_cast<scene_arena_category>(c))
+            << ": " << s.objects << " objects, " << s.bytes << " bytes ("
+            << s.bytes / s.objects << " per object)" << std::endl;
+    }
+}
+
+// 创建场景对象：有活动的 scene_arena 时放入其中并返回不持有所有权的
+// 句柄，否则等同于 make_shared
+template <typename T, typename... Args>
+inline std::shared_ptr<T> make_pooled(Args &&...args) {
+    if (scene_arena *arena = scene_arena::current()) {
+        return arena->make<T>(std::forward<Args>(args)...);
+    }
+    return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+#endif
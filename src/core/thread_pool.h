@@ -0,0 +1,197 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// 常驻工作线程池：线程只在构造时创建一次，渲染、BVH 构建和图像输出共用。
+// size() 是参与并行的线程总数，包括调用 parallel_for / task_group::wait
+// 的线程本身，因此池中实际只有 size() - 1 个工作线程
+class thread_pool {
+  public:
+    // num_threads 为 0 时使用 hardware_concurrency；
+    // pin_threads 为 true 时把第 i 个工作线程绑定到第 i + 1 号 CPU
+    explicit thread_pool(int num_threads = 0, bool pin_threads = false);
+    ~thread_pool();
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    int size() const {
+        return static_cast<int>(workers.size()) + 1;
+    }
+
+    void submit(std::function<void()> task);
+
+    // 在调用线程上执行一个排队的任务，队列为空时返回 false
+    bool run_pending_task();
+
+    // 对 [0, count) 的每个下标调用 fn(index)，下标动态分配给各线程；
+    // 调用线程也参与执行，全部完成后返回
+    template <typename F> void parallel_for(int count, F &&fn);
+
+  private:
+    void worker_loop();
+    static void pin_to_cpu(std::thread &thread, int cpu);
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    bool stopping = false;
+};
+
+// 一组提交到线程池的任务。wait() 在等待期间帮忙执行队列中的任务，
+// 因此任务内部可以再嵌套创建 task_group（如并行递归构建 BVH）而不会死锁
+class task_group {
+  public:
+    explicit task_group(thread_pool &pool) : pool(pool), pending(0) {
+    }
+    ~task_group() {
+        wait();
+    }
+
+    void run(std::function<void()> task);
+    void wait();
+
+  private:
+    thread_pool &pool;
+    std::atomic<int> pending;
+};
+
+inline thread_pool::thread_pool(int num_threads, bool pin_threads) {
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(num_threads - 1);
+    for (int i = 0; i + 1 < num_threads; ++i) {
+        workers.emplace_back([this]() { worker_loop(); });
+        if (pin_threads) {
+            pin_to_cpu(workers.back(), i + 1);
+        }
+    }
+}
+
+inline thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+    for (auto &t : workers) {
+        t.join();
+    }
+}
+
+inline void thread_pool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    task_available.notify_one();
+}
+
+inline bool thread_pool::run_pending_task() {
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) {
+            return false;
+        }
+        task = std::move(tasks.front());
+        tasks.pop_front();
+    }
+    task();
+    return true;
+}
+
+inline void thread_pool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_available.wait(
+                lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+inline void thread_pool::pin_to_cpu(std::thread &thread, int cpu) {
+    int cpu_count = std::max(1u, std::thread::hardware_concurrency());
+    cpu %= cpu_count;
+#if defined(_WIN32)
+    SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (cpu % 64));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+template <typename F>
+inline void thread_pool::parallel_for(int count, F &&fn) {
+    std::atomic<int> next(0);
+    auto body = [&]() {
+        for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            fn(i);
+        }
+    };
+
+    task_group group(*this);
+    int helpers = std::min(count, size()) - 1;
+    for (int i = 0; i < helpers; ++i) {
+        group.run(body);
+    }
+    body();
+    group.wait();
+}
+
+inline void task_group::run(std::function<void()> task) {
+    pending.fetch_add(1);
+    pool.submit([this, task = std::move(task)]() {
+        // 任务抛出异常时也要减少计数，否则 wait() 会一直等待
+        struct pending_guard {
+            std::atomic<int> &pending;
+            ~pending_guard() {
+                pending.fetch_sub(1);
+            }
+        } guard{pending};
+        task();
+    });
+}
+
+inline void task_group::wait() {
+    while (pending.load() > 0) {
+        if (!pool.run_pending_task()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+#endif
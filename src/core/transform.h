@@ -0,0 +1,150 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "rtweekend.h"
+#include "vec3.h"
+
+// 3x4 仿射变换：左侧 3x3 为线性部分，最后一列为平移。
+// 点 p 变换为 M * p + t，向量只经过线性部分
+class affine_transform {
+  public:
+    affine_transform() : m{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}} {
+    }
+
+    static affine_transform identity() {
+        return affine_transform();
+    }
+
+    static affine_transform translation(const vec3 &offset) {
+        affine_transform t;
+        t.m[0][3] = offset.x();
+        t.m[1][3] = offset.y();
+        t.m[2][3] = offset.z();
+        return t;
+    }
+
+    static affine_transform scaling(const vec3 &s) {
+        affine_transform t;
+        t.m[0][0] = s.x();
+        t.m[1][1] = s.y();
+        t.m[2][2] = s.z();
+        return t;
+    }
+
+    static affine_transform scaling(double s) {
+        return scaling(vec3(s, s, s));
+    }
+
+    // 绕任意轴旋转 angle 度（右手系，Rodrigues 公式）
+    static affine_transform rotation(const vec3 &axis, double angle) {
+        vec3 a = unit_vector(axis);
+        double radians = degrees_to_radians(angle);
+        double c = cos(radians);
+        double s = sin(radians);
+        double k = 1 - c;
+
+        affine_transform t;
+        t.m[0][0] = c + a.x() * a.x() * k;
+        t.m[0][1] = a.x() * a.y() * k - a.z() * s;
+        t.m[0][2] = a.x() * a.z() * k + a.y() * s;
+        t.m[1][0] = a.y() * a.x() * k + a.z() * s;
+        t.m[1][1] = c + a.y() * a.y() * k;
+        t.m[1][2] = a.y() * a.z() * k - a.x() * s;
+        t.m[2][0] = a.z() * a.x() * k - a.y() * s;
+        t.m[2][1] = a.z() * a.y() * k + a.x() * s;
+        t.m[2][2] = c + a.z() * a.z() * k;
+        return t;
+    }
+
+    // 与 rotate_y 包装器的旋转方向一致
+    static affine_transform rotation_y(double angle) {
+        return rotation(vec3(0, 1, 0), angle);
+    }
+
+    point3 point(const point3 &p) const {
+        return point3(
+            m[0][0] * p.x() + m[0][1] * p.y() + m[0][2] * p.z() + m[0][3],
+            m[1][0] * p.x() + m[1][1] * p.y() + m[1][2] * p.z() + m[1][3],
+            m[2][0] * p.x() + m[2][1] * p.y() + m[2][2] * p.z() + m[2][3]);
+    }
+
+    // p 各坐标的误差界为 p_error 时 point(p) 结果的误差界：
+    // 原误差按 |M| 传播，再加上本次运算的舍入 (PBRT 3.9.4)
+    vec3 point_error(const point3 &p, const vec3 &p_error) const {
+        vec3 error;
+        for (int i = 0; i < 3; ++i) {
+            double rounding = fabs(m[i][0] * p.x()) + fabs(m[i][1] * p.y()) +
+                              fabs(m[i][2] * p.z()) + fabs(m[i][3]);
+            double propagated = fabs(m[i][0]) * p_error.x() +
+                                fabs(m[i][1]) * p_error.y() +
+                                fabs(m[i][2]) * p_error.z();
+            error[i] = error_gamma(3) * rounding +
+                       (1 + error_gamma(3)) * propagated;
+        }
+        return error;
+    }
+
+    vec3 vector(const vec3 &v) const {
+        return vec3(m[0][0] * v.x() + m[0][1] * v.y() + m[0][2] * v.z(),
+                    m[1][0] * v.x() + m[1][1] * v.y() + m[1][2] * v.z(),
+                    m[2][0] * v.x() + m[2][1] * v.y() + m[2][2] * v.z());
+    }
+
+    // 按线性部分的转置作用于向量。对逆变换调用即得到法线变换 (M^-1)^T
+    vec3 transposed_vector(const vec3 &v) const {
+        return vec3(m[0][0] * v.x() + m[1][0] * v.y() + m[2][0] * v.z(),
+                    m[0][1] * v.x() + m[1][1] * v.y() + m[2][1] * v.z(),
+                    m[0][2] * v.x() + m[1][2] * v.y() + m[2][2] * v.z());
+    }
+
+    double determinant() const {
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+               m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+               m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    }
+
+    // 线性部分奇异时返回单位变换，调用方应事先检查 determinant()
+    affine_transform inverse() const {
+        affine_transform inv;
+        double det = determinant();
+        if (fabs(det) < kNearZeroThreshold) {
+            return inv;
+        }
+        double inv_det = 1.0 / det;
+
+        inv.m[0][0] = (m[1][1] * m[2][2] - m[1][2] * m[2][1]) * inv_det;
+        inv.m[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inv_det;
+        inv.m[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inv_det;
+        inv.m[1][0] = (m[1][2] * m[2][0] - m[1][0] * m[2][2]) * inv_det;
+        inv.m[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inv_det;
+        inv.m[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inv_det;
+        inv.m[2][0] = (m[1][0] * m[2][1] - m[1][1] * m[2][0]) * inv_det;
+        inv.m[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inv_det;
+        inv.m[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inv_det;
+
+        vec3 t = inv.vector(vec3(m[0][3], m[1][3], m[2][3]));
+        inv.m[0][3] = -t.x();
+        inv.m[1][3] = -t.y();
+        inv.m[2][3] = -t.z();
+        return inv;
+    }
+
+  public:
+    double m[3][4];
+};
+
+// a * b：先应用 b 再应用 a
+inline affine_transform operator*(const affine_transform &a,
+                                  const affine_transform &b) {
+    affine_transform r;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] +
+                        a.m[i][2] * b.m[2][j];
+        }
+        r.m[i][3] += a.m[i][3];
+    }
+    return r;
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define VEC3_H
 
 #include "rtweekend.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -9,51 +10,84 @@ using std::sqrt;
 
 constexpr double kNearZeroThreshold = 1e-8;
 
+// float 模式下 vec3 以 4 个 float (第 4 个分量恒为 0) 存储并按 16 字节
+// 对齐，逐分量的运算直接用 SSE 指令。double 模式保持 3 个 double 的
+// 紧凑布局：补齐到 4 个 double 会让几何数据多占三分之一
+#if defined(RT_USE_FLOAT) && (defined(__SSE__) || defined(_M_X64))
+#include <immintrin.h>
+#define RT_VEC3_SSE 1
+#endif
+
 class vec3 {
   public:
     vec3() : e{0, 0, 0} {
     }
-    vec3(double e0, double e1, double e2) : e{e0, e1, e2} {
+    vec3(real e0, real e1, real e2) : e{e0, e1, e2} {
+    }
+#ifdef RT_VEC3_SSE
+    explicit vec3(__m128 v) {
+        _mm_store_ps(e, v);
+    }
+    __m128 lanes() const {
+        return _mm_load_ps(e);
     }
+#endif
 
-    double x() const noexcept {
+    real x() const noexcept {
         return e[0];
     }
-    double y() const noexcept {
+    real y() const noexcept {
         return e[1];
     }
-    double z() const noexcept {
+    real z() const noexcept {
         return e[2];
     }
 
     vec3 operator-() const {
+#ifdef RT_VEC3_SSE
+        return vec3(_mm_sub_ps(_mm_setzero_ps(), lanes()));
+#else
         return vec3(-e[0], -e[1], -e[2]);
+#endif
     }
-    double operator[](int i) const {
+    real operator[](int i) const {
         return e[i];
     }
-    double &operator[](int i) {
+    real &operator[](int i) {
         return e[i];
     }
 
     vec3 &operator+=(const vec3 &v) {
+#ifdef RT_VEC3_SSE
+        _mm_store_ps(e, _mm_add_ps(lanes(), v.lanes()));
+#else
         e[0] += v.e[0];
         e[1] += v.e[1];
         e[2] += v.e[2];
+#endif
         return *this;
     }
 
     vec3 &operator*=(const double t) {
+#ifdef RT_VEC3_SSE
+        __m128 s = _mm_set1_ps(static_cast<real>(t));
+        _mm_store_ps(e, _mm_mul_ps(lanes(), s));
+#else
         e[0] *= t;
         e[1] *= t;
         e[2] *= t;
+#endif
         return *this;
     }
 
     vec3 &operator*=(const vec3 &v) {
+#ifdef RT_VEC3_SSE
+        _mm_store_ps(e, _mm_mul_ps(lanes(), v.lanes()));
+#else
         e[0] *= v.e[0];
         e[1] *= v.e[1];
         e[2] *= v.e[2];
+#endif
         return *this;
     }
 
@@ -85,7 +119,11 @@ class vec3 {
     }
 
   public:
-    double e[3];
+#ifdef RT_VEC3_SSE
+    alignas(16) real e[4];
+#else
+    real e[3];
+#endif
 };
 
 class vec2 {
@@ -186,19 +224,35 @@ inline std::ostream &operator<<(std::ostream &out, const vec3 &v) {
 }
 
 inline vec3 operator+(const vec3 &u, const vec3 &v) {
+#ifdef RT_VEC3_SSE
+    return vec3(_mm_add_ps(u.lanes(), v.lanes()));
+#else
     return vec3(u.e[0] + v.e[0], u.e[1] + v.e[1], u.e[2] + v.e[2]);
+#endif
 }
 
 inline vec3 operator-(const vec3 &u, const vec3 &v) {
+#ifdef RT_VEC3_SSE
+    return vec3(_mm_sub_ps(u.lanes(), v.lanes()));
+#else
     return vec3(u.e[0] - v.e[0], u.e[1] - v.e[1], u.e[2] - v.e[2]);
+#endif
 }
 
 inline vec3 operator*(const vec3 &u, const vec3 &v) {
+#ifdef RT_VEC3_SSE
+    return vec3(_mm_mul_ps(u.lanes(), v.lanes()));
+#else
     return vec3(u.e[0] * v.e[0], u.e[1] * v.e[1], u.e[2] * v.e[2]);
+#endif
 }
 
 inline vec3 operator*(double t, const vec3 &v) {
+#ifdef RT_VEC3_SSE
+    return vec3(_mm_mul_ps(_mm_set1_ps(static_cast<real>(t)), v.lanes()));
+#else
     return vec3(t * v.e[0], t * v.e[1], t * v.e[2]);
+#endif
 }
 
 inline vec3 operator*(const vec3 &v, double t) {
@@ -214,9 +268,43 @@ inline double dot(const vec3 &u, const vec3 &v) {
 }
 
 inline vec3 cross(const vec3 &u, const vec3 &v) {
+#ifdef RT_VEC3_SSE
+    // u.yzx * v.zxy - u.zxy * v.yzx，第 4 个分量仍为 0
+    __m128 a = u.lanes();
+    __m128 b = v.lanes();
+    __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+    return vec3(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+#else
     return vec3(u.e[1] * v.e[2] - u.e[2] * v.e[1],
                 u.e[2] * v.e[0] - u.e[0] * v.e[2],
                 u.e[0] * v.e[1] - u.e[1] * v.e[0]);
+#endif
+}
+
+// 逐分量的最小 / 最大值，用于包围盒
+inline vec3 min(const vec3 &u, const vec3 &v) {
+#ifdef RT_VEC3_SSE
+    return vec3(_mm_min_ps(u.lanes(), v.lanes()));
+#else
+    return vec3(std::min(u.e[0], v.e[0]), std::min(u.e[1], v.e[1]),
+                std::min(u.e[2], v.e[2]));
+#endif
+}
+
+inline vec3 max(const vec3 &u, const vec3 &v) {
+#ifdef RT_VEC3_SSE
+    return vec3(_mm_max_ps(u.lanes(), v.lanes()));
+#else
+    return vec3(std::max(u.e[0], v.e[0]), std::max(u.e[1], v.e[1]),
+                std::max(u.e[2], v.e[2]));
+#endif
+}
+
+// 逐分量的绝对值，用于误差界
+inline vec3 abs(const vec3 &v) {
+    return vec3(std::fabs(v.e[0]), std::fabs(v.e[1]), std::fabs(v.e[2]));
 }
 
 inline vec3 unit_vector(const vec3 &v) {
@@ -268,4 +356,45 @@ inline vec3 random_cosine_direction() {
     return vec3(x, y, z);
 }
 
+// 以下版本由 [0, 1)^2 的样本值确定结果，供使用 Sampler 的采样路径调用
+
+// 余弦加权半球，z 轴为法线方向
+inline vec3 sample_cosine_direction(const vec2 &u) {
+    auto z = sqrt(1 - u.y());
+    auto phi = 2 * pi * u.x();
+    auto r = sqrt(u.y());
+    return vec3(cos(phi) * r, sin(phi) * r, z);
+}
+
+// 单位圆盘内均匀分布 (同心映射，保持样本的分层结构)，z = 0
+inline vec3 sample_unit_disk(const vec2 &u) {
+    double a = 2 * u.x() - 1;
+    double b = 2 * u.y() - 1;
+    if (a == 0 && b == 0) {
+        return vec3(0, 0, 0);
+    }
+    double r, theta;
+    if (fabs(a) > fabs(b)) {
+        r = a;
+        theta = pi / 4 * (b / a);
+    } else {
+        r = b;
+        theta = pi / 2 - pi / 4 * (a / b);
+    }
+    return vec3(r * cos(theta), r * sin(theta), 0);
+}
+
+// 单位球面上均匀分布
+inline vec3 sample_sphere_direction(const vec2 &u) {
+    auto z = 1 - 2 * u.x();
+    auto r = sqrt(fmax(0.0, 1 - z * z));
+    auto phi = 2 * pi * u.y();
+    return vec3(r * cos(phi), r * sin(phi), z);
+}
+
+// 单位球内均匀分布：方向取自 u，半径取自 u_radius
+inline vec3 sample_in_unit_sphere(const vec2 &u, double u_radius) {
+    return cbrt(u_radius) * sample_sphere_direction(u);
+}
+
 #endif
\ No newline at end of file
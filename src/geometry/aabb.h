@@ -1,6 +1,8 @@
 #ifndef AABB_H
 #define AABB_H
 
+#include <algorithm>
+
 #include "ray.h"
 #include "rtweekend.h"
 #include "vec3.h"
@@ -23,12 +25,42 @@ class aabb {
 
     bool hit(const ray &r, double t_min, double t_max) const;
 
+    double surface_area() const {
+        vec3 d = maximum - minimum;
+        return 2.0 * (d.x() * d.y() + d.y() * d.z() + d.z() * d.x());
+    }
+
   public:
     point3 minimum;
     point3 maximum;
 };
 
 inline bool aabb::hit(const ray &r, double t_min, double t_max) const {
+#ifdef RT_VEC3_SSE
+    // 三个轴的板块一次算完：按方向符号选出近 / 远平面，第 4 个分量
+    // 用 z 分量覆盖后再做水平归约。NaN (0 * inf) 时 max / min 返回第二个
+    // 操作数，与标量版本一样保持原区间
+    __m128 org = r.origin().lanes();
+    __m128 inv = r.inv_direction().lanes();
+    __m128 negative = _mm_cmplt_ps(inv, _mm_setzero_ps());
+    __m128 lo = minimum.lanes();
+    __m128 hi = maximum.lanes();
+    __m128 near_b = _mm_or_ps(_mm_and_ps(negative, hi),
+                              _mm_andnot_ps(negative, lo));
+    __m128 far_b = _mm_or_ps(_mm_and_ps(negative, lo),
+                             _mm_andnot_ps(negative, hi));
+    __m128 near_t = _mm_mul_ps(_mm_sub_ps(near_b, org), inv);
+    __m128 far_t = _mm_mul_ps(_mm_sub_ps(far_b, org), inv);
+    near_t = _mm_shuffle_ps(near_t, near_t, _MM_SHUFFLE(2, 2, 1, 0));
+    far_t = _mm_shuffle_ps(far_t, far_t, _MM_SHUFFLE(2, 2, 1, 0));
+    near_t = _mm_max_ps(near_t, _mm_set1_ps(static_cast<real>(t_min)));
+    far_t = _mm_min_ps(far_t, _mm_set1_ps(static_cast<real>(t_max)));
+    near_t = _mm_max_ps(near_t, _mm_movehl_ps(near_t, near_t));
+    far_t = _mm_min_ps(far_t, _mm_movehl_ps(far_t, far_t));
+    near_t = _mm_max_ss(near_t, _mm_shuffle_ps(near_t, near_t, 1));
+    far_t = _mm_min_ss(far_t, _mm_shuffle_ps(far_t, far_t, 1));
+    return _mm_comilt_ss(near_t, far_t) != 0;
+#else
     const vec3 &inv_dir = r.inv_direction();
     const int *sign = r.direction_sign();
 
@@ -45,17 +77,13 @@ inline bool aabb::hit(const ray &r, double t_min, double t_max) const {
         }
     }
     return true;
+#endif
 }
 
-inline aabb surrounding_box(aabb box0, aabb box1) {
-    point3 small(fmin(box0.min().x(), box1.min().x()),
-                 fmin(box0.min().y(), box1.min().y()),
-                 fmin(box0.min().z(), box1.min().z()));
-    point3 big(fmax(box0.max().x(), box1.max().x()),
-               fmax(box0.max().y(), box1.max().y()),
-               fmax(box0.max().z(), box1.max().z()));
-
-    return aabb(small, big);
+// 包围盒不含 NaN，逐分量的 min / max 不需要 fmin / fmax 的 NaN 处理
+inline aabb surrounding_box(const aabb &box0, const aabb &box1) {
+    return aabb(min(box0.minimum, box1.minimum),
+                max(box0.maximum, box1.maximum));
 }
 
 #endif
\ No newline at end of file
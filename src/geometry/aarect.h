@@ -8,6 +8,14 @@ namespace {
 constexpr double kAABBPadding = 0.0001;
 }
 
+// 与平面的交点 r.at(t)，误差来自 t 的求解和 r.at(t) 本身的运算。
+// 不把交点直接设为平面上的坐标 k：checker_texture 按三个坐标的正弦之积
+// 取色，坐标恰好为 0 时地面只会显示一种颜色
+inline void set_plane_hit_point(const ray &r, double t, hit_record &rec) {
+    rec.p = r.at(t);
+    rec.p_error = error_gamma(4) * (abs(r.origin()) + abs(t * r.direction()));
+}
+
 class xy_rect : public hittable {
   public:
     xy_rect() {
@@ -20,6 +28,9 @@ class xy_rect : public hittable {
     virtual bool hit(const ray &r, double t_min, double t_max,
                      hit_record &rec) const override;
 
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override;
+
     virtual bool bounding_box(double time0, double time1,
                               aabb &output_box) const override {
         output_box = aabb(point3(x0, y0, k - kAABBPadding),
@@ -43,6 +54,9 @@ class xz_rect : public hittable {
 
     virtual bool hit(const ray &r, double t0, double t1, hit_record &rec) const;
 
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override;
+
     virtual bool bounding_box(double t0, double t1, aabb &output_box) const {
         output_box = aabb(vec3(x0, k - kAABBPadding, z0),
                           vec3(x1, k + kAABBPadding, z1));
@@ -65,6 +79,9 @@ class yz_rect : public hittable {
 
     virtual bool hit(const ray &r, double t0, double t1, hit_record &rec) const;
 
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override;
+
     virtual bool bounding_box(double t0, double t1, aabb &output_box) const {
         output_box = aabb(vec3(k - kAABBPadding, y0, z0),
                           vec3(k + kAABBPadding, y1, z1));
@@ -76,8 +93,8 @@ class yz_rect : public hittable {
     double y0, y1, z0, z1, k;
 };
 
-bool xy_rect::hit(const ray &r, double t_min, double t_max,
-                  hit_record &rec) const {
+inline bool xy_rect::hit(const ray &r, double t_min, double t_max,
+                         hit_record &rec) const {
     auto t = (k - r.origin().z()) / r.direction().z();
     if (t < t_min || t > t_max) {
         return false;
@@ -94,11 +111,12 @@ bool xy_rect::hit(const ray &r, double t_min, double t_max,
     auto outward_normal = vec3(0, 0, 1);
     rec.set_face_normal(r, outward_normal);
     rec.mat_ptr = mp.get();
-    rec.p = r.at(t);
+    set_plane_hit_point(r, t, rec);
     return true;
 }
 
-bool xz_rect::hit(const ray &r, double t_min, double t_max, hit_record &rec) const {
+inline bool xz_rect::hit(const ray &r, double t_min, double t_max,
+                         hit_record &rec) const {
     auto t = (k - r.origin().y()) / r.direction().y();
     if (t < t_min || t > t_max)
         return false;
@@ -112,11 +130,12 @@ bool xz_rect::hit(const ray &r, double t_min, double t_max, hit_record &rec) con
     vec3 outward_normal = vec3(0, 1, 0);
     rec.set_face_normal(r, outward_normal);
     rec.mat_ptr = mp.get();
-    rec.p = r.at(t);
+    set_plane_hit_point(r, t, rec);
     return true;
 }
 
-bool yz_rect::hit(const ray &r, double t_min, double t_max, hit_record &rec) const {
+inline bool yz_rect::hit(const ray &r, double t_min, double t_max,
+                         hit_record &rec) const {
     auto t = (k - r.origin().x()) / r.direction().x();
     if (t < t_min || t > t_max)
         return false;
@@ -130,8 +149,38 @@ bool yz_rect::hit(const ray &r, double t_min, double t_max, hit_record &rec) con
     vec3 outward_normal = vec3(1, 0, 0);
     rec.set_face_normal(r, outward_normal);
     rec.mat_ptr = mp.get();
-    rec.p = r.at(t);
+    set_plane_hit_point(r, t, rec);
     return true;
 }
 
+inline bool xy_rect::occluded(const ray &r, double t_min,
+                              double t_max) const {
+    auto t = (k - r.origin().z()) / r.direction().z();
+    if (t < t_min || t > t_max)
+        return false;
+    auto x = r.origin().x() + t * r.direction().x();
+    auto y = r.origin().y() + t * r.direction().y();
+    return x >= x0 && x <= x1 && y >= y0 && y <= y1;
+}
+
+inline bool xz_rect::occluded(const ray &r, double t_min,
+                              double t_max) const {
+    auto t = (k - r.origin().y()) / r.direction().y();
+    if (t < t_min || t > t_max)
+        return false;
+    auto x = r.origin().x() + t * r.direction().x();
+    auto z = r.origin().z() + t * r.direction().z();
+    return x >= x0 && x <= x1 && z >= z0 && z <= z1;
+}
+
+inline bool yz_rect::occluded(const ray &r, double t_min,
+                              double t_max) const {
+    auto t = (k - r.origin().x()) / r.direction().x();
+    if (t < t_min || t > t_max)
+        return false;
+    auto y = r.origin().y() + t * r.direction().y();
+    auto z = r.origin().z() + t * r.direction().z();
+    return y >= y0 && y <= y1 && z >= z0 && z <= z1;
+}
+
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "hittable_list.h"
 #include "ray.h"
 #include "rtweekend.h"
+#include "scene_arena.h"
 #include "vec3.h"
 
 class box : public hittable {
@@ -22,31 +23,38 @@ class box : public hittable {
         return true;
     }
 
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override {
+        return sides.occluded(r, t_min, t_max);
+    }
+
   public:
     point3 box_min;
     point3 box_max;
     hittable_list sides;
 };
 
-box::box(const point3 &p0, const point3 &p1, shared_ptr<material> ptr) {
+inline box::box(const point3 &p0, const point3 &p1,
+                shared_ptr<material> ptr) {
     box_min = p0;
     box_max = p1;
 
     sides.add(
-        make_shared<xy_rect>(p0.x(), p1.x(), p0.y(), p1.y(), p1.z(), ptr));
+        make_pooled<xy_rect>(p0.x(), p1.x(), p0.y(), p1.y(), p1.z(), ptr));
     sides.add(
-        make_shared<xy_rect>(p0.x(), p1.x(), p0.y(), p1.y(), p0.z(), ptr));
+        make_pooled<xy_rect>(p0.x(), p1.x(), p0.y(), p1.y(), p0.z(), ptr));
     sides.add(
-        make_shared<xz_rect>(p0.x(), p1.x(), p0.z(), p1.z(), p1.y(), ptr));
+        make_pooled<xz_rect>(p0.x(), p1.x(), p0.z(), p1.z(), p1.y(), ptr));
     sides.add(
-        make_shared<xz_rect>(p0.x(), p1.x(), p0.z(), p1.z(), p0.y(), ptr));
+        make_pooled<xz_rect>(p0.x(), p1.x(), p0.z(), p1.z(), p0.y(), ptr));
     sides.add(
-        make_shared<yz_rect>(p0.y(), p1.y(), p0.z(), p1.z(), p1.x(), ptr));
+        make_pooled<yz_rect>(p0.y(), p1.y(), p0.z(), p1.z(), p1.x(), ptr));
     sides.add(
-        make_shared<yz_rect>(p0.y(), p1.y(), p0.z(), p1.z(), p0.x(), ptr));
+        make_pooled<yz_rect>(p0.y(), p1.y(), p0.z(), p1.z(), p0.x(), ptr));
 }
 
-bool box::hit(const ray &r, double t_min, double t_max, hit_record &rec) const {
+inline bool box::hit(const ray &r, double t_min, double t_max,
+                     hit_record &rec) const {
     return sides.hit(r, t_min, t_max, rec);
 }
 
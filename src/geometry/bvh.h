@@ -2,95 +2,531 @@
 #define BVH_H
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
 
 #include "ray.h"
 #include "rtweekend.h"
+#include "scene_arena.h"
+#include "thread_pool.h"
 #include "vec3.h"
 
 #include "hittable.h"
 #include "hittable_list.h"
+#include "morton.h"
+
+// 划分策略
+enum class bvh_split_method {
+    sah,         // 分桶表面积启发式 (Binned SAH)，结果确定
+    random_axis, // 旧实现：随机轴 + 中位数划分
+    lbvh,        // Morton 码排序后按最高差异位划分，构建最快，适合每帧重建
+    hybrid       // 上层用 LBVH，图元数不超过 lbvh_treelet_size 的子树用 SAH
+};
+
+struct bvh_build_options {
+    bvh_split_method split = bvh_split_method::sah;
+    int sah_bins = 12;       // 每个轴上的分桶数
+    int max_leaf_size = 4;   // 叶子最多容纳的图元数
+    double traversal_cost = 1.0;
+    double intersection_cost = 1.0;
+    size_t parallel_threshold = 4096; // 超过此图元数的子树交给其他线程构建
+    int build_threads = 0;            // 0 表示使用 hardware_concurrency
+    // 共用的常驻线程池（如 Renderer 的）；为空时大规模构建临时创建一个，
+    // 线程数由 build_threads 决定
+    thread_pool *pool = nullptr;
+    int morton_bits = 30;             // 30 (每轴 10 位) 或 63 (每轴 21 位)
+    size_t lbvh_treelet_size = 128;
+};
+
+// 用于比较不同构建器质量的统计信息
+struct bvh_stats {
+    double sah_cost = 0.0; // 期望遍历代价（相对根节点表面积归一化）
+    int depth = 0;
+    int interior_nodes = 0;
+    int leaf_nodes = 0;
+    int primitives = 0;
+    int max_leaf_primitives = 0;
+};
+
+constexpr int kMaxSAHBins = 64;
+
+// 分桶 SAH 划分：在 indices[start, end) 上原地划分，mid 为右半区间起点。
+// 返回 false 表示作为叶子比继续划分更划算
+inline bool binned_sah_partition(const bvh_build_options &options,
+                                 const std::vector<aabb> &boxes,
+                                 const std::vector<point3> &centroids,
+                                 std::vector<uint32_t> &indices, size_t start,
+                                 size_t end, const aabb &node_box,
+                                 const aabb &centroid_box, size_t &mid) {
+    size_t object_span = end - start;
+
+    // 在每个轴上分桶，扫描所有桶边界，选出 SAH 代价最小的划分
+    struct bin {
+        aabb box;
+        int count = 0;
+    };
+    const int num_bins = std::min(std::max(options.sah_bins, 2), kMaxSAHBins);
+    bin bins[kMaxSAHBins];
+    double cost_left[kMaxSAHBins];
+
+    int best_axis = -1;
+    int best_split = 0;
+    double best_cost = infinity;
+    double inv_area = 1.0 / std::max(node_box.surface_area(), 1e-12);
+
+    for (int axis = 0; axis < 3; ++axis) {
+        double c_min = centroid_box.min()[axis];
+        double extent = centroid_box.max()[axis] - c_min;
+        if (extent <= 0) {
+            continue;
+        }
+
+        for (int i = 0; i < num_bins; ++i) {
+            bins[i].count = 0;
+        }
+        for (size_t i = start; i < end; ++i) {
+            const uint32_t index = indices[i];
+            int b = static_cast<int>(
+                num_bins * ((centroids[index][axis] - c_min) / extent));
+            b = std::min(b, num_bins - 1);
+            bins[b].box = bins[b].count == 0
+                              ? boxes[index]
+                              : surrounding_box(bins[b].box, boxes[index]);
+            bins[b].count++;
+        }
+
+        // 从左向右累积，再从右向左累积并求代价
+        aabb acc_box;
+        int acc_count = 0;
+        for (int i = 0; i < num_bins - 1; ++i) {
+            if (bins[i].count > 0) {
+                acc_box = acc_count == 0
+                              ? bins[i].box
+                              : surrounding_box(acc_box, bins[i].box);
+                acc_count += bins[i].count;
+            }
+            cost_left[i] = acc_count * acc_box.surface_area();
+        }
+
+        acc_count = 0;
+        for (int i = num_bins - 1; i > 0; --i) {
+            if (bins[i].count > 0) {
+                acc_box = acc_count == 0
+                              ? bins[i].box
+                              : surrounding_box(acc_box, bins[i].box);
+                acc_count += bins[i].count;
+            }
+            if (acc_count == 0 ||
+                acc_count == static_cast<int>(object_span)) {
+                continue;
+            }
+            double cost = options.traversal_cost +
+                          options.intersection_cost * inv_area *
+                              (cost_left[i - 1] +
+                               acc_count * acc_box.surface_area());
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_split = i;
+            }
+        }
+    }
+
+    double leaf_cost = options.intersection_cost * object_span;
+    if (object_span <= static_cast<size_t>(options.max_leaf_size) &&
+        leaf_cost <= best_cost) {
+        return false;
+    }
+
+    if (best_axis >= 0) {
+        double c_min = centroid_box.min()[best_axis];
+        double extent = centroid_box.max()[best_axis] - c_min;
+        auto split_it = std::partition(
+            indices.begin() + start, indices.begin() + end,
+            [&](uint32_t index) {
+                double offset = (centroids[index][best_axis] - c_min) / extent;
+                int b = static_cast<int>(num_bins * offset);
+                return std::min(b, num_bins - 1) < best_split;
+            });
+        mid = split_it - indices.begin();
+    } else {
+        // 所有质心重合，无法按空间划分，按数量对半分
+        mid = start + object_span / 2;
+    }
+    return true;
+}
 
 class bvh_node : public hittable {
   public:
-
-    bvh_node(const hittable_list &list, double time0, double time1)
-        : bvh_node(list.objects, 0, list.objects.size(), time0, time1) {
+    bvh_node(const hittable_list &list, double time0, double time1,
+             const bvh_build_options &options = default_options())
+        : bvh_node(list.objects, 0, list.objects.size(), time0, time1,
+                   options) {
     }
 
     bvh_node(const std::vector<shared_ptr<hittable>> &src_objects, size_t start,
-             size_t end, double time0, double time1);
+             size_t end, double time0, double time1,
+             const bvh_build_options &options = default_options());
+    // 空节点，只供 build_child 创建后由 build 填充 (make_pooled 需要公开的
+    // 构造函数)
+    bvh_node() = default;
 
     virtual bool hit(const ray &r, double t_min, double t_max,
                      hit_record &rec) const override;
     virtual bool bounding_box(double time0, double time1,
                               aabb &output_box) const override;
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override;
+
+    bvh_stats stats(const bvh_build_options &options = default_options()) const;
+
+    // 场景中未显式指定选项的 bvh_node 均使用此默认值
+    static bvh_build_options &default_options() {
+        static bvh_build_options options;
+        return options;
+    }
 
   public:
     shared_ptr<hittable> left;
     shared_ptr<hittable> right;
     aabb box;
+    double build_seconds = 0.0; // 仅由公开构造函数构建的根节点记录
+
+  private:
+    // 构建期间共享的数据：图元包围盒只计算一次，
+    // 所有子树在同一个 indices 数组的不同区间上原地划分
+    struct build_context {
+        build_context(const std::vector<shared_ptr<hittable>> &objects,
+                      const bvh_build_options &options)
+            : objects(objects), options(options) {}
+
+        const std::vector<shared_ptr<hittable>> &objects;
+        const bvh_build_options &options;
+        std::vector<aabb> boxes;
+        std::vector<point3> centroids;
+        std::vector<uint32_t> indices;
+        std::vector<uint64_t> morton; // 与 indices 同序，仅 LBVH 使用
+        size_t first = 0; // boxes / centroids / indices 均相对 objects[first]
+        thread_pool *pool = nullptr; // 为空时串行构建
+        int parallel_depth = 0;
+
+        const shared_ptr<hittable> &object(size_t i) const {
+            return objects[first + indices[i]];
+        }
+        const aabb &box(size_t i) const {
+            return boxes[indices[i]];
+        }
+        const point3 &centroid(size_t i) const {
+            return centroids[indices[i]];
+        }
+    };
+
+    void build(build_context &ctx, size_t start, size_t end, int depth);
+    static shared_ptr<hittable> build_child(build_context &ctx, size_t start,
+                                            size_t end, int depth);
+    static size_t split_morton(const build_context &ctx, size_t start,
+                               size_t end);
+    static void sort_by_morton(build_context &ctx);
+
+    void accumulate_stats(double root_area, int depth,
+                          const bvh_build_options &options,
+                          bvh_stats &stats) const;
 };
 
-bool bvh_node::bounding_box(double time0, double time1,
-                            aabb &output_box) const {
+inline bool bvh_node::bounding_box(double time0, double time1,
+                                   aabb &output_box) const {
     output_box = box;
     return true;
 }
 
-bool bvh_node::hit(const ray &r, double t_min, double t_max,
-                   hit_record &rec) const {
+inline bool bvh_node::hit(const ray &r, double t_min, double t_max,
+                          hit_record &rec) const {
     if (!box.hit(r, t_min, t_max)) {
         return false;
     }
 
     bool hit_left = left->hit(r, t_min, t_max, rec);
+    if (right == left) {
+        return hit_left;
+    }
     bool hit_right = right->hit(r, t_min, hit_left ? rec.t : t_max, rec);
 
     return hit_left || hit_right;
 }
 
-bvh_node::bvh_node(const std::vector<shared_ptr<hittable>> &src_objects,
-                   size_t start, size_t end, double time0, double time1) {
-    auto objects = src_objects;
+inline bool bvh_node::occluded(const ray &r, double t_min,
+                               double t_max) const {
+    if (!box.hit(r, t_min, t_max)) {
+        return false;
+    }
+    return left->occluded(r, t_min, t_max) ||
+           (right != left && right->occluded(r, t_min, t_max));
+}
+
+inline bvh_node::bvh_node(const std::vector<shared_ptr<hittable>> &src_objects,
+                          size_t start, size_t end, double time0, double time1,
+                          const bvh_build_options &options) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    build_context ctx{src_objects, options};
+    size_t object_count = end - start;
+    ctx.boxes.resize(object_count);
+    ctx.centroids.resize(object_count);
+    ctx.indices.resize(object_count);
+
+    // 小规模构建不值得并行，也就不必为它创建线程池
+    std::unique_ptr<thread_pool> local_pool;
+    if (object_count > options.parallel_threshold) {
+        ctx.pool = options.pool;
+        if (!ctx.pool && options.build_threads != 1) {
+            local_pool.reset(new thread_pool(options.build_threads));
+            ctx.pool = local_pool.get();
+        }
+    }
+    int num_threads = ctx.pool ? ctx.pool->size() : 1;
+    ctx.parallel_depth = 0;
+    while ((1 << ctx.parallel_depth) < num_threads) {
+        ctx.parallel_depth++;
+    }
 
-    int axis = random_int(0, 2);
-    auto comparator = [axis](const shared_ptr<hittable> &a,
-                             const shared_ptr<hittable> &b) {
-        aabb box_a, box_b;
-        if (!a->bounding_box(0, 0, box_a) || !b->bounding_box(0, 0, box_b)) {
-            std::cerr << "No bounding box in bvh_node constructor.\n";
+    // 包围盒和质心只求一次，之后所有划分都在 indices 上原地进行
+    auto compute_boxes = [&](size_t begin, size_t finish) {
+        for (size_t i = begin; i < finish; ++i) {
+            ctx.indices[i] = static_cast<uint32_t>(i);
+            if (!src_objects[start + i]->bounding_box(time0, time1,
+                                                      ctx.boxes[i])) {
+                std::cerr << "No bounding box in bvh_node constructor.\n";
+            }
+            ctx.centroids[i] = 0.5 * (ctx.boxes[i].min() + ctx.boxes[i].max());
         }
-        return box_a.min()[axis] < box_b.min()[axis];
     };
+    if (num_threads > 1) {
+        size_t chunk = (object_count + num_threads - 1) / num_threads;
+        ctx.pool->parallel_for(num_threads, [&](int c) {
+            size_t begin = std::min(c * chunk, object_count);
+            compute_boxes(begin, std::min(begin + chunk, object_count));
+        });
+    } else {
+        compute_boxes(0, object_count);
+    }
+    ctx.first = start;
+
+    if (options.split == bvh_split_method::lbvh ||
+        options.split == bvh_split_method::hybrid) {
+        sort_by_morton(ctx);
+    }
+
+    build(ctx, 0, object_count, 0);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    build_seconds =
+        std::chrono::duration<double>(end_time - start_time).count();
+}
+
+inline shared_ptr<hittable> bvh_node::build_child(build_context &ctx,
+                                                  size_t start, size_t end,
+                                                  int depth) {
+    if (end - start == 1) {
+        return ctx.object(start);
+    }
+    auto node = make_pooled<bvh_node>();
+    node->build(ctx, start, end, depth);
+    return node;
+}
 
+inline void bvh_node::build(build_context &ctx, size_t start, size_t end,
+                            int depth) {
+    const bvh_build_options &options = ctx.options;
     size_t object_span = end - start;
 
+    // LBVH 区间不扫描包围盒，待孩子建好后自底向上合并，保持线性时间
+    bool use_morton = !ctx.morton.empty() &&
+                      !(options.split == bvh_split_method::hybrid &&
+                        object_span <= options.lbvh_treelet_size);
+
+    aabb centroid_box;
+    if (!use_morton || object_span <= 2) {
+        box = ctx.box(start);
+        centroid_box = aabb(ctx.centroid(start), ctx.centroid(start));
+        for (size_t i = start + 1; i < end; ++i) {
+            box = surrounding_box(box, ctx.box(i));
+            centroid_box = surrounding_box(
+                centroid_box, aabb(ctx.centroid(i), ctx.centroid(i)));
+        }
+    }
+
     if (object_span == 1) {
-        left = right = objects[start];
-    } else if (object_span == 2) {
-        if (comparator(objects[start], objects[start + 1])) {
-            left = objects[start];
-            right = objects[start + 1];
-        } else {
-            left = objects[start + 1];
-            right = objects[start];
+        left = right = ctx.object(start);
+        return;
+    }
+
+    size_t mid;
+    if (use_morton) {
+        if (object_span == 2) {
+            left = ctx.object(start);
+            right = ctx.object(start + 1);
+            return;
         }
+        mid = split_morton(ctx, start, end);
+    } else if (options.split == bvh_split_method::random_axis) {
+        // 轴由节点的区间和深度哈希得到，而不是取当前线程的随机流：
+        // 并行构建时子树在哪个线程上构建不影响树的形状
+        int axis = static_cast<int>(hash_values(start, end, depth) % 3);
+        auto comparator = [&ctx, axis](uint32_t a, uint32_t b) {
+            return ctx.boxes[a].min()[axis] < ctx.boxes[b].min()[axis];
+        };
+        if (object_span == 2) {
+            if (!comparator(ctx.indices[start], ctx.indices[start + 1])) {
+                std::swap(ctx.indices[start], ctx.indices[start + 1]);
+            }
+            left = ctx.object(start);
+            right = ctx.object(start + 1);
+            return;
+        }
+        mid = start + object_span / 2;
+        std::nth_element(ctx.indices.begin() + start,
+                         ctx.indices.begin() + mid,
+                         ctx.indices.begin() + end, comparator);
     } else {
-        std::sort(objects.begin() + start, objects.begin() + end, comparator);
+        if (object_span == 2) {
+            left = ctx.object(start);
+            right = ctx.object(start + 1);
+            return;
+        }
+        if (!binned_sah_partition(options, ctx.boxes, ctx.centroids,
+                                  ctx.indices, start, end, box, centroid_box,
+                                  mid)) {
+            auto leaf = make_pooled<hittable_list>();
+            for (size_t i = start; i < end; ++i) {
+                leaf->add(ctx.object(i));
+            }
+            left = right = leaf;
+            return;
+        }
+    }
 
-        auto mid = start + object_span / 2;
-        left = make_shared<bvh_node>(objects, start, mid, time0, time1);
-        right = make_shared<bvh_node>(objects, mid, end, time0, time1);
+    // 大区间的左子树交给线程池，右子树在当前线程构建
+    if (ctx.pool && depth < ctx.parallel_depth &&
+        object_span > options.parallel_threshold) {
+        shared_ptr<hittable> left_child;
+        task_group group(*ctx.pool);
+        group.run(
+            [&]() { left_child = build_child(ctx, start, mid, depth + 1); });
+        right = build_child(ctx, mid, end, depth + 1);
+        group.wait();
+        left = left_child;
+    } else {
+        left = build_child(ctx, start, mid, depth + 1);
+        right = build_child(ctx, mid, end, depth + 1);
     }
 
-    aabb box_left, box_right;
+    if (use_morton) {
+        auto child_box = [&ctx](const shared_ptr<hittable> &child,
+                                size_t first, size_t last) {
+            return last - first == 1
+                       ? ctx.box(first)
+                       : static_cast<const bvh_node *>(child.get())->box;
+        };
+        box = surrounding_box(child_box(left, start, mid),
+                              child_box(right, mid, end));
+    }
+}
+
+inline void bvh_node::sort_by_morton(build_context &ctx) {
+    size_t n = ctx.indices.size();
+    if (n == 0) {
+        return;
+    }
 
-    if (!left->bounding_box(time0, time1, box_left) ||
-        !right->bounding_box(time0, time1, box_right)) {
-        std::cerr << "No bounding box in bvh_node constructor.\n";
+    aabb centroid_box(ctx.centroids[0], ctx.centroids[0]);
+    for (size_t i = 1; i < n; ++i) {
+        centroid_box = surrounding_box(
+            centroid_box, aabb(ctx.centroids[i], ctx.centroids[i]));
     }
+    vec3 extent = centroid_box.max() - centroid_box.min();
+
+    int bits_per_axis = ctx.options.morton_bits > 30 ? 21 : 10;
+    ctx.morton.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        vec3 offset = ctx.centroids[i] - centroid_box.min();
+        for (int a = 0; a < 3; ++a) {
+            offset[a] = extent[a] > 0 ? offset[a] / extent[a] : 0.0;
+        }
+        ctx.morton[i] = morton_encode(offset.x(), offset.y(), offset.z(),
+                                      bits_per_axis);
+    }
+
+    radix_sort_by_key(ctx.morton, ctx.indices, 3 * bits_per_axis, ctx.pool);
+}
+
+inline size_t bvh_node::split_morton(const build_context &ctx, size_t start,
+                                     size_t end) {
+    uint64_t first_code = ctx.morton[start];
+    uint64_t last_code = ctx.morton[end - 1];
+    if (first_code == last_code) {
+        return start + (end - start) / 2;
+    }
+
+    // 区间内的码已排序且共享高位前缀，在最高差异位上二分
+    uint64_t diff = first_code ^ last_code;
+    uint64_t split_bit = 1;
+    while (diff >>= 1) {
+        split_bit <<= 1;
+    }
+    auto it = std::partition_point(
+        ctx.morton.begin() + start, ctx.morton.begin() + end,
+        [split_bit](uint64_t code) { return (code & split_bit) == 0; });
+    return it - ctx.morton.begin();
+}
+
+inline bvh_stats bvh_node::stats(const bvh_build_options &options) const {
+    bvh_stats result;
+    accumulate_stats(std::max(box.surface_area(), 1e-12), 1, options, result);
+    return result;
+}
+
+inline void bvh_node::accumulate_stats(double root_area, int depth,
+                                       const bvh_build_options &options,
+                                       bvh_stats &stats) const {
+    double area_ratio = box.surface_area() / root_area;
+    stats.depth = std::max(stats.depth, depth);
+    stats.sah_cost += options.traversal_cost * area_ratio;
+
+    int leaf_primitives = 0;
+    auto visit = [&](const shared_ptr<hittable> &child) {
+        if (auto node = std::dynamic_pointer_cast<bvh_node>(child)) {
+            node->accumulate_stats(root_area, depth + 1, options, stats);
+        } else if (auto list =
+                       std::dynamic_pointer_cast<hittable_list>(child)) {
+            leaf_primitives += static_cast<int>(list->objects.size());
+        } else {
+            leaf_primitives += 1;
+        }
+    };
+    visit(left);
+    if (right != left) {
+        visit(right);
+    }
+
+    if (leaf_primitives > 0) {
+        stats.leaf_nodes++;
+        stats.primitives += leaf_primitives;
+        stats.max_leaf_primitives =
+            std::max(stats.max_leaf_primitives, leaf_primitives);
+        stats.sah_cost +=
+            options.intersection_cost * leaf_primitives * area_ratio;
+    } else {
+        stats.interior_nodes++;
+    }
+}
 
-    box = surrounding_box(box_left, box_right);
+inline std::ostream &operator<<(std::ostream &out, const bvh_stats &s) {
+    return out << "BVH: SAH cost " << s.sah_cost << ", depth " << s.depth
+               << ", " << s.interior_nodes << " interior / " << s.leaf_nodes
+               << " leaf nodes, " << s.primitives << " primitives (max "
+               << s.max_leaf_primitives << " per leaf)";
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -6,16 +6,21 @@
 #include "hittable.h"
 #include "material.h"
 #include "ray.h"
+#include "scene_arena.h"
 #include "texture.h"
 #include "vec3.h"
 
 class isotropic : public material {
   public:
-    isotropic(color c) : albedo(make_shared<solid_color>(c)) {
+    isotropic(color c) : albedo(make_pooled<solid_color>(c)) {
     }
     isotropic(shared_ptr<texture> a) : albedo(a) {
     }
 
+    virtual color base_color(const hit_record &rec) const override {
+        return albedo->value(rec.u, rec.v, rec.p);
+    }
+
     virtual bool scatter(const ray &r_in, const hit_record &rec,
                          color &attenuation, ray &scattered) const override {
         scattered = ray(rec.p, random_in_unit_sphere(), r_in.time());
@@ -31,12 +36,12 @@ class constant_medium : public hittable {
   public:
     constant_medium(shared_ptr<hittable> b, double d, shared_ptr<texture> a)
         : boundary(b), neg_inv_density(-1 / d),
-          phase_function(make_shared<isotropic>(a)) {
+          phase_function(make_pooled<isotropic>(a)) {
     }
 
     constant_medium(shared_ptr<hittable> b, double d, color c)
         : boundary(b), neg_inv_density(-1 / d),
-          phase_function(make_shared<isotropic>(c)) {
+          phase_function(make_pooled<isotropic>(c)) {
     }
 
     virtual bool hit(const ray &r, double t_min, double t_max,
@@ -46,14 +51,21 @@ class constant_medium : public hittable {
         return boundary->bounding_box(time0, time1, output_box);
     }
 
+    // 介质中的散射点是随机采样的，遮挡判定与 hit 使用同一分布
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override {
+        hit_record rec;
+        return hit(r, t_min, t_max, rec);
+    }
+
   public:
     shared_ptr<hittable> boundary;
     shared_ptr<material> phase_function;
     double neg_inv_density;
 };
 
-bool constant_medium::hit(const ray &r, double t_min, double t_max,
-                          hit_record &rec) const {
+inline bool constant_medium::hit(const ray &r, double t_min, double t_max,
+                                 hit_record &rec) const {
     // Print occasional samples when debugging. To enable, set enableDebug true.
     const bool enableDebug = false;
     const bool debugging = enableDebug && random_double() < 0.00001;
@@ -89,6 +101,7 @@ bool constant_medium::hit(const ray &r, double t_min, double t_max,
 
     rec.t = rec1.t + hit_distance / ray_length;
     rec.p = r.at(rec.t);
+    rec.p_error = vec3(0, 0, 0); // 介质内部的散射点，没有需要避开的表面
 
     if (debugging) {
         std::cerr << "hit_distance = " << hit_distance << '\n'
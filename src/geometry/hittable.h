@@ -7,8 +7,33 @@
 
 class material;
 
+// 一个光线包最多容纳的光线数，活动光线用 16 位掩码表示
+constexpr int kMaxRayPacketSize = 16;
+
+// 光线包遍历的计数：每访问一个内部节点记一次，
+// active_lanes / lane_slots 为平均活动光线比例；
+// 光线包发散后改用单条光线遍历的光线数记入 fallback_rays
+struct ray_packet_stats {
+    uint64_t node_visits = 0;
+    uint64_t active_lanes = 0;
+    uint64_t lane_slots = 0;
+    uint64_t fallback_rays = 0;
+
+    double active_ratio() const {
+        return lane_slots > 0 ? static_cast<double>(active_lanes) / lane_slots
+                              : 0.0;
+    }
+    void add(const ray_packet_stats &other) {
+        node_visits += other.node_visits;
+        active_lanes += other.active_lanes;
+        lane_slots += other.lane_slots;
+        fallback_rays += other.fallback_rays;
+    }
+};
+
 struct hit_record {
     point3 p;
+    vec3 p_error; // p 各坐标的绝对误差界，见 offset_ray_origin
     vec3 normal;
     material *mat_ptr;
     double t;
@@ -22,6 +47,31 @@ struct hit_record {
     }
 };
 
+// 从交点出发的散射 / 阴影光线，起点见 offset_ray_origin
+inline ray spawn_ray(const hit_record &rec, const vec3 &direction,
+                     double time) {
+    return ray(offset_ray_origin(rec.p, rec.p_error, rec.normal, direction),
+               direction, time);
+}
+
+// 指向距离 dist 处光源采样点的阴影光线，t_max 为阴影测试的上限。
+// 起点偏移后 (float 模式) 从新起点重新瞄准采样点：沿原方向平移的光线
+// 与倾斜的光源平面会在 dist 之前相交，被光源自身遮挡
+inline ray spawn_shadow_ray(const hit_record &rec, const vec3 &direction,
+                            double dist, double &t_max) {
+    ray r = spawn_ray(rec, direction, 0);
+#ifdef RT_USE_FLOAT
+    if (dist < infinity) {
+        vec3 to_light = rec.p + dist * direction - r.origin();
+        double length = to_light.length();
+        t_max = length - 0.001;
+        return ray(r.origin(), to_light / length, 0);
+    }
+#endif
+    t_max = dist - 0.001;
+    return r;
+}
+
 class hittable {
   public:
     virtual ~hittable() = default;
@@ -29,6 +79,37 @@ class hittable {
                      hit_record &rec) const = 0;
     virtual bool bounding_box(double time0, double time1,
                               aabb &output_box) const = 0;
+
+    // 阴影射线查询：(t_min, t_max) 内是否存在任意交点。
+    // 找到第一个交点即可返回，且不写 hit_record
+    virtual bool occluded(const ray &r, double t_min, double t_max) const {
+        hit_record rec;
+        return hit(r, t_min, t_max, rec);
+    }
+
+    // 光线包查询：对 count (不超过 kMaxRayPacketSize) 条光线分别求
+    // (t_min, t_max[i]) 内的最近交点 / 任意交点，结果与逐条调用 hit /
+    // occluded 相同。streams 非空时，测试第 i 条光线的图元前切换到
+    // streams[i] 这条随机流 (体积介质求交要消耗随机数)，之后写回。
+    // 默认实现逐条查询，支持包遍历的加速结构 (wide_bvh) 会覆盖它们
+    virtual void hit_packet(const ray *rays, int count, double t_min,
+                            const double *t_max, hit_record *recs, bool *hits,
+                            random_stream *streams,
+                            ray_packet_stats *stats) const {
+        for (int i = 0; i < count; ++i) {
+            random_stream_scope scope(streams ? &streams[i] : nullptr);
+            hits[i] = hit(rays[i], t_min, t_max[i], recs[i]);
+        }
+    }
+    virtual void occluded_packet(const ray *rays, int count, double t_min,
+                                 const double *t_max, bool *occluded_rays,
+                                 random_stream *streams,
+                                 ray_packet_stats *stats) const {
+        for (int i = 0; i < count; ++i) {
+            random_stream_scope scope(streams ? &streams[i] : nullptr);
+            occluded_rays[i] = occluded(rays[i], t_min, t_max[i]);
+        }
+    }
 };
 
 class translate : public hittable {
@@ -43,6 +124,12 @@ class translate : public hittable {
     virtual bool bounding_box(double time0, double time1,
                               aabb &output_box) const override;
 
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override {
+        return ptr->occluded(ray(r.origin() - offset, r.direction(), r.time()),
+                             t_min, t_max);
+    }
+
   public:
     shared_ptr<hittable> ptr;
     vec3 offset;
@@ -56,6 +143,7 @@ inline bool translate::hit(const ray &r, double t_min, double t_max,
     }
 
     rec.p += offset;
+    rec.p_error += error_gamma(1) * abs(rec.p);
     rec.set_face_normal(moved_r, rec.normal);
 
     return true;
@@ -85,12 +173,20 @@ class rotate_y : public hittable {
         return hasbox;
     }
 
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override {
+        return ptr->occluded(to_object(r), t_min, t_max);
+    }
+
   public:
     shared_ptr<hittable> ptr;
     double sin_theta;
     double cos_theta;
     bool hasbox;
     aabb bbox;
+
+  private:
+    ray to_object(const ray &r) const;
 };
 
 inline rotate_y::rotate_y(shared_ptr<hittable> p, double angle) : ptr(p) {
@@ -124,8 +220,7 @@ inline rotate_y::rotate_y(shared_ptr<hittable> p, double angle) : ptr(p) {
     bbox = aabb(min, max);
 }
 
-inline bool rotate_y::hit(const ray &r, double t_min, double t_max,
-                          hit_record &rec) const {
+inline ray rotate_y::to_object(const ray &r) const {
     auto origin = r.origin();
     auto direction = r.direction();
 
@@ -135,7 +230,12 @@ inline bool rotate_y::hit(const ray &r, double t_min, double t_max,
     direction[0] = cos_theta * r.direction()[0] - sin_theta * r.direction()[2];
     direction[2] = sin_theta * r.direction()[0] + cos_theta * r.direction()[2];
 
-    ray rotated_r(origin, direction, r.time());
+    return ray(origin, direction, r.time());
+}
+
+inline bool rotate_y::hit(const ray &r, double t_min, double t_max,
+                          hit_record &rec) const {
+    ray rotated_r = to_object(r);
 
     if (!ptr->hit(rotated_r, t_min, t_max, rec))
         return false;
@@ -149,7 +249,19 @@ inline bool rotate_y::hit(const ray &r, double t_min, double t_max,
     normal[0] = cos_theta * rec.normal[0] + sin_theta * rec.normal[2];
     normal[2] = -sin_theta * rec.normal[0] + cos_theta * rec.normal[2];
 
+    // 旋转后的误差：原误差按 |R| 传播，再加上本次运算的舍入
+    auto error = rec.p_error;
+    error[0] = (1 + error_gamma(3)) * (fabs(cos_theta) * rec.p_error[0] +
+                                       fabs(sin_theta) * rec.p_error[2]) +
+               error_gamma(3) * (fabs(cos_theta * rec.p[0]) +
+                                 fabs(sin_theta * rec.p[2]));
+    error[2] = (1 + error_gamma(3)) * (fabs(sin_theta) * rec.p_error[0] +
+                                       fabs(cos_theta) * rec.p_error[2]) +
+               error_gamma(3) * (fabs(sin_theta * rec.p[0]) +
+                                 fabs(cos_theta * rec.p[2]));
+
     rec.p = p;
+    rec.p_error = error;
     rec.set_face_normal(rotated_r, normal);
 
     return true;
@@ -174,6 +286,11 @@ class flip_face : public hittable {
         return ptr->bounding_box(time0, time1, output_box);
     }
 
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override {
+        return ptr->occluded(r, t_min, t_max);
+    }
+
   public:
     shared_ptr<hittable> ptr;
 };
@@ -26,12 +26,15 @@ class hittable_list : public hittable {
     virtual bool bounding_box(double time0, double time1,
                               aabb &output_box) const override;
 
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override;
+
   public:
     std::vector<shared_ptr<hittable>> objects;
 };
 
-bool hittable_list::hit(const ray &r, double t_min, double t_max,
-                        hit_record &rec) const {
+inline bool hittable_list::hit(const ray &r, double t_min, double t_max,
+                               hit_record &rec) const {
     hit_record temp_rec;
     bool hit_anything = false;
     auto closest_so_far = t_max;
@@ -46,8 +49,18 @@ bool hittable_list::hit(const ray &r, double t_min, double t_max,
     return hit_anything;
 }
 
-bool hittable_list::bounding_box(double time0, double time1,
-                                 aabb &output_box) const {
+inline bool hittable_list::occluded(const ray &r, double t_min,
+                                    double t_max) const {
+    for (const auto &object : objects) {
+        if (object->occluded(r, t_min, t_max)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool hittable_list::bounding_box(double time0, double time1,
+                                        aabb &output_box) const {
     if (objects.empty())
         return false;
 
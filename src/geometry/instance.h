@@ -0,0 +1,97 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <iostream>
+
+#include "bvh.h"
+#include "hittable.h"
+#include "hittable_list.h"
+#include "rtweekend.h"
+#include "scene_arena.h"
+#include "transform.h"
+#include "wide_bvh.h"
+
+// 两级加速结构中的实例：引用一个共享的底层加速结构 (BLAS)，
+// 并带有完整的 3x4 仿射变换。多个实例可以共享同一个 BLAS，
+// 顶层 BVH (TLAS) 直接在实例列表上用 bvh_node 构建即可
+class instance : public hittable {
+  public:
+    instance(shared_ptr<hittable> blas, const affine_transform &to_world);
+
+    virtual bool hit(const ray &r, double t_min, double t_max,
+                     hit_record &rec) const override;
+
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override {
+        return blas->occluded(to_object(r), t_min, t_max);
+    }
+
+    virtual bool bounding_box(double time0, double time1,
+                              aabb &output_box) const override;
+
+  public:
+    shared_ptr<hittable> blas;
+    affine_transform object_to_world;
+    affine_transform world_to_object;
+
+  private:
+    // 方向不归一化，因此局部空间的 t 与世界空间一致
+    ray to_object(const ray &r) const {
+        return ray(world_to_object.point(r.origin()),
+                   world_to_object.vector(r.direction()), r.time());
+    }
+};
+
+inline instance::instance(shared_ptr<hittable> object,
+                          const affine_transform &to_world)
+    : blas(object), object_to_world(to_world),
+      world_to_object(to_world.inverse()) {
+    if (fabs(to_world.determinant()) < kNearZeroThreshold) {
+        std::cerr << "instance: singular transform.\n";
+    }
+}
+
+inline bool instance::hit(const ray &r, double t_min, double t_max,
+                          hit_record &rec) const {
+    if (!blas->hit(to_object(r), t_min, t_max, rec)) {
+        return false;
+    }
+
+    // 法线用逆转置变换；它保持与光线方向点积的符号，front_face 无需重算
+    rec.p_error = object_to_world.point_error(rec.p, rec.p_error);
+    rec.p = object_to_world.point(rec.p);
+    rec.normal = unit_vector(world_to_object.transposed_vector(rec.normal));
+    return true;
+}
+
+inline bool instance::bounding_box(double time0, double time1,
+                                   aabb &output_box) const {
+    aabb local_box;
+    if (!blas->bounding_box(time0, time1, local_box)) {
+        return false;
+    }
+
+    point3 min(infinity, infinity, infinity);
+    point3 max(-infinity, -infinity, -infinity);
+    for (int i = 0; i < 8; ++i) {
+        point3 corner((i & 1) ? local_box.max().x() : local_box.min().x(),
+                      (i & 2) ? local_box.max().y() : local_box.min().y(),
+                      (i & 4) ? local_box.max().z() : local_box.min().z());
+        point3 p = object_to_world.point(corner);
+        for (int c = 0; c < 3; ++c) {
+            min[c] = fmin(min[c], p[c]);
+            max[c] = fmax(max[c], p[c]);
+        }
+    }
+    output_box = aabb(min, max);
+    return true;
+}
+
+// 为一组物体构建可被多个实例共享的 BLAS
+inline shared_ptr<hittable> make_blas(const hittable_list &objects,
+                                      double time0, double time1) {
+    return make_pooled<default_wide_bvh>(bvh_node(objects, time0, time1),
+                                         time0, time1);
+}
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef LINEAR_BVH_H
+#define LINEAR_BVH_H
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "aligned_allocator.h"
+#include "bvh.h"
+#include "hittable.h"
+#include "hittable_list.h"
+#include "rtweekend.h"
+
+// 扁平化 BVH 节点：深度优先排列，左孩子紧跟在父节点之后，
+// 内部节点只记录右孩子下标，叶子记录其图元在 primitives 中的区间。
+// double 和 float 模式下都补齐到 64 字节并按 64 字节对齐，每个节点
+// 正好占一条缓存行，不会跨行
+struct alignas(64) linear_bvh_node {
+    aabb box;
+    int32_t offset;  // 叶子：首个图元下标；内部节点：右孩子下标
+    uint16_t count;  // 叶子中的图元数，内部节点为 0
+    uint8_t axis;    // 内部节点的划分轴，用于决定先访问哪个孩子
+};
+static_assert(sizeof(linear_bvh_node) == 64 && alignof(linear_bvh_node) == 64,
+              "linear_bvh_node should fill exactly one cache line");
+
+// 由 bvh_node 树展开得到的无指针 BVH，使用显式栈迭代遍历
+class linear_bvh : public hittable {
+  public:
+    linear_bvh(const bvh_node &root, double time0, double time1);
+
+    linear_bvh(const hittable_list &list, double time0, double time1,
+               const bvh_build_options &options = bvh_node::default_options())
+        : linear_bvh(bvh_node(list, time0, time1, options), time0, time1) {
+    }
+
+    virtual bool hit(const ray &r, double t_min, double t_max,
+                     hit_record &rec) const override;
+
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override;
+
+    virtual bool bounding_box(double time0, double time1,
+                              aabb &output_box) const override {
+        output_box = nodes[0].box;
+        return true;
+    }
+
+    size_t node_count() const {
+        return nodes.size();
+    }
+    size_t primitive_count() const {
+        return primitives.size();
+    }
+
+    // 供其他加速结构（如 wide_bvh）在扁平化结果上继续构建
+    const aligned_vector<linear_bvh_node> &node_array() const {
+        return nodes;
+    }
+    const std::vector<shared_ptr<hittable>> &primitive_array() const {
+        return owned;
+    }
+
+  private:
+    // 遍历栈先用这么大的局部数组，更深的 (退化的) 树改用堆上的栈
+    static constexpr int kMaxStackDepth = 64;
+    static constexpr int kMaxLeafPrimitives =
+        std::numeric_limits<uint16_t>::max();
+
+    int flatten(const shared_ptr<hittable> &object, const aabb &object_box,
+                int depth);
+    int flatten_node(const bvh_node &node, const aabb &node_box, int depth);
+    void make_leaf(int index, int first, int count, int depth);
+    void add_primitives(const shared_ptr<hittable> &object);
+    aabb box_of(const shared_ptr<hittable> &object) const;
+
+    aligned_vector<linear_bvh_node> nodes;
+    std::vector<const hittable *> primitives;
+    // 保持图元存活；遍历时只访问 primitives 中的裸指针
+    std::vector<shared_ptr<hittable>> owned;
+    double time0, time1;
+    int max_depth = 0;
+};
+
+inline linear_bvh::linear_bvh(const bvh_node &root, double _time0,
+                              double _time1)
+    : time0(_time0), time1(_time1) {
+    flatten_node(root, root.box, 1);
+}
+
+inline aabb linear_bvh::box_of(const shared_ptr<hittable> &object) const {
+    aabb output_box;
+    if (!object->bounding_box(time0, time1, output_box)) {
+        std::cerr << "No bounding box in linear_bvh constructor.\n";
+    }
+    return output_box;
+}
+
+inline void linear_bvh::add_primitives(const shared_ptr<hittable> &object) {
+    // SAH 构建器产生的多图元叶子是 hittable_list，直接展开
+    if (auto list = std::dynamic_pointer_cast<hittable_list>(object)) {
+        for (const auto &child : list->objects) {
+            add_primitives(child);
+        }
+        return;
+    }
+    owned.push_back(object);
+    primitives.push_back(object.get());
+}
+
+inline int linear_bvh::flatten(const shared_ptr<hittable> &object,
+                               const aabb &object_box, int depth) {
+    if (auto node = std::dynamic_pointer_cast<bvh_node>(object)) {
+        return flatten_node(*node, object_box, depth);
+    }
+
+    // 单个图元 (或 hittable_list) 作为叶子
+    max_depth = std::max(max_depth, depth);
+    int index = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+    nodes[index].box = object_box;
+    int first = static_cast<int>(primitives.size());
+    add_primitives(object);
+    make_leaf(index, first, static_cast<int>(primitives.size()) - first,
+              depth);
+    return index;
+}
+
+inline int linear_bvh::flatten_node(const bvh_node &node,
+                                    const aabb &node_box, int depth) {
+    max_depth = std::max(max_depth, depth);
+
+    if (node.left == node.right) {
+        return flatten(node.left, node.box, depth);
+    }
+
+    int index = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+    nodes[index].box = node_box;
+
+    bool left_is_node =
+        std::dynamic_pointer_cast<bvh_node>(node.left) != nullptr;
+    bool right_is_node =
+        std::dynamic_pointer_cast<bvh_node>(node.right) != nullptr;
+
+    if (!left_is_node && !right_is_node) {
+        int first = static_cast<int>(primitives.size());
+        add_primitives(node.left);
+        add_primitives(node.right);
+        make_leaf(index, first, static_cast<int>(primitives.size()) - first,
+                  depth);
+        return index;
+    }
+
+    aabb left_box = box_of(node.left);
+    aabb right_box = box_of(node.right);
+
+    // 以两个孩子质心相距最远的轴作为划分轴
+    vec3 delta = (right_box.min() + right_box.max()) -
+                 (left_box.min() + left_box.max());
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+        if (fabs(delta[a]) > fabs(delta[axis])) {
+            axis = a;
+        }
+    }
+    // 保证 "第一个孩子" 在划分轴上更靠近负方向
+    bool swap_children = delta[axis] < 0;
+    const auto &first = swap_children ? node.right : node.left;
+    const auto &second = swap_children ? node.left : node.right;
+
+    flatten(first, swap_children ? right_box : left_box, depth + 1);
+    int second_index =
+        flatten(second, swap_children ? left_box : right_box, depth + 1);
+
+    nodes[index].offset = second_index;
+    nodes[index].count = 0;
+    nodes[index].axis = static_cast<uint8_t>(axis);
+    return index;
+}
+
+// 图元数超出 count 的 16 位范围的叶子 (由很大的 hittable_list 展开而来)
+// 拆成两半，直到每个叶子都放得下
+inline void linear_bvh::make_leaf(int index, int first, int count,
+                                  int depth) {
+    max_depth = std::max(max_depth, depth);
+    if (count <= kMaxLeafPrimitives) {
+        nodes[index].offset = first;
+        nodes[index].count = static_cast<uint16_t>(count);
+        nodes[index].axis = 0;
+        return;
+    }
+
+    int half = count / 2;
+    int ranges[2][2] = {{first, half}, {first + half, count - half}};
+    int children[2];
+    for (int c = 0; c < 2; ++c) {
+        children[c] = static_cast<int>(nodes.size());
+        nodes.emplace_back();
+        aabb box = box_of(owned[ranges[c][0]]);
+        for (int i = 1; i < ranges[c][1]; ++i) {
+            box = surrounding_box(box, box_of(owned[ranges[c][0] + i]));
+        }
+        nodes[children[c]].box = box;
+        make_leaf(children[c], ranges[c][0], ranges[c][1], depth + 1);
+    }
+    nodes[index].offset = children[1];
+    nodes[index].count = 0;
+    nodes[index].axis = 0;
+}
+
+inline bool linear_bvh::hit(const ray &r, double t_min, double t_max,
+                            hit_record &rec) const {
+    const int *dir_is_neg = r.direction_sign();
+    // 每层最多压入一个节点，栈深不超过树高
+    int local_stack[kMaxStackDepth];
+    std::vector<int> deep_stack;
+    int *stack = local_stack;
+    if (max_depth > kMaxStackDepth) {
+        deep_stack.resize(max_depth);
+        stack = deep_stack.data();
+    }
+    int stack_size = 0;
+    int current = 0;
+    bool hit_anything = false;
+    double closest_so_far = t_max;
+
+    while (true) {
+        const linear_bvh_node &node = nodes[current];
+        if (node.box.hit(r, t_min, closest_so_far)) {
+            if (node.count > 0) {
+                for (int i = 0; i < node.count; ++i) {
+                    if (primitives[node.offset + i]->hit(r, t_min,
+                                                         closest_so_far, rec)) {
+                        hit_anything = true;
+                        closest_so_far = rec.t;
+                    }
+                }
+                if (stack_size == 0) {
+                    break;
+                }
+                current = stack[--stack_size];
+            } else if (dir_is_neg[node.axis]) {
+                // 光线沿负方向前进：先访问右（正方向）孩子
+                stack[stack_size++] = current + 1;
+                current = node.offset;
+            } else {
+                stack[stack_size++] = node.offset;
+                current = current + 1;
+            }
+        } else {
+            if (stack_size == 0) {
+                break;
+            }
+            current = stack[--stack_size];
+        }
+    }
+    return hit_anything;
+}
+
+inline bool linear_bvh::occluded(const ray &r, double t_min,
+                                 double t_max) const {
+    // 任意交点即可，不需要按远近排序，第一次命中就返回
+    // 每层最多压入一个节点，栈深不超过树高
+    int local_stack[kMaxStackDepth];
+    std::vector<int> deep_stack;
+    int *stack = local_stack;
+    if (max_depth > kMaxStackDepth) {
+        deep_stack.resize(max_depth);
+        stack = deep_stack.data();
+    }
+    int stack_size = 0;
+    int current = 0;
+
+    while (true) {
+        const linear_bvh_node &node = nodes[current];
+        if (node.box.hit(r, t_min, t_max)) {
+            if (node.count > 0) {
+                for (int i = 0; i < node.count; ++i) {
+                    if (primitives[node.offset + i]->occluded(r, t_min,
+                                                              t_max)) {
+                        return true;
+                    }
+                }
+            } else {
+                stack[stack_size++] = node.offset;
+                current = current + 1;
+                continue;
+            }
+        }
+        if (stack_size == 0) {
+            return false;
+        }
+        current = stack[--stack_size];
+    }
+}
+
+#endif
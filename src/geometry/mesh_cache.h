@@ -0,0 +1,353 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "mapped_file.h"
+#include "obj_loader.h"
+#include "scene_arena.h"
+#include "triangle_mesh.h"
+
+// 网格缓存文件：<源文件>.rtmesh，依次存放文件头和 64 字节对齐的
+// positions / normals / uvs / indices / BVH 节点数组，布局与内存中完全一致。
+// 加载时 mmap 整个文件，triangle_mesh 直接引用映射内存，不解析也不重建 BVH
+constexpr uint32_t kMeshCacheVersion = 1;
+constexpr uint32_t kMeshCacheByteOrder = 0x01020304u;
+constexpr uint64_t kMeshCacheAlignment = 64;
+constexpr uint32_t kMeshCacheHasNormals = 1u << 0;
+constexpr uint32_t kMeshCacheHasUVs = 1u << 1;
+
+struct mesh_cache_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t header_bytes;
+    uint32_t node_width;
+    uint32_t node_bytes;
+    uint32_t max_leaf_size;
+    uint32_t sah_bins;
+    uint32_t flags;
+    double traversal_cost;
+    double intersection_cost;
+
+    // 源文件的大小和内容哈希，任一变化都说明缓存已过期
+    uint64_t source_bytes;
+    uint64_t source_hash;
+
+    uint64_t vertex_count;
+    uint64_t triangle_count;
+    uint64_t node_count;
+    uint64_t positions_offset;
+    uint64_t normals_offset;
+    uint64_t uvs_offset;
+    uint64_t indices_offset;
+    uint64_t nodes_offset;
+    uint64_t file_bytes;
+    double bounds[6];
+};
+
+// 源文件内容的 64 位哈希：四路并行按 8 字节字混合，速度接近内存带宽
+inline uint64_t hash_file_contents(const char *data, size_t size) {
+    const uint64_t kMultiplier = 0x9e3779b97f4a7c15ULL;
+    auto mix = [kMultiplier](uint64_t h, uint64_t word) {
+        h ^= word;
+        h = (h << 29) | (h >> 35);
+        return h * kMultiplier;
+    };
+
+    uint64_t lanes[4] = {size, 0x632be59bd9b4e019ULL, ~uint64_t(size),
+                         0x94d049bb133111ebULL};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int k = 0; k < 4; ++k) {
+            uint64_t word;
+            std::memcpy(&word, data + i + 8 * k, sizeof(word));
+            lanes[k] = mix(lanes[k], word);
+        }
+    }
+    for (; i < size; i += 8) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + i, std::min<size_t>(8, size - i));
+        lanes[0] = mix(lanes[0], word);
+    }
+
+    uint64_t h = lanes[0];
+    for (int k = 1; k < 4; ++k) {
+        h = mix(h, lanes[k]);
+    }
+    return h ^ (h >> 32);
+}
+
+// 填写与构建选项和源文件相关的字段，数组信息由 mesh_cache_layout 补全
+inline mesh_cache_header
+make_mesh_cache_header(const bvh_build_options &options, uint64_t source_bytes,
+                       uint64_t source_hash) {
+    mesh_cache_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "RTMESH\0", 8);
+    header.version = kMeshCacheVersion;
+    header.byte_order = kMeshCacheByteOrder;
+    header.header_bytes = sizeof(mesh_cache_header);
+    header.node_width = kDefaultWideBVHWidth;
+    header.node_bytes = sizeof(mesh_bvh_node);
+    header.max_leaf_size = static_cast<uint32_t>(options.max_leaf_size);
+    header.sah_bins = static_cast<uint32_t>(options.sah_bins);
+    header.traversal_cost = options.traversal_cost;
+    header.intersection_cost = options.intersection_cost;
+    header.source_bytes = source_bytes;
+    header.source_hash = source_hash;
+    return header;
+}
+
+// 根据各数组的元素数计算对齐后的偏移和文件总大小
+inline void mesh_cache_layout(mesh_cache_header &header) {
+    auto align = [](uint64_t offset) {
+        return (offset + kMeshCacheAlignment - 1) & ~(kMeshCacheAlignment - 1);
+    };
+    const uint64_t vertices = header.vertex_count;
+    uint64_t offset = align(sizeof(mesh_cache_header));
+    header.positions_offset = offset;
+    offset = align(offset + vertices * 3 * sizeof(float));
+    header.normals_offset = offset;
+    if (header.flags & kMeshCacheHasNormals) {
+        offset = align(offset + vertices * 3 * sizeof(float));
+    }
+    header.uvs_offset = offset;
+    if (header.flags & kMeshCacheHasUVs) {
+        offset = align(offset + vertices * 2 * sizeof(float));
+    }
+    header.indices_offset = offset;
+    offset = align(offset + header.triangle_count * 3 * sizeof(uint32_t));
+    header.nodes_offset = offset;
+    header.file_bytes = offset + header.node_count * sizeof(mesh_bvh_node);
+}
+
+// 校验缓存文件头：键值字段必须与 expected 一致，
+// 偏移必须与按元素数重新计算的布局一致，文件大小必须完整
+inline bool mesh_cache_matches(const mesh_cache_header &expected,
+                               const mapped_file &file,
+                               mesh_cache_header &stored) {
+    if (file.size() < sizeof(mesh_cache_header)) {
+        return false;
+    }
+    std::memcpy(&stored, file.data(), sizeof(stored));
+
+    if (std::memcmp(stored.magic, expected.magic, sizeof(stored.magic)) != 0 ||
+        stored.version != expected.version ||
+        stored.byte_order != expected.byte_order ||
+        stored.header_bytes != expected.header_bytes ||
+        stored.node_width != expected.node_width ||
+        stored.node_bytes != expected.node_bytes ||
+        stored.max_leaf_size != expected.max_leaf_size ||
+        stored.sah_bins != expected.sah_bins ||
+        stored.traversal_cost != expected.traversal_cost ||
+        stored.intersection_cost != expected.intersection_cost ||
+        stored.source_bytes != expected.source_bytes ||
+        stored.source_hash != expected.source_hash) {
+        return false;
+    }
+    if (stored.vertex_count == 0 || stored.triangle_count == 0 ||
+        stored.node_count == 0 || stored.vertex_count > 0xffffffffULL) {
+        return false;
+    }
+
+    mesh_cache_header layout = stored;
+    mesh_cache_layout(layout);
+    return std::memcmp(&layout, &stored, sizeof(layout)) == 0 &&
+           stored.file_bytes == file.size();
+}
+
+// 校验映射进来的数组内容：三角形的顶点下标必须小于顶点数；
+// 叶子的三角形区间必须在三角形数以内；内部孩子必须是下标更大的节点
+// (坍缩时孩子总排在父节点之后)，保证遍历不会越界也不会成环。
+// 只在加载时整体检查一遍，求交时不再检查
+inline bool mesh_cache_contents_valid(const mesh_view &view) {
+    for (size_t i = 0; i < 3 * view.triangle_count; ++i) {
+        if (view.indices[i] >= view.vertex_count) {
+            return false;
+        }
+    }
+    for (size_t n = 0; n < view.node_count; ++n) {
+        const mesh_bvh_node &node = view.nodes[n];
+        for (int i = 0; i < kDefaultWideBVHWidth; ++i) {
+            const int64_t child = node.child[i];
+            if (child == -1 && node.count[i] == 0) {
+                continue; // 空位
+            }
+            if (child < 0) {
+                return false;
+            }
+            if (node.count[i] > 0) {
+                if (static_cast<uint64_t>(child) + node.count[i] >
+                    view.triangle_count) {
+                    return false;
+                }
+            } else if (static_cast<uint64_t>(child) <= n ||
+                       static_cast<uint64_t>(child) >= view.node_count) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 映射有效的缓存并构造直接引用映射内存的网格；缓存缺失、过期或损坏时
+// 返回 nullptr，由调用者重新构建
+inline shared_ptr<triangle_mesh>
+open_mesh_cache(const std::string &path, const mesh_cache_header &expected,
+                shared_ptr<material> m) {
+    shared_ptr<mapped_file> file = mapped_file::open(path.c_str());
+    if (!file) {
+        return nullptr;
+    }
+    mesh_cache_header header;
+    if (!mesh_cache_matches(expected, *file, header)) {
+        std::cerr << "Mesh cache '" << path << "' is stale, rebuilding.\n";
+        return nullptr;
+    }
+
+    const char *base = file->data();
+    mesh_view view;
+    view.positions =
+        reinterpret_cast<const float *>(base + header.positions_offset);
+    if (header.flags & kMeshCacheHasNormals) {
+        view.normals =
+            reinterpret_cast<const float *>(base + header.normals_offset);
+    }
+    if (header.flags & kMeshCacheHasUVs) {
+        view.uvs = reinterpret_cast<const float *>(base + header.uvs_offset);
+    }
+    view.indices =
+        reinterpret_cast<const uint32_t *>(base + header.indices_offset);
+    view.nodes =
+        reinterpret_cast<const mesh_bvh_node *>(base + header.nodes_offset);
+    view.vertex_count = static_cast<size_t>(header.vertex_count);
+    view.triangle_count = static_cast<size_t>(header.triangle_count);
+    view.node_count = static_cast<size_t>(header.node_count);
+    if (!mesh_cache_contents_valid(view)) {
+        std::cerr << "Mesh cache '" << path << "' is corrupt, rebuilding.\n";
+        return nullptr;
+    }
+
+    aabb bounds(point3(header.bounds[0], header.bounds[1], header.bounds[2]),
+                point3(header.bounds[3], header.bounds[4], header.bounds[5]));
+    return make_pooled<triangle_mesh>(view, bounds, std::move(file),
+                                      std::move(m));
+}
+
+// 写出缓存：先写临时文件再改名，中途失败不会留下不完整的缓存
+inline bool write_mesh_cache(const std::string &path,
+                             const mesh_cache_header &key,
+                             const triangle_mesh &mesh) {
+    const mesh_view &view = mesh.view();
+    mesh_cache_header header = key;
+    header.vertex_count = view.vertex_count;
+    header.triangle_count = view.triangle_count;
+    header.node_count = view.node_count;
+    header.flags = (view.normals ? kMeshCacheHasNormals : 0) |
+                   (view.uvs ? kMeshCacheHasUVs : 0);
+    mesh_cache_layout(header);
+
+    aabb bounds;
+    mesh.bounding_box(0, 0, bounds);
+    for (int a = 0; a < 3; ++a) {
+        header.bounds[a] = bounds.min()[a];
+        header.bounds[3 + a] = bounds.max()[a];
+    }
+
+    std::string temp_path = path + ".tmp";
+    FILE *file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR: Could not write mesh cache '" << temp_path
+                  << "'.\n";
+        return false;
+    }
+
+    uint64_t written = 0;
+    bool ok = true;
+    auto write_at = [&](uint64_t offset, const void *data, uint64_t bytes) {
+        static const char zeros[kMeshCacheAlignment] = {};
+        while (ok && written < offset) {
+            uint64_t pad = std::min<uint64_t>(offset - written, sizeof(zeros));
+            ok = std::fwrite(zeros, 1, pad, file) == pad;
+            written += pad;
+        }
+        if (ok && bytes > 0) {
+            ok = std::fwrite(data, 1, bytes, file) == bytes;
+            written += bytes;
+        }
+    };
+    const uint64_t vertices = header.vertex_count;
+    write_at(0, &header, sizeof(header));
+    write_at(header.positions_offset, view.positions,
+             vertices * 3 * sizeof(float));
+    if (view.normals) {
+        write_at(header.normals_offset, view.normals,
+                 vertices * 3 * sizeof(float));
+    }
+    if (view.uvs) {
+        write_at(header.uvs_offset, view.uvs, vertices * 2 * sizeof(float));
+    }
+    write_at(header.indices_offset, view.indices,
+             header.triangle_count * 3 * sizeof(uint32_t));
+    write_at(header.nodes_offset, view.nodes,
+             header.node_count * sizeof(mesh_bvh_node));
+    ok = std::fclose(file) == 0 && ok;
+
+    if (ok) {
+#ifdef _WIN32
+        // Windows 上 rename 不会覆盖已存在的文件
+        std::remove(path.c_str());
+#endif
+        ok = std::rename(temp_path.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) {
+        std::remove(temp_path.c_str());
+        std::cerr << "ERROR: Could not write mesh cache '" << path << "'.\n";
+    }
+    return ok;
+}
+
+// 带缓存的 OBJ 加载：缓存有效时直接映射，否则解析 OBJ、构建 BVH 并写出缓存
+inline shared_ptr<triangle_mesh> load_obj_cached(
+    const char *filename, shared_ptr<material> m,
+    const bvh_build_options &options = triangle_mesh::default_options()) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    mesh_cache_header key;
+    {
+        shared_ptr<mapped_file> source = mapped_file::open(filename);
+        if (!source) {
+            return load_obj(filename, std::move(m), options);
+        }
+        key = make_mesh_cache_header(
+            options, source->size(),
+            hash_file_contents(source->data(), source->size()));
+    }
+
+    std::string cache_path = std::string(filename) + ".rtmesh";
+    shared_ptr<triangle_mesh> mesh = open_mesh_cache(cache_path, key, m);
+    if (mesh) {
+        std::chrono::duration<double> elapsed =
+            std::chrono::high_resolution_clock::now() - start_time;
+        std::cerr << "Mapped '" << cache_path << "': " << mesh->vertex_count()
+                  << " vertices, " << mesh->triangle_count() << " triangles, "
+                  << mesh->memory_bytes() / (1024.0 * 1024.0) << " MiB in "
+                  << elapsed.count() << " s.\n";
+        return mesh;
+    }
+
+    mesh = load_obj(filename, std::move(m), options);
+    if (mesh) {
+        write_mesh_cache(cache_path, key, *mesh);
+    }
+    return mesh;
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef MORTON_H
+#define MORTON_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "thread_pool.h"
+
+// 把 x 的低 21 位分散到每 3 位中的最低位（10 位输入时结果不超过 30 位）
+inline uint64_t morton_split_by_3(uint64_t x) {
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8) & 0x100f00f00f00f00fULL;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2) & 0x1249249249249249ULL;
+    return x;
+}
+
+// 输入为 [0, 1] 内的归一化坐标，bits_per_axis 为 10 (30 位码) 或 21 (63 位码)
+inline uint64_t morton_encode(double x, double y, double z, int bits_per_axis) {
+    const double scale = static_cast<double>((1u << bits_per_axis) - 1);
+    auto quantize = [scale](double v) {
+        v = std::min(std::max(v, 0.0), 1.0);
+        return static_cast<uint64_t>(v * scale);
+    };
+    return (morton_split_by_3(quantize(x)) << 2) |
+           (morton_split_by_3(quantize(y)) << 1) |
+           morton_split_by_3(quantize(z));
+}
+
+// 按 key 对 (key, value) 做稳定的 LSD 基数排序，每趟 8 位。
+// 元素较多且给定线程池时，每趟按块并行统计直方图和分发
+inline void radix_sort_by_key(std::vector<uint64_t> &keys,
+                              std::vector<uint32_t> &values, int key_bits,
+                              thread_pool *pool = nullptr) {
+    constexpr int kDigitBits = 8;
+    constexpr int kBuckets = 1 << kDigitBits;
+    constexpr size_t kParallelThreshold = 1 << 16;
+
+    const size_t n = keys.size();
+    const int chunks = pool && n > kParallelThreshold ? pool->size() : 1;
+    const size_t chunk_size = (n + chunks - 1) / chunks;
+
+    std::vector<uint64_t> temp_keys(n);
+    std::vector<uint32_t> temp_values(n);
+    std::vector<size_t> offsets(static_cast<size_t>(chunks) * kBuckets);
+
+    auto for_each_chunk = [&](auto &&fn) {
+        if (chunks == 1) {
+            fn(0);
+            return;
+        }
+        pool->parallel_for(chunks, fn);
+    };
+
+    for (int shift = 0; shift < key_bits; shift += kDigitBits) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+
+        for_each_chunk([&](int c) {
+            size_t *hist = &offsets[static_cast<size_t>(c) * kBuckets];
+            size_t begin = c * chunk_size;
+            size_t end = std::min(n, begin + chunk_size);
+            for (size_t i = begin; i < end; ++i) {
+                hist[(keys[i] >> shift) & (kBuckets - 1)]++;
+            }
+        });
+
+        // 按 (digit, chunk) 顺序求前缀和，保证排序稳定
+        size_t running = 0;
+        for (int d = 0; d < kBuckets; ++d) {
+            for (int c = 0; c < chunks; ++c) {
+                size_t &slot = offsets[static_cast<size_t>(c) * kBuckets + d];
+                size_t count = slot;
+                slot = running;
+                running += count;
+            }
+        }
+
+        for_each_chunk([&](int c) {
+            size_t *offset = &offsets[static_cast<size_t>(c) * kBuckets];
+            size_t begin = c * chunk_size;
+            size_t end = std::min(n, begin + chunk_size);
+            for (size_t i = begin; i < end; ++i) {
+                size_t dst = offset[(keys[i] >> shift) & (kBuckets - 1)]++;
+                temp_keys[dst] = keys[i];
+                temp_values[dst] = values[i];
+            }
+        });
+
+        keys.swap(temp_keys);
+        values.swap(temp_values);
+    }
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include "hittable.h"
 #include "ray.h"
 #include "rtweekend.h"
+#include "sphere.h"
 #include "vec3.h"
 
 class moving_sphere : public hittable {
@@ -20,6 +21,8 @@ class moving_sphere : public hittable {
                      hit_record &rec) const override;
     virtual bool bounding_box(double _time0, double _time1,
                               aabb &output_box) const override;
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override;
     point3 center(double time) const;
 
   public:
@@ -29,40 +32,33 @@ class moving_sphere : public hittable {
     shared_ptr<material> mat_ptr;
 };
 
-point3 moving_sphere::center(double time) const {
+inline point3 moving_sphere::center(double time) const {
     return center0 + ((time - time0) / (time1 - time0)) * (center1 - center0);
 }
 
-bool moving_sphere::hit(const ray &r, double t_min, double t_max,
-                        hit_record &rec) const {
-    vec3 oc = r.origin() - center(r.time());
-    auto a = r.direction().length_squared();
-    auto half_b = dot(oc, r.direction());
-    auto c = oc.length_squared() - radius * radius;
-
-    auto discriminant = half_b * half_b - a * c;
-    if (discriminant < 0)
+inline bool moving_sphere::hit(const ray &r, double t_min, double t_max,
+                               hit_record &rec) const {
+    point3 cen = center(r.time());
+    double root;
+    if (!hit_sphere(r, cen, radius, t_min, t_max, root))
         return false;
-    auto sqrtd = sqrt(discriminant);
-
-    auto root = (-half_b - sqrtd) / a;
-    if (root < t_min || root > t_max) {
-        root = (-half_b + sqrtd) / a;
-        if (root < t_min || root > t_max)
-            return false;
-    }
 
     rec.t = root;
-    rec.p = r.at(rec.t);
-    auto outward_normal = (rec.p - center(r.time())) / radius;
+    vec3 outward_normal = set_sphere_hit_point(r, root, cen, radius, rec);
     rec.set_face_normal(r, outward_normal);
     rec.mat_ptr = mat_ptr.get();
 
     return true;
 }
 
-bool moving_sphere::bounding_box(double _time0, double _time1,
-                                 aabb &output_box) const {
+inline bool moving_sphere::occluded(const ray &r, double t_min,
+                                    double t_max) const {
+    double root;
+    return hit_sphere(r, center(r.time()), radius, t_min, t_max, root);
+}
+
+inline bool moving_sphere::bounding_box(double _time0, double _time1,
+                                        aabb &output_box) const {
     aabb box0(center(_time0) - vec3(radius, radius, radius),
               center(_time0) + vec3(radius, radius, radius));
     aabb box1(center(_time1) - vec3(radius, radius, radius),
@@ -0,0 +1,371 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "scene_arena.h"
+#include "triangle_mesh.h"
+
+constexpr size_t kObjChunkSize = 1 << 20;
+constexpr uint32_t kObjNoIndex = 0xffffffffu;
+
+// 流式 OBJ 读取器：按固定大小的块读文件，直接在缓冲区上移动指针解析，
+// 不为每一行构造临时字符串。支持 v / vt / vn / f（负索引、任意多边形按扇形
+// 三角化），其余语句（o、g、s、usemtl 等）忽略。
+// 只有位置的角点直接按位置下标映射，带 vt / vn 的角点经哈希表去重为统一顶点
+class obj_reader {
+  public:
+    bool read(const char *filename, mesh_data &out);
+
+    size_t skipped_faces = 0;
+
+  private:
+    struct corner_key {
+        uint32_t position, uv, normal;
+        bool operator==(const corner_key &o) const {
+            return position == o.position && uv == o.uv && normal == o.normal;
+        }
+    };
+    struct corner_hash {
+        size_t operator()(const corner_key &k) const {
+            uint64_t h = k.position * 0x9e3779b97f4a7c15ULL;
+            h ^= (k.uv + 0x632be59bd9b4e019ULL) * 0xbf58476d1ce4e5b9ULL;
+            h ^= (k.normal + 0x94d049bb133111ebULL) * 0x94d049bb133111ebULL;
+            return static_cast<size_t>(h ^ (h >> 31));
+        }
+    };
+
+    void parse_line(const char *p, const char *end);
+    void parse_face(const char *p, const char *end);
+    bool resolve(long index, size_t count, uint32_t &resolved) const;
+    uint32_t vertex_for(uint32_t position, uint32_t uv, uint32_t normal);
+
+    static bool parse_float(const char *&p, const char *end, float &value);
+    static bool parse_int(const char *&p, const char *end, long &value);
+    static void skip_spaces(const char *&p, const char *end) {
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            ++p;
+        }
+    }
+
+    mesh_data *mesh = nullptr;
+    std::vector<float> raw_positions;
+    std::vector<float> raw_uvs;
+    std::vector<float> raw_normals;
+    std::vector<uint32_t> position_vertex; // 仅位置角点：位置下标 -> 顶点
+    std::unordered_map<corner_key, uint32_t, corner_hash> corner_vertex;
+    std::vector<uint32_t> polygon;
+};
+
+inline bool obj_reader::read(const char *filename, mesh_data &out) {
+    FILE *file = std::fopen(filename, "rb");
+    if (!file) {
+        std::cerr << "ERROR: Could not open OBJ file '" << filename << "'.\n";
+        return false;
+    }
+
+    mesh = &out;
+    std::vector<char> buffer(kObjChunkSize);
+    size_t carry = 0;
+    while (true) {
+        size_t got = std::fread(buffer.data() + carry, 1,
+                                buffer.size() - carry, file);
+        size_t filled = carry + got;
+        bool at_end = filled < buffer.size();
+        const char *begin = buffer.data();
+        const char *end = begin + filled;
+
+        // 只解析完整的行，最后半行留到下一块
+        const char *last = end;
+        if (!at_end) {
+            while (last > begin && last[-1] != '\n') {
+                --last;
+            }
+            if (last == begin) {
+                // 单行比缓冲区还长，扩大缓冲区后继续读
+                carry = filled;
+                buffer.resize(buffer.size() * 2);
+                continue;
+            }
+        }
+
+        const char *p = begin;
+        while (p < last) {
+            const char *line_end = static_cast<const char *>(
+                std::memchr(p, '\n', last - p));
+            if (!line_end) {
+                line_end = last;
+            }
+            parse_line(p, line_end);
+            p = line_end + 1;
+        }
+
+        if (at_end) {
+            break;
+        }
+        carry = end - last;
+        std::memmove(buffer.data(), last, carry);
+    }
+    std::fclose(file);
+
+    // 原始属性数组不再需要；释放多余容量，使内存接近顶点数据本身的大小
+    std::vector<float>().swap(raw_positions);
+    std::vector<float>().swap(raw_uvs);
+    std::vector<float>().swap(raw_normals);
+    std::vector<uint32_t>().swap(position_vertex);
+    corner_vertex.clear();
+    out.positions.shrink_to_fit();
+    out.normals.shrink_to_fit();
+    out.uvs.shrink_to_fit();
+    out.indices.shrink_to_fit();
+    return true;
+}
+
+inline void obj_reader::parse_line(const char *p, const char *end) {
+    skip_spaces(p, end);
+    if (end - p < 2) {
+        return;
+    }
+
+    float x, y, z;
+    if (p[0] == 'f') {
+        if (p[1] == ' ' || p[1] == '\t') {
+            parse_face(p + 2, end);
+        }
+        return;
+    }
+    if (p[0] != 'v') {
+        return;
+    }
+    if (p[1] == ' ' || p[1] == '\t') {
+        p += 2;
+        if (parse_float(p, end, x) && parse_float(p, end, y) &&
+            parse_float(p, end, z)) {
+            raw_positions.insert(raw_positions.end(), {x, y, z});
+        }
+    } else if (p[1] == 't') {
+        p += 2;
+        if (parse_float(p, end, x)) {
+            if (!parse_float(p, end, y)) {
+                y = 0;
+            }
+            raw_uvs.insert(raw_uvs.end(), {x, y});
+        }
+    } else if (p[1] == 'n') {
+        p += 2;
+        if (parse_float(p, end, x) && parse_float(p, end, y) &&
+            parse_float(p, end, z)) {
+            raw_normals.insert(raw_normals.end(), {x, y, z});
+        }
+    }
+}
+
+inline void obj_reader::parse_face(const char *p, const char *end) {
+    polygon.clear();
+    while (true) {
+        long position, uv = 0, normal = 0;
+        if (!parse_int(p, end, position)) {
+            break;
+        }
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/') {
+                parse_int(p, end, uv);
+            }
+            if (p < end && *p == '/') {
+                ++p;
+                parse_int(p, end, normal);
+            }
+        }
+
+        uint32_t pi, ti = kObjNoIndex, ni = kObjNoIndex;
+        if (!resolve(position, raw_positions.size() / 3, pi) ||
+            (uv != 0 && !resolve(uv, raw_uvs.size() / 2, ti)) ||
+            (normal != 0 && !resolve(normal, raw_normals.size() / 3, ni))) {
+            skipped_faces++;
+            return;
+        }
+        polygon.push_back(vertex_for(pi, ti, ni));
+    }
+
+    if (polygon.size() < 3) {
+        skipped_faces++;
+        return;
+    }
+    for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+        mesh->indices.insert(mesh->indices.end(),
+                             {polygon[0], polygon[i], polygon[i + 1]});
+    }
+}
+
+// OBJ 下标从 1 开始，负数表示相对当前已读入元素的末尾
+inline bool obj_reader::resolve(long index, size_t count,
+                                uint32_t &resolved) const {
+    long value = index > 0 ? index - 1 : static_cast<long>(count) + index;
+    if (index == 0 || value < 0 || static_cast<size_t>(value) >= count) {
+        return false;
+    }
+    resolved = static_cast<uint32_t>(value);
+    return true;
+}
+
+inline uint32_t obj_reader::vertex_for(uint32_t position, uint32_t uv,
+                                       uint32_t normal) {
+    uint32_t *slot;
+    if (uv == kObjNoIndex && normal == kObjNoIndex) {
+        if (position_vertex.size() <= position) {
+            position_vertex.resize(raw_positions.size() / 3, kObjNoIndex);
+        }
+        slot = &position_vertex[position];
+    } else {
+        auto inserted = corner_vertex.emplace(
+            corner_key{position, uv, normal}, kObjNoIndex);
+        slot = &inserted.first->second;
+    }
+    if (*slot != kObjNoIndex) {
+        return *slot;
+    }
+
+    // 新顶点：属性数组要么为空，要么与顶点数等长，缺失的属性补 0
+    uint32_t vertex = static_cast<uint32_t>(mesh->vertex_count());
+    const float *p = &raw_positions[3 * position];
+    mesh->positions.insert(mesh->positions.end(), {p[0], p[1], p[2]});
+
+    if (uv != kObjNoIndex && mesh->uvs.empty()) {
+        mesh->uvs.resize(2 * static_cast<size_t>(vertex), 0.0f);
+    }
+    if (!mesh->uvs.empty() || uv != kObjNoIndex) {
+        const float *t = uv != kObjNoIndex ? &raw_uvs[2 * uv] : nullptr;
+        mesh->uvs.push_back(t ? t[0] : 0.0f);
+        mesh->uvs.push_back(t ? t[1] : 0.0f);
+    }
+
+    if (normal != kObjNoIndex && mesh->normals.empty()) {
+        mesh->normals.resize(3 * static_cast<size_t>(vertex), 0.0f);
+    }
+    if (!mesh->normals.empty() || normal != kObjNoIndex) {
+        const float *n = normal != kObjNoIndex ? &raw_normals[3 * normal]
+                                             : nullptr;
+        mesh->normals.push_back(n ? n[0] : 0.0f);
+        mesh->normals.push_back(n ? n[1] : 0.0f);
+        mesh->normals.push_back(n ? n[2] : 0.0f);
+    }
+
+    *slot = vertex;
+    return vertex;
+}
+
+// 与 locale 无关的十进制浮点解析，不支持 inf / nan
+inline bool obj_reader::parse_float(const char *&p, const char *end,
+                                    float &value) {
+    static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                    1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                    1e18, 1e19, 1e20, 1e21, 1e22};
+
+    skip_spaces(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p++ == '-';
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, ++digits) {
+        if (mantissa < 100000000000000000ULL) {
+            mantissa = mantissa * 10 + (*p - '0');
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits) {
+            if (mantissa < 100000000000000000ULL) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            }
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        long e;
+        if (parse_int(p, end, e)) {
+            exponent += static_cast<int>(e);
+        }
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (exponent < 0) {
+        result = exponent >= -22 ? result / kPow10[-exponent]
+                                 : result * std::pow(10.0, exponent);
+    } else if (exponent > 0) {
+        result = exponent <= 22 ? result * kPow10[exponent]
+                                : result * std::pow(10.0, exponent);
+    }
+    value = static_cast<float>(negative ? -result : result);
+    return true;
+}
+
+inline bool obj_reader::parse_int(const char *&p, const char *end,
+                                  long &value) {
+    skip_spaces(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p++ == '-';
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+        return false;
+    }
+    long result = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        result = result * 10 + (*p - '0');
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+// 读取 OBJ 并构建三角网格，失败时返回 nullptr
+inline shared_ptr<triangle_mesh>
+load_obj(const char *filename, shared_ptr<material> m,
+         const bvh_build_options &options = triangle_mesh::default_options()) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    obj_reader reader;
+    mesh_data data;
+    if (!reader.read(filename, data)) {
+        return nullptr;
+    }
+    if (reader.skipped_faces > 0) {
+        std::cerr << "OBJ '" << filename << "': skipped "
+                  << reader.skipped_faces << " invalid faces.\n";
+    }
+    if (data.triangle_count() == 0) {
+        std::cerr << "ERROR: OBJ file '" << filename
+                  << "' contains no triangles.\n";
+        return nullptr;
+    }
+
+    auto mesh = make_pooled<triangle_mesh>(std::move(data), std::move(m),
+                                           options);
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::high_resolution_clock::now() - start_time;
+    std::cerr << "Loaded '" << filename << "': " << mesh->vertex_count()
+              << " vertices, " << mesh->triangle_count() << " triangles, "
+              << mesh->memory_bytes() / (1024.0 * 1024.0) << " MiB in "
+              << elapsed.count() << " s (BVH " << mesh->build_seconds
+              << " s).\n";
+    return mesh;
+}
+
+#endif
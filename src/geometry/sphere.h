@@ -15,6 +15,9 @@ class sphere : public hittable {
     virtual bool bounding_box(double time0, double time1,
                               aabb &output_box) const override;
 
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override;
+
   public:
     point3 center;
     double radius;
@@ -30,28 +33,49 @@ class sphere : public hittable {
     }
 };
 
-bool sphere::hit(const ray &r, double t_min, double t_max,
-                 hit_record &rec) const {
+// 光线与球心在 center、半径为 radius 的球在 [t_min, t_max] 内最近的交点。
+// 判别式按 a (r^2 - |oc - (half_b / a) d|^2) 计算，与 half_b^2 - a c 相等，
+// 但避免了 c = |oc|^2 - r^2 的相消误差：float 模式下这一误差足以让反弹
+// 光线再次击中出发的球面 (Ray Tracing Gems 第 7 章)
+inline bool hit_sphere(const ray &r, const point3 &center, double radius,
+                       double t_min, double t_max, double &root) {
     vec3 oc = r.origin() - center;
     auto a = r.direction().length_squared();
     auto half_b = dot(oc, r.direction());
-    auto c = oc.length_squared() - radius * radius;
-
-    auto discriminant = half_b * half_b - a * c;
+    vec3 l = oc - (half_b / a) * r.direction();
+    auto discriminant = a * (radius * radius - l.length_squared());
     if (discriminant < 0)
         return false;
     auto sqrtd = sqrt(discriminant);
 
-    auto root = (-half_b - sqrtd) / a;
+    root = (-half_b - sqrtd) / a;
     if (root < t_min || root > t_max) {
         root = (-half_b + sqrtd) / a;
         if (root < t_min || root > t_max)
             return false;
     }
+    return true;
+}
+
+// 把 r.at(t) 投影回球面作为交点，返回外法线。投影后交点的误差只与
+// 坐标的量级有关，不随 t 增长 (PBRT 3.9.4)
+inline vec3 set_sphere_hit_point(const ray &r, double t, const point3 &center,
+                                 double radius, hit_record &rec) {
+    vec3 outward_normal = unit_vector(r.at(t) - center);
+    rec.p = center + radius * outward_normal;
+    rec.p_error = error_gamma(5) * radius * abs(outward_normal) +
+                  error_gamma(1) * abs(rec.p);
+    return outward_normal;
+}
+
+inline bool sphere::hit(const ray &r, double t_min, double t_max,
+                        hit_record &rec) const {
+    double root;
+    if (!hit_sphere(r, center, radius, t_min, t_max, root))
+        return false;
 
     rec.t = root;
-    rec.p = r.at(rec.t);
-    vec3 outward_normal = (rec.p - center) / radius;
+    vec3 outward_normal = set_sphere_hit_point(r, root, center, radius, rec);
     rec.set_face_normal(r, outward_normal);
     get_sphere_uv(outward_normal, rec.u, rec.v);
     rec.mat_ptr = mat_ptr.get();
@@ -59,7 +83,14 @@ bool sphere::hit(const ray &r, double t_min, double t_max,
     return true;
 }
 
-bool sphere::bounding_box(double time0, double time1, aabb &output_box) const {
+inline bool sphere::occluded(const ray &r, double t_min,
+                             double t_max) const {
+    double root;
+    return hit_sphere(r, center, radius, t_min, t_max, root);
+}
+
+inline bool sphere::bounding_box(double time0, double time1,
+                                 aabb &output_box) const {
     output_box = aabb(center - vec3(radius, radius, radius),
                       center + vec3(radius, radius, radius));
     return true;
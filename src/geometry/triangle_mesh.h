@@ -0,0 +1,486 @@
+#ifndef TRIANGLE_MESH_H
+#define TRIANGLE_MESH_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "aligned_allocator.h"
+#include "bvh.h"
+#include "hittable.h"
+#include "linear_bvh.h"
+#include "rtweekend.h"
+#include "thread_pool.h"
+#include "wide_bvh.h"
+
+class material;
+
+// 索引三角网格的顶点数据：各属性按顶点存成扁平 float 数组，
+// normals / uvs 可以为空；indices 中每三个下标构成一个三角形
+struct mesh_data {
+    std::vector<float> positions; // x y z
+    std::vector<float> normals;   // x y z
+    std::vector<float> uvs;       // u v
+    std::vector<uint32_t> indices;
+
+    size_t vertex_count() const {
+        return positions.size() / 3;
+    }
+    size_t triangle_count() const {
+        return indices.size() / 3;
+    }
+    size_t memory_bytes() const {
+        return (positions.capacity() + normals.capacity() + uvs.capacity()) *
+                   sizeof(float) +
+               indices.capacity() * sizeof(uint32_t);
+    }
+};
+
+using mesh_bvh_node = wide_bvh_node<kDefaultWideBVHWidth>;
+
+// 网格各数组的只读视图，既可以指向 triangle_mesh 自有的内存，
+// 也可以直接指向内存映射的网格缓存文件
+struct mesh_view {
+    const float *positions = nullptr;
+    const float *normals = nullptr; // 可为空
+    const float *uvs = nullptr;     // 可为空
+    const uint32_t *indices = nullptr;
+    const mesh_bvh_node *nodes = nullptr;
+    size_t vertex_count = 0;
+    size_t triangle_count = 0;
+    size_t node_count = 0;
+};
+
+// 三角网格图元：顶点数据只存一份，内部自带一棵覆盖全部三角形的 N 叉 BVH。
+// 构建时按 BVH 叶子顺序重排 indices，叶子直接引用连续的三角形区间。
+// 求交只通过 mesh_view 访问数据，因此也能直接使用外部（如 mmap）的数组
+class triangle_mesh : public hittable {
+  public:
+    triangle_mesh(mesh_data data, shared_ptr<material> m,
+                  const bvh_build_options &options = default_options());
+
+    // 使用现成的数组和 BVH，不复制也不重建；owner 负责维持数组的生命周期
+    triangle_mesh(const mesh_view &view, const aabb &bounds,
+                  shared_ptr<const void> owner, shared_ptr<material> m);
+
+    // view 指向自身成员，不能复制
+    triangle_mesh(const triangle_mesh &) = delete;
+    triangle_mesh &operator=(const triangle_mesh &) = delete;
+
+    virtual bool hit(const ray &r, double t_min, double t_max,
+                     hit_record &rec) const override;
+
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override;
+
+    virtual bool bounding_box(double time0, double time1,
+                              aabb &output_box) const override {
+        output_box = bbox;
+        return arrays.node_count > 0;
+    }
+
+    const mesh_view &view() const {
+        return arrays;
+    }
+    size_t vertex_count() const {
+        return arrays.vertex_count;
+    }
+    size_t triangle_count() const {
+        return arrays.triangle_count;
+    }
+    size_t memory_bytes() const {
+        size_t floats_per_vertex =
+            3 + (arrays.normals ? 3 : 0) + (arrays.uvs ? 2 : 0);
+        return arrays.vertex_count * floats_per_vertex * sizeof(float) +
+               arrays.triangle_count * 3 * sizeof(uint32_t) +
+               arrays.node_count * sizeof(mesh_bvh_node);
+    }
+    // 数据是否来自外部内存（如内存映射的缓存）
+    bool is_mapped() const {
+        return backing != nullptr;
+    }
+
+    // 网格 BVH 的默认选项：叶子放宽到 8 个三角形，
+    // 节点内存约减半，遍历只慢几个百分点
+    static bvh_build_options &default_options() {
+        static bvh_build_options options = []() {
+            bvh_build_options o;
+            o.max_leaf_size = 8;
+            return o;
+        }();
+        return options;
+    }
+
+  public:
+    shared_ptr<material> mat_ptr;
+    double build_seconds = 0.0;
+
+  private:
+    // 水密求交 (Woop et al. 2013) 的逐光线预计算：
+    // 把光线方向最大分量所在轴换到 z，并剪切成 +z 方向
+    struct watertight_ray {
+        point3 org;
+        int kx, ky, kz;
+        double sx, sy, sz;
+    };
+
+    struct build_context {
+        explicit build_context(const bvh_build_options &options)
+            : options(options) {}
+
+        const bvh_build_options &options;
+        std::vector<aabb> boxes;
+        std::vector<point3> centroids;
+        std::vector<uint32_t> indices;
+        thread_pool *pool = nullptr; // 为空时串行构建
+        int parallel_depth = 0;
+    };
+
+    void build(const bvh_build_options &options);
+    static int build_node(build_context &ctx, size_t start, size_t end,
+                          int depth, aligned_vector<linear_bvh_node> &out);
+
+    static watertight_ray make_watertight_ray(const ray &r);
+    bool intersect_triangle(const watertight_ray &wr, uint32_t triangle,
+                            double t_min, double t_max, double &t,
+                            double *barycentric) const;
+    void fill_hit_record(const ray &r, uint32_t triangle, double t,
+                         const double *barycentric, hit_record &rec) const;
+
+    point3 position(uint32_t vertex) const {
+        const float *p = &arrays.positions[3 * vertex];
+        return point3(p[0], p[1], p[2]);
+    }
+
+    // 自有存储；使用外部数组时为空，由 backing 持有数据
+    mesh_data mesh;
+    aligned_vector<mesh_bvh_node> nodes;
+    shared_ptr<const void> backing;
+
+    mesh_view arrays;
+    aabb bbox;
+};
+
+inline triangle_mesh::triangle_mesh(mesh_data data, shared_ptr<material> m,
+                                    const bvh_build_options &options)
+    : mat_ptr(std::move(m)), mesh(std::move(data)) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    if (mesh.triangle_count() == 0) {
+        std::cerr << "triangle_mesh: mesh has no triangles.\n";
+        return;
+    }
+    // 构建时 position() 已经要通过视图读取顶点
+    arrays.positions = mesh.positions.data();
+    build(options);
+
+    arrays.normals = mesh.normals.empty() ? nullptr : mesh.normals.data();
+    arrays.uvs = mesh.uvs.empty() ? nullptr : mesh.uvs.data();
+    arrays.indices = mesh.indices.data();
+    arrays.nodes = nodes.data();
+    arrays.vertex_count = mesh.vertex_count();
+    arrays.triangle_count = mesh.triangle_count();
+    arrays.node_count = nodes.size();
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    build_seconds =
+        std::chrono::duration<double>(end_time - start_time).count();
+}
+
+inline triangle_mesh::triangle_mesh(const mesh_view &view, const aabb &bounds,
+                                    shared_ptr<const void> owner,
+                                    shared_ptr<material> m)
+    : mat_ptr(std::move(m)), backing(std::move(owner)), arrays(view),
+      bbox(bounds) {}
+
+inline void triangle_mesh::build(const bvh_build_options &options) {
+    const size_t n = mesh.triangle_count();
+    build_context ctx{options};
+    ctx.boxes.resize(n);
+    ctx.centroids.resize(n);
+    ctx.indices.resize(n);
+
+    std::unique_ptr<thread_pool> local_pool;
+    if (n > options.parallel_threshold) {
+        ctx.pool = options.pool;
+        if (!ctx.pool && options.build_threads != 1) {
+            local_pool.reset(new thread_pool(options.build_threads));
+            ctx.pool = local_pool.get();
+        }
+    }
+    int num_threads = ctx.pool ? ctx.pool->size() : 1;
+    while ((1 << ctx.parallel_depth) < num_threads) {
+        ctx.parallel_depth++;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        point3 p0 = position(mesh.indices[3 * i]);
+        point3 p1 = position(mesh.indices[3 * i + 1]);
+        point3 p2 = position(mesh.indices[3 * i + 2]);
+        point3 lo(std::min({p0.x(), p1.x(), p2.x()}),
+                  std::min({p0.y(), p1.y(), p2.y()}),
+                  std::min({p0.z(), p1.z(), p2.z()}));
+        point3 hi(std::max({p0.x(), p1.x(), p2.x()}),
+                  std::max({p0.y(), p1.y(), p2.y()}),
+                  std::max({p0.z(), p1.z(), p2.z()}));
+        ctx.boxes[i] = aabb(lo, hi);
+        ctx.centroids[i] = 0.5 * (lo + hi);
+        ctx.indices[i] = static_cast<uint32_t>(i);
+    }
+
+    aligned_vector<linear_bvh_node> binary;
+    binary.reserve(2 * n / std::max(options.max_leaf_size, 1) + 1);
+    build_node(ctx, 0, n, 0, binary);
+    bbox = binary[0].box;
+
+    // 按叶子顺序重排三角形，之后叶子的 offset 即三角形下标
+    std::vector<uint32_t> reordered(mesh.indices.size());
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t *src = &mesh.indices[3 * ctx.indices[i]];
+        reordered[3 * i] = src[0];
+        reordered[3 * i + 1] = src[1];
+        reordered[3 * i + 2] = src[2];
+    }
+    mesh.indices.swap(reordered);
+
+    collapse_wide_bvh(binary, 0, nodes);
+    nodes.shrink_to_fit();
+}
+
+inline int triangle_mesh::build_node(build_context &ctx, size_t start,
+                                     size_t end, int depth,
+                                     aligned_vector<linear_bvh_node> &out) {
+    aabb box = ctx.boxes[ctx.indices[start]];
+    const point3 &c0 = ctx.centroids[ctx.indices[start]];
+    aabb centroid_box(c0, c0);
+    for (size_t i = start + 1; i < end; ++i) {
+        const uint32_t index = ctx.indices[i];
+        box = surrounding_box(box, ctx.boxes[index]);
+        centroid_box =
+            surrounding_box(centroid_box,
+                            aabb(ctx.centroids[index], ctx.centroids[index]));
+    }
+
+    int index = static_cast<int>(out.size());
+    out.emplace_back();
+    out[index].box = box;
+    out[index].axis = 0;
+
+    // 不超过 max_leaf_size 的区间直接成为叶子，不再让 SAH 细分到单个三角形
+    size_t span = end - start;
+    size_t mid = start;
+    if (span <= static_cast<size_t>(ctx.options.max_leaf_size) ||
+        !binned_sah_partition(ctx.options, ctx.boxes, ctx.centroids,
+                              ctx.indices, start, end, box, centroid_box,
+                              mid)) {
+        out[index].offset = static_cast<int32_t>(start);
+        out[index].count = static_cast<uint16_t>(span);
+        return index;
+    }
+    out[index].count = 0;
+
+    if (ctx.pool && depth < ctx.parallel_depth &&
+        span > ctx.options.parallel_threshold) {
+        // 左右子树各自写入独立数组，完成后拼接并平移内部节点的孩子下标
+        aligned_vector<linear_bvh_node> left_nodes;
+        aligned_vector<linear_bvh_node> right_nodes;
+        task_group group(*ctx.pool);
+        group.run([&]() {
+            build_node(ctx, start, mid, depth + 1, left_nodes);
+        });
+        build_node(ctx, mid, end, depth + 1, right_nodes);
+        group.wait();
+
+        auto append = [&out](const aligned_vector<linear_bvh_node> &nodes) {
+            int32_t base = static_cast<int32_t>(out.size());
+            for (linear_bvh_node node : nodes) {
+                if (node.count == 0) {
+                    node.offset += base;
+                }
+                out.push_back(node);
+            }
+            return base;
+        };
+        append(left_nodes);
+        int32_t right_index = append(right_nodes);
+        out[index].offset = right_index;
+    } else {
+        // 递归会扩容 out，先取得下标再写回，不能跨调用持有引用
+        build_node(ctx, start, mid, depth + 1, out);
+        int32_t right_index = build_node(ctx, mid, end, depth + 1, out);
+        out[index].offset = right_index;
+    }
+    return index;
+}
+
+inline triangle_mesh::watertight_ray
+triangle_mesh::make_watertight_ray(const ray &r) {
+    watertight_ray wr;
+    vec3 d = r.direction();
+    wr.org = r.origin();
+    wr.kz = 0;
+    if (fabs(d.y()) > fabs(d[wr.kz])) {
+        wr.kz = 1;
+    }
+    if (fabs(d.z()) > fabs(d[wr.kz])) {
+        wr.kz = 2;
+    }
+    wr.kx = (wr.kz + 1) % 3;
+    wr.ky = (wr.kx + 1) % 3;
+    // 保持三角形的绕序
+    if (d[wr.kz] < 0) {
+        std::swap(wr.kx, wr.ky);
+    }
+    wr.sx = d[wr.kx] / d[wr.kz];
+    wr.sy = d[wr.ky] / d[wr.kz];
+    wr.sz = 1.0 / d[wr.kz];
+    return wr;
+}
+
+inline bool triangle_mesh::intersect_triangle(const watertight_ray &wr,
+                                              uint32_t triangle, double t_min,
+                                              double t_max, double &t,
+                                              double *barycentric) const {
+    const uint32_t *tri = &arrays.indices[3 * triangle];
+    vec3 a = position(tri[0]) - wr.org;
+    vec3 b = position(tri[1]) - wr.org;
+    vec3 c = position(tri[2]) - wr.org;
+
+    double ax = a[wr.kx] - wr.sx * a[wr.kz];
+    double ay = a[wr.ky] - wr.sy * a[wr.kz];
+    double bx = b[wr.kx] - wr.sx * b[wr.kz];
+    double by = b[wr.ky] - wr.sy * b[wr.kz];
+    double cx = c[wr.kx] - wr.sx * c[wr.kz];
+    double cy = c[wr.ky] - wr.sy * c[wr.kz];
+
+    // 边函数只依赖边的两个端点，相邻三角形在公共边上结果一致，不会漏缝
+    double u = cx * by - cy * bx;
+    double v = ax * cy - ay * cx;
+    double w = bx * ay - by * ax;
+    if ((u < 0 || v < 0 || w < 0) && (u > 0 || v > 0 || w > 0)) {
+        return false;
+    }
+    double det = u + v + w;
+    if (det == 0) {
+        return false;
+    }
+
+    double scaled_t = u * (wr.sz * a[wr.kz]) + v * (wr.sz * b[wr.kz]) +
+                      w * (wr.sz * c[wr.kz]);
+    double inv_det = 1.0 / det;
+    t = scaled_t * inv_det;
+    if (t < t_min || t > t_max) {
+        return false;
+    }
+    barycentric[0] = u * inv_det;
+    barycentric[1] = v * inv_det;
+    barycentric[2] = w * inv_det;
+    return true;
+}
+
+inline void triangle_mesh::fill_hit_record(const ray &r, uint32_t triangle,
+                                           double t,
+                                           const double *barycentric,
+                                           hit_record &rec) const {
+    const uint32_t *tri = &arrays.indices[3 * triangle];
+    point3 p0 = position(tri[0]);
+    point3 p1 = position(tri[1]);
+    point3 p2 = position(tri[2]);
+    double b0 = barycentric[0];
+    double b1 = barycentric[1];
+    double b2 = barycentric[2];
+
+    rec.t = t;
+    rec.p = b0 * p0 + b1 * p1 + b2 * p2;
+    rec.p_error =
+        error_gamma(7) * (abs(b0 * p0) + abs(b1 * p1) + abs(b2 * p2));
+    rec.set_face_normal(r, unit_vector(cross(p1 - p0, p2 - p0)));
+
+    // 有顶点法线时用插值的着色法线，翻到与几何法线同侧（不依赖绕序）
+    if (arrays.normals) {
+        vec3 shading;
+        for (int k = 0; k < 3; ++k) {
+            const float *n = &arrays.normals[3 * tri[k]];
+            shading += barycentric[k] * vec3(n[0], n[1], n[2]);
+        }
+        if (shading.length_squared() > kNearZeroThreshold) {
+            shading = unit_vector(shading);
+            rec.normal = dot(shading, rec.normal) < 0 ? -shading : shading;
+        }
+    }
+
+    if (arrays.uvs) {
+        rec.u = rec.v = 0;
+        for (int k = 0; k < 3; ++k) {
+            rec.u += barycentric[k] * arrays.uvs[2 * tri[k]];
+            rec.v += barycentric[k] * arrays.uvs[2 * tri[k] + 1];
+        }
+    } else {
+        rec.u = b1;
+        rec.v = b2;
+    }
+    rec.mat_ptr = mat_ptr.get();
+}
+
+inline bool triangle_mesh::hit(const ray &r, double t_min, double t_max,
+                               hit_record &rec) const {
+    if (arrays.node_count == 0) {
+        return false;
+    }
+
+    const watertight_ray wr = make_watertight_ray(r);
+    uint32_t closest_triangle = 0;
+    double closest_t = t_max;
+    double closest_barycentric[3];
+
+    bool hit_anything = traverse_wide_bvh(
+        arrays.nodes, r, t_min, t_max,
+        [&](int32_t first, int count, double &closest_so_far) {
+            bool hit_leaf = false;
+            double t;
+            double barycentric[3];
+            for (int i = 0; i < count; ++i) {
+                if (intersect_triangle(wr, first + i, t_min, closest_so_far, t,
+                                       barycentric)) {
+                    hit_leaf = true;
+                    closest_so_far = closest_t = t;
+                    closest_triangle = first + i;
+                    std::copy(barycentric, barycentric + 3,
+                              closest_barycentric);
+                }
+            }
+            return hit_leaf;
+        });
+
+    if (hit_anything) {
+        fill_hit_record(r, closest_triangle, closest_t, closest_barycentric,
+                        rec);
+    }
+    return hit_anything;
+}
+
+inline bool triangle_mesh::occluded(const ray &r, double t_min,
+                                    double t_max) const {
+    if (arrays.node_count == 0) {
+        return false;
+    }
+
+    const watertight_ray wr = make_watertight_ray(r);
+    return any_hit_wide_bvh(arrays.nodes, r, t_min, t_max,
+                            [&](int32_t first, int count) {
+                                double t;
+                                double barycentric[3];
+                                for (int i = 0; i < count; ++i) {
+                                    if (intersect_triangle(wr, first + i,
+                                                           t_min, t_max, t,
+                                                           barycentric)) {
+                                        return true;
+                                    }
+                                }
+                                return false;
+                            });
+}
+
+#endif
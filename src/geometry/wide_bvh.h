@@ -0,0 +1,790 @@
+#ifndef WIDE_BVH_H
+#define WIDE_BVH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#define RT_WIDE_BVH_SSE 1
+#endif
+#if defined(__AVX__)
+#define RT_WIDE_BVH_AVX 1
+#endif
+
+#include "aligned_allocator.h"
+#include "bvh.h"
+#include "hittable.h"
+#include "linear_bvh.h"
+#include "rtweekend.h"
+
+// N 叉 BVH 节点：N 个孩子的包围盒以 SoA 方式存为 float，
+// 一次 SIMD 板块测试即可求出光线与全部孩子的相交情况
+template <int N> struct alignas(32) wide_bvh_node {
+    float bounds[6][N]; // min x, min y, min z, max x, max y, max z
+    int32_t child[N];   // 内部孩子：节点下标；叶子：首个图元下标；空位：-1
+    uint16_t count[N];  // 叶子中的图元数，内部孩子和空位为 0
+};
+
+// 光线在 float 精度下的预计算数据
+struct wide_bvh_ray {
+    float org[3];
+    float inv_dir[3];
+    int near_row[3]; // 每个轴上近端平面在 bounds 中的行号
+    int far_row[3];
+};
+
+// double -> float 的保守舍入，保证包围盒只会变大
+inline float round_down_to_float(double x) {
+    float f = static_cast<float>(x);
+    return static_cast<double>(f) > x ? std::nextafter(f, -INFINITY) : f;
+}
+inline float round_up_to_float(double x) {
+    float f = static_cast<float>(x);
+    return static_cast<double>(f) < x ? std::nextafter(f, INFINITY) : f;
+}
+
+// float 板块测试的相对误差上界 (PBRT: 1 + 2 * gamma(3))
+constexpr float kWideBVHTFarScale = 1.0f + 2.0f * 3.0f * 6e-8f;
+
+template <int N>
+inline int intersect_children_scalar(const wide_bvh_node<N> &node,
+                                     const wide_bvh_ray &r, float t_min,
+                                     float t_max, float *t_near) {
+    int mask = 0;
+    for (int i = 0; i < N; ++i) {
+        float t0 = t_min;
+        float t1 = t_max;
+        for (int a = 0; a < 3; ++a) {
+            float near_t = (node.bounds[r.near_row[a]][i] - r.org[a]) *
+                           r.inv_dir[a];
+            float far_t =
+                (node.bounds[r.far_row[a]][i] - r.org[a]) * r.inv_dir[a];
+            t0 = near_t > t0 ? near_t : t0;
+            t1 = far_t * kWideBVHTFarScale < t1 ? far_t * kWideBVHTFarScale
+                                                 : t1;
+        }
+        t_near[i] = t0;
+        if (t0 <= t1) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+template <int N>
+inline int intersect_children(const wide_bvh_node<N> &node,
+                              const wide_bvh_ray &r, float t_min, float t_max,
+                              float *t_near) {
+    return intersect_children_scalar(node, r, t_min, t_max, t_near);
+}
+
+#ifdef RT_WIDE_BVH_SSE
+template <>
+inline int intersect_children<4>(const wide_bvh_node<4> &node,
+                                 const wide_bvh_ray &r, float t_min,
+                                 float t_max, float *t_near) {
+    __m128 t0 = _mm_set1_ps(t_min);
+    __m128 t1 = _mm_set1_ps(t_max);
+    const __m128 scale = _mm_set1_ps(kWideBVHTFarScale);
+    for (int a = 0; a < 3; ++a) {
+        __m128 org = _mm_set1_ps(r.org[a]);
+        __m128 inv = _mm_set1_ps(r.inv_dir[a]);
+        __m128 near_t = _mm_mul_ps(
+            _mm_sub_ps(_mm_load_ps(node.bounds[r.near_row[a]]), org), inv);
+        __m128 far_t = _mm_mul_ps(
+            _mm_sub_ps(_mm_load_ps(node.bounds[r.far_row[a]]), org), inv);
+        // NaN（0 * inf）时 max/min 返回第二个操作数，即保持原区间
+        t0 = _mm_max_ps(near_t, t0);
+        t1 = _mm_min_ps(_mm_mul_ps(far_t, scale), t1);
+    }
+    _mm_storeu_ps(t_near, t0);
+    return _mm_movemask_ps(_mm_cmple_ps(t0, t1));
+}
+#endif
+
+#ifdef RT_WIDE_BVH_AVX
+template <>
+inline int intersect_children<8>(const wide_bvh_node<8> &node,
+                                 const wide_bvh_ray &r, float t_min,
+                                 float t_max, float *t_near) {
+    __m256 t0 = _mm256_set1_ps(t_min);
+    __m256 t1 = _mm256_set1_ps(t_max);
+    const __m256 scale = _mm256_set1_ps(kWideBVHTFarScale);
+    for (int a = 0; a < 3; ++a) {
+        __m256 org = _mm256_set1_ps(r.org[a]);
+        __m256 inv = _mm256_set1_ps(r.inv_dir[a]);
+        __m256 near_t = _mm256_mul_ps(
+            _mm256_sub_ps(_mm256_load_ps(node.bounds[r.near_row[a]]), org),
+            inv);
+        __m256 far_t = _mm256_mul_ps(
+            _mm256_sub_ps(_mm256_load_ps(node.bounds[r.far_row[a]]), org),
+            inv);
+        t0 = _mm256_max_ps(near_t, t0);
+        t1 = _mm256_min_ps(_mm256_mul_ps(far_t, scale), t1);
+    }
+    _mm256_storeu_ps(t_near, t0);
+    return _mm256_movemask_ps(_mm256_cmp_ps(t0, t1, _CMP_LE_OQ));
+}
+#endif
+
+// 由 linear_bvh 格式的二叉节点数组坍缩出 N 叉节点，返回新节点下标。
+// 反复展开表面积最大的内部孩子，直到凑满 N 个孩子
+template <int N>
+inline int collapse_wide_bvh(const aligned_vector<linear_bvh_node> &src,
+                             int src_index,
+                             aligned_vector<wide_bvh_node<N>> &nodes) {
+    int children[N];
+    int num_children = 0;
+    if (src[src_index].count > 0) {
+        children[num_children++] = src_index;
+    } else {
+        children[num_children++] = src_index + 1;
+        children[num_children++] = src[src_index].offset;
+    }
+    while (num_children < N) {
+        int best = -1;
+        double best_area = -1.0;
+        for (int i = 0; i < num_children; ++i) {
+            const auto &c = src[children[i]];
+            if (c.count == 0 && c.box.surface_area() > best_area) {
+                best_area = c.box.surface_area();
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        int expanded = children[best];
+        children[best] = expanded + 1;
+        children[num_children++] = src[expanded].offset;
+    }
+
+    int index = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+
+    for (int i = 0; i < N; ++i) {
+        wide_bvh_node<N> &node = nodes[index];
+        if (i >= num_children) {
+            for (int a = 0; a < 3; ++a) {
+                node.bounds[a][i] = INFINITY;
+                node.bounds[a + 3][i] = -INFINITY;
+            }
+            node.child[i] = -1;
+            node.count[i] = 0;
+            continue;
+        }
+
+        const linear_bvh_node &c = src[children[i]];
+        for (int a = 0; a < 3; ++a) {
+            node.bounds[a][i] = round_down_to_float(c.box.min()[a]);
+            node.bounds[a + 3][i] = round_up_to_float(c.box.max()[a]);
+        }
+        if (c.count > 0) {
+            node.child[i] = c.offset;
+            node.count[i] = c.count;
+        } else {
+            // 递归会扩容 nodes，不能跨调用持有引用
+            int child_index = collapse_wide_bvh(src, children[i], nodes);
+            nodes[index].child[i] = child_index;
+            nodes[index].count[i] = 0;
+        }
+    }
+    return index;
+}
+
+inline wide_bvh_ray make_wide_bvh_ray(const ray &r) {
+    wide_bvh_ray wr;
+    const int *sign = r.direction_sign();
+    for (int a = 0; a < 3; ++a) {
+        wr.org[a] = static_cast<float>(r.origin()[a]);
+        wr.inv_dir[a] = static_cast<float>(r.inv_direction()[a]);
+        wr.near_row[a] = sign[a] ? a + 3 : a;
+        wr.far_row[a] = sign[a] ? a : a + 3;
+    }
+    return wr;
+}
+
+// 遍历栈：先用 kWideBVHLocalStackSize 项的局部数组，压栈前检查容量，
+// 满了再转到堆上并按倍数扩容。每访问一个内部节点净增至多 N - 1 项，
+// 退化的深树 (或来自缓存文件的树) 也不会越界
+constexpr int kWideBVHLocalStackSize = 256;
+
+template <typename T> class wide_bvh_stack {
+  public:
+    wide_bvh_stack() = default;
+    wide_bvh_stack(const wide_bvh_stack &) = delete;
+    wide_bvh_stack &operator=(const wide_bvh_stack &) = delete;
+
+    void push(const T &entry) {
+        if (m_size == m_capacity) {
+            grow();
+        }
+        m_data[m_size++] = entry;
+    }
+    T pop() {
+        return m_data[--m_size];
+    }
+    bool empty() const {
+        return m_size == 0;
+    }
+
+  private:
+    void grow() {
+        std::vector<T> larger(2 * static_cast<size_t>(m_capacity));
+        std::copy(m_data, m_data + m_size, larger.begin());
+        m_heap.swap(larger);
+        m_data = m_heap.data();
+        m_capacity *= 2;
+    }
+
+    T m_local[kWideBVHLocalStackSize];
+    std::vector<T> m_heap;
+    T *m_data = m_local;
+    int m_size = 0;
+    int m_capacity = kWideBVHLocalStackSize;
+};
+
+// 最近交点遍历。intersect_leaf(first, count, closest) 测试叶子中的图元，
+// 命中更近的交点时更新 closest 并返回 true
+template <int N, typename LeafFn>
+inline bool traverse_wide_bvh(const wide_bvh_node<N> *nodes, const ray &r,
+                              double t_min, double t_max,
+                              LeafFn &&intersect_leaf, int root = 0) {
+    struct stack_entry {
+        int32_t child;
+        uint16_t count;
+        float t_near;
+    };
+
+    const wide_bvh_ray wr = make_wide_bvh_ray(r);
+    const float t_min_f = round_down_to_float(t_min);
+
+    wide_bvh_stack<stack_entry> stack;
+    stack.push({root, 0, t_min_f});
+
+    bool hit_anything = false;
+    double closest_so_far = t_max;
+
+    while (!stack.empty()) {
+        stack_entry entry = stack.pop();
+        if (entry.t_near > closest_so_far) {
+            continue;
+        }
+
+        if (entry.count > 0) {
+            if (intersect_leaf(entry.child, entry.count, closest_so_far)) {
+                hit_anything = true;
+            }
+            continue;
+        }
+
+        const wide_bvh_node<N> &node = nodes[entry.child];
+        float t_near[N];
+        int mask = intersect_children(node, wr, t_min_f,
+                                      round_up_to_float(closest_so_far),
+                                      t_near);
+        if (mask == 0) {
+            continue;
+        }
+
+        // 按进入距离从远到近压栈，使最近的孩子最先出栈
+        int order[N];
+        int num_hit = 0;
+        for (int i = 0; i < N; ++i) {
+            if (mask & (1 << i)) {
+                int j = num_hit++;
+                while (j > 0 && t_near[order[j - 1]] < t_near[i]) {
+                    order[j] = order[j - 1];
+                    --j;
+                }
+                order[j] = i;
+            }
+        }
+        for (int k = 0; k < num_hit; ++k) {
+            int i = order[k];
+            stack.push({node.child[i], node.count[i], t_near[i]});
+        }
+    }
+    return hit_anything;
+}
+
+// 任意交点遍历：孩子不排序，occlude_leaf(first, count) 返回 true 即结束。
+// root 为开始遍历的节点，光线包发散后从当前节点改用单条光线遍历
+template <int N, typename LeafFn>
+inline bool any_hit_wide_bvh(const wide_bvh_node<N> *nodes, const ray &r,
+                             double t_min, double t_max,
+                             LeafFn &&occlude_leaf, int root = 0) {
+    const wide_bvh_ray wr = make_wide_bvh_ray(r);
+    const float t_min_f = round_down_to_float(t_min);
+    const float t_max_f = round_up_to_float(t_max);
+
+    wide_bvh_stack<int32_t> stack;
+    stack.push(root);
+
+    while (!stack.empty()) {
+        const wide_bvh_node<N> &node = nodes[stack.pop()];
+        float t_near[N];
+        int mask = intersect_children(node, wr, t_min_f, t_max_f, t_near);
+        for (int i = 0; i < N; ++i) {
+            if (!(mask & (1 << i))) {
+                continue;
+            }
+            if (node.count[i] == 0) {
+                stack.push(node.child[i]);
+            } else if (occlude_leaf(node.child[i], node.count[i])) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// 光线包中活动光线少于 1 / kRayPacketFallbackDivisor 时改用单条光线遍历
+constexpr int kRayPacketFallbackDivisor = 4;
+
+// 光线包的区间数据：包内光线的方向符号一致时，记录起点和 1/方向
+// 在各轴上的取值范围，用于一次排除整个包都不会击中的孩子
+struct wide_bvh_packet_interval {
+    bool valid;
+    float org_lo[3], org_hi[3];
+    float inv_lo[3], inv_hi[3];
+    int near_row[3];
+    int far_row[3];
+};
+
+inline wide_bvh_packet_interval
+make_wide_bvh_packet_interval(const wide_bvh_ray *rays, int count) {
+    wide_bvh_packet_interval iv;
+    iv.valid = true;
+    for (int a = 0; a < 3; ++a) {
+        iv.near_row[a] = rays[0].near_row[a];
+        iv.far_row[a] = rays[0].far_row[a];
+        iv.org_lo[a] = iv.org_hi[a] = rays[0].org[a];
+        iv.inv_lo[a] = iv.inv_hi[a] = rays[0].inv_dir[a];
+        for (int i = 0; i < count; ++i) {
+            const wide_bvh_ray &r = rays[i];
+            iv.valid = iv.valid && r.near_row[a] == iv.near_row[a] &&
+                       std::isfinite(r.inv_dir[a]);
+            iv.org_lo[a] = std::min(iv.org_lo[a], r.org[a]);
+            iv.org_hi[a] = std::max(iv.org_hi[a], r.org[a]);
+            iv.inv_lo[a] = std::min(iv.inv_lo[a], r.inv_dir[a]);
+            iv.inv_hi[a] = std::max(iv.inv_hi[a], r.inv_dir[a]);
+        }
+    }
+    return iv;
+}
+
+// 区间算术的板块测试：进入距离取四个端点乘积的最小值，离开距离取最大值，
+// 得到包内任意光线进入 / 离开距离的保守界。返回可能被某条光线击中的孩子
+template <int N>
+inline int intersect_children_interval(const wide_bvh_node<N> &node,
+                                       const wide_bvh_packet_interval &iv,
+                                       float t_min, float t_max) {
+    int mask = 0;
+    for (int i = 0; i < N; ++i) {
+        float t0 = t_min;
+        float t1 = t_max;
+        for (int a = 0; a < 3; ++a) {
+            float near_b = node.bounds[iv.near_row[a]][i];
+            float far_b = node.bounds[iv.far_row[a]][i];
+            float n_lo = near_b - iv.org_hi[a];
+            float n_hi = near_b - iv.org_lo[a];
+            float f_lo = far_b - iv.org_hi[a];
+            float f_hi = far_b - iv.org_lo[a];
+            float near_t =
+                std::min(std::min(n_lo * iv.inv_lo[a], n_lo * iv.inv_hi[a]),
+                         std::min(n_hi * iv.inv_lo[a], n_hi * iv.inv_hi[a]));
+            float far_t =
+                std::max(std::max(f_lo * iv.inv_lo[a], f_lo * iv.inv_hi[a]),
+                         std::max(f_hi * iv.inv_lo[a], f_hi * iv.inv_hi[a]));
+            t0 = near_t > t0 ? near_t : t0;
+            t1 = far_t * kWideBVHTFarScale < t1 ? far_t * kWideBVHTFarScale
+                                                 : t1;
+        }
+        if (t0 <= t1) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+inline int lowest_lane(int mask) {
+    int lane = 0;
+    while (!(mask & (1 << lane))) {
+        ++lane;
+    }
+    return lane;
+}
+
+// 由二叉 BVH 坍缩得到的 N 叉 BVH (N = 4 对应 SSE，N = 8 对应 AVX)
+template <int N> class wide_bvh : public hittable {
+    static_assert(N >= 2 && N <= 8, "wide_bvh supports 2 to 8 children");
+
+  public:
+    wide_bvh(const bvh_node &root, double time0, double time1)
+        : wide_bvh(linear_bvh(root, time0, time1)) {
+    }
+
+    explicit wide_bvh(const linear_bvh &source);
+
+    virtual bool hit(const ray &r, double t_min, double t_max,
+                     hit_record &rec) const override;
+
+    virtual bool occluded(const ray &r, double t_min,
+                          double t_max) const override;
+
+    // 光线包共用一个遍历栈，每个栈项带有仍需访问该节点的光线掩码；
+    // 方向符号一致的包先用区间测试排除整个包都不会击中的孩子，
+    // 活动光线过少时其余光线从当前节点开始单独遍历
+    virtual void hit_packet(const ray *rays, int count, double t_min,
+                            const double *t_max, hit_record *recs, bool *hits,
+                            random_stream *streams,
+                            ray_packet_stats *stats) const override;
+
+    virtual void occluded_packet(const ray *rays, int count, double t_min,
+                                 const double *t_max, bool *occluded_rays,
+                                 random_stream *streams,
+                                 ray_packet_stats *stats) const override;
+
+    virtual bool bounding_box(double time0, double time1,
+                              aabb &output_box) const override {
+        output_box = bbox;
+        return true;
+    }
+
+    size_t node_count() const {
+        return nodes.size();
+    }
+
+  private:
+    aligned_vector<wide_bvh_node<N>> nodes;
+    std::vector<const hittable *> primitives;
+    std::vector<shared_ptr<hittable>> owned;
+    aabb bbox;
+};
+
+template <int N> inline wide_bvh<N>::wide_bvh(const linear_bvh &source) {
+    owned = source.primitive_array();
+    primitives.reserve(owned.size());
+    for (const auto &p : owned) {
+        primitives.push_back(p.get());
+    }
+    bbox = source.node_array()[0].box;
+    collapse_wide_bvh(source.node_array(), 0, nodes);
+}
+
+template <int N>
+inline bool wide_bvh<N>::hit(const ray &r, double t_min, double t_max,
+                             hit_record &rec) const {
+    return traverse_wide_bvh(
+        nodes.data(), r, t_min, t_max,
+        [&](int32_t first, int count, double &closest_so_far) {
+            bool hit_leaf = false;
+            for (int i = 0; i < count; ++i) {
+                if (primitives[first + i]->hit(r, t_min, closest_so_far,
+                                               rec)) {
+                    hit_leaf = true;
+                    closest_so_far = rec.t;
+                }
+            }
+            return hit_leaf;
+        });
+}
+
+template <int N>
+inline bool wide_bvh<N>::occluded(const ray &r, double t_min,
+                                  double t_max) const {
+    return any_hit_wide_bvh(nodes.data(), r, t_min, t_max,
+                            [&](int32_t first, int count) {
+                                for (int i = 0; i < count; ++i) {
+                                    if (primitives[first + i]->occluded(
+                                            r, t_min, t_max)) {
+                                        return true;
+                                    }
+                                }
+                                return false;
+                            });
+}
+
+template <int N>
+inline void wide_bvh<N>::hit_packet(const ray *rays, int count, double t_min,
+                                    const double *t_max, hit_record *recs,
+                                    bool *hits, random_stream *streams,
+                                    ray_packet_stats *stats) const {
+    struct packet_entry {
+        int32_t child;
+        uint16_t count;
+        uint16_t lanes;
+        float t_near; // 包内光线进入该节点的最小距离
+    };
+
+    wide_bvh_ray wr[kMaxRayPacketSize];
+    double closest[kMaxRayPacketSize];
+    for (int i = 0; i < count; ++i) {
+        wr[i] = make_wide_bvh_ray(rays[i]);
+        closest[i] = t_max[i];
+        hits[i] = false;
+    }
+    const wide_bvh_packet_interval iv =
+        make_wide_bvh_packet_interval(wr, count);
+    const float t_min_f = round_down_to_float(t_min);
+
+    // 测试第 lane 条光线与叶子中的图元
+    auto intersect_leaf = [&](int lane, int32_t first, int leaf_count,
+                              double &closest_so_far) {
+        random_stream_scope scope(streams ? &streams[lane] : nullptr);
+        bool hit_leaf = false;
+        for (int i = 0; i < leaf_count; ++i) {
+            if (primitives[first + i]->hit(rays[lane], t_min, closest_so_far,
+                                           recs[lane])) {
+                hit_leaf = true;
+                closest_so_far = recs[lane].t;
+            }
+        }
+        return hit_leaf;
+    };
+
+    wide_bvh_stack<packet_entry> stack;
+    stack.push({0, 0, static_cast<uint16_t>((1 << count) - 1), t_min_f});
+
+    while (!stack.empty()) {
+        packet_entry entry = stack.pop();
+        // 已经找到更近交点的光线不再访问这个节点
+        int lanes = 0;
+        for (int m = entry.lanes; m; m &= m - 1) {
+            int lane = lowest_lane(m);
+            if (entry.t_near <= closest[lane]) {
+                lanes |= 1 << lane;
+            }
+        }
+        if (lanes == 0) {
+            continue;
+        }
+
+        if (entry.count > 0) {
+            for (int m = lanes; m; m &= m - 1) {
+                int lane = lowest_lane(m);
+                if (intersect_leaf(lane, entry.child, entry.count,
+                                   closest[lane])) {
+                    hits[lane] = true;
+                }
+            }
+            continue;
+        }
+
+        int active = 0;
+        for (int m = lanes; m; m &= m - 1) {
+            ++active;
+        }
+        if (stats) {
+            ++stats->node_visits;
+            stats->active_lanes += active;
+            stats->lane_slots += count;
+        }
+        if (active * kRayPacketFallbackDivisor < count) {
+            for (int m = lanes; m; m &= m - 1) {
+                int lane = lowest_lane(m);
+                if (stats) {
+                    ++stats->fallback_rays;
+                }
+                bool hit = traverse_wide_bvh(
+                    nodes.data(), rays[lane], t_min, closest[lane],
+                    [&](int32_t first, int leaf_count, double &closest_so_far) {
+                        return intersect_leaf(lane, first, leaf_count,
+                                              closest_so_far);
+                    },
+                    entry.child);
+                if (hit) {
+                    hits[lane] = true;
+                    closest[lane] = recs[lane].t;
+                }
+            }
+            continue;
+        }
+
+        const wide_bvh_node<N> &node = nodes[entry.child];
+        int candidates = (1 << N) - 1;
+        if (iv.valid) {
+            double packet_t_max = 0.0;
+            for (int m = lanes; m; m &= m - 1) {
+                packet_t_max = std::max(packet_t_max, closest[lowest_lane(m)]);
+            }
+            candidates = intersect_children_interval(
+                node, iv, t_min_f, round_up_to_float(packet_t_max));
+            if (candidates == 0) {
+                continue;
+            }
+        }
+
+        int child_lanes[N] = {};
+        float child_t[N];
+        for (int i = 0; i < N; ++i) {
+            child_t[i] = INFINITY;
+        }
+        for (int m = lanes; m; m &= m - 1) {
+            int lane = lowest_lane(m);
+            float t_near[N];
+            int mask = intersect_children(node, wr[lane], t_min_f,
+                                          round_up_to_float(closest[lane]),
+                                          t_near) &
+                       candidates;
+            for (int i = 0; i < N; ++i) {
+                if (mask & (1 << i)) {
+                    child_lanes[i] |= 1 << lane;
+                    child_t[i] = std::min(child_t[i], t_near[i]);
+                }
+            }
+        }
+
+        // 按最小进入距离从远到近压栈
+        int order[N];
+        int num_hit = 0;
+        for (int i = 0; i < N; ++i) {
+            if (child_lanes[i]) {
+                int j = num_hit++;
+                while (j > 0 && child_t[order[j - 1]] < child_t[i]) {
+                    order[j] = order[j - 1];
+                    --j;
+                }
+                order[j] = i;
+            }
+        }
+        for (int k = 0; k < num_hit; ++k) {
+            int i = order[k];
+            stack.push({node.child[i], node.count[i],
+                        static_cast<uint16_t>(child_lanes[i]), child_t[i]});
+        }
+    }
+}
+
+template <int N>
+inline void wide_bvh<N>::occluded_packet(const ray *rays, int count,
+                                         double t_min, const double *t_max,
+                                         bool *occluded_rays,
+                                         random_stream *streams,
+                                         ray_packet_stats *stats) const {
+    struct packet_entry {
+        int32_t node;
+        uint16_t lanes;
+    };
+
+    wide_bvh_ray wr[kMaxRayPacketSize];
+    for (int i = 0; i < count; ++i) {
+        wr[i] = make_wide_bvh_ray(rays[i]);
+        occluded_rays[i] = false;
+    }
+    const wide_bvh_packet_interval iv =
+        make_wide_bvh_packet_interval(wr, count);
+    const float t_min_f = round_down_to_float(t_min);
+
+    auto occlude_leaf = [&](int lane, int32_t first, int leaf_count) {
+        random_stream_scope scope(streams ? &streams[lane] : nullptr);
+        for (int i = 0; i < leaf_count; ++i) {
+            if (primitives[first + i]->occluded(rays[lane], t_min,
+                                                t_max[lane])) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // 尚未确认被遮挡的光线
+    int remaining = (1 << count) - 1;
+    wide_bvh_stack<packet_entry> stack;
+    stack.push({0, static_cast<uint16_t>(remaining)});
+
+    while (!stack.empty() && remaining) {
+        packet_entry entry = stack.pop();
+        int lanes = entry.lanes & remaining;
+        if (lanes == 0) {
+            continue;
+        }
+
+        int active = 0;
+        for (int m = lanes; m; m &= m - 1) {
+            ++active;
+        }
+        if (stats) {
+            ++stats->node_visits;
+            stats->active_lanes += active;
+            stats->lane_slots += count;
+        }
+        if (active * kRayPacketFallbackDivisor < count) {
+            for (int m = lanes; m; m &= m - 1) {
+                int lane = lowest_lane(m);
+                if (stats) {
+                    ++stats->fallback_rays;
+                }
+                if (any_hit_wide_bvh(
+                        nodes.data(), rays[lane], t_min, t_max[lane],
+                        [&](int32_t first, int leaf_count) {
+                            return occlude_leaf(lane, first, leaf_count);
+                        },
+                        entry.node)) {
+                    occluded_rays[lane] = true;
+                    remaining &= ~(1 << lane);
+                }
+            }
+            continue;
+        }
+
+        const wide_bvh_node<N> &node = nodes[entry.node];
+        int candidates = (1 << N) - 1;
+        if (iv.valid) {
+            double packet_t_max = 0.0;
+            for (int m = lanes; m; m &= m - 1) {
+                packet_t_max = std::max(packet_t_max, t_max[lowest_lane(m)]);
+            }
+            candidates = intersect_children_interval(
+                node, iv, t_min_f, round_up_to_float(packet_t_max));
+            if (candidates == 0) {
+                continue;
+            }
+        }
+
+        int child_lanes[N] = {};
+        for (int m = lanes; m; m &= m - 1) {
+            int lane = lowest_lane(m);
+            float t_near[N];
+            int mask = intersect_children(node, wr[lane], t_min_f,
+                                          round_up_to_float(t_max[lane]),
+                                          t_near) &
+                       candidates;
+            for (int i = 0; i < N; ++i) {
+                if (mask & (1 << i)) {
+                    child_lanes[i] |= 1 << lane;
+                }
+            }
+        }
+
+        for (int i = 0; i < N; ++i) {
+            if (!child_lanes[i]) {
+                continue;
+            }
+            if (node.count[i] == 0) {
+                stack.push(
+                    {node.child[i], static_cast<uint16_t>(child_lanes[i])});
+                continue;
+            }
+            for (int m = child_lanes[i] & remaining; m; m &= m - 1) {
+                int lane = lowest_lane(m);
+                if (occlude_leaf(lane, node.child[i], node.count[i])) {
+                    occluded_rays[lane] = true;
+                    remaining &= ~(1 << lane);
+                }
+            }
+        }
+    }
+}
+
+#if defined(RT_WIDE_BVH_AVX)
+constexpr int kDefaultWideBVHWidth = 8;
+#else
+constexpr int kDefaultWideBVHWidth = 4;
+#endif
+using default_wide_bvh = wide_bvh<kDefaultWideBVHWidth>;
+
+#endif
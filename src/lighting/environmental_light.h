@@ -185,7 +185,7 @@ class EnvironmentLight : public Light {
         s.is_delta = false;
 
         if (width == 0 || height == 0) {
-            s.wi = random_unit_vector();
+            s.wi = sample_sphere_direction(u);
             s.pdf = 1.0 / (4.0 * pi);
             s.Li = color(1, 1, 1);
             return s;
@@ -20,6 +20,8 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.*/
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
@@ -29,54 +31,160 @@ THE SOFTWARE.*/
 #include <sys/types.h>
 #include <thread>
 
+#ifndef RT_HEADLESS
 #include "WindowsApp.h"
+#endif
+#include "bvh.h"
+#include "denoiser.h"
 #include "direct_light_integrator.h"
 #include "mis_path_integrator.h"
 #include "path_integrator.h"
 #include "pbr_path_integrator.h"
 #include "render_buffer.h"
+#include "render_options.h"
 #include "renderer.h"
 #include "rr_path_integrator.h"
+#include "sampler.h"
+#include "scene_arena.h"
 #include "scenes.h"
+#include "triangle_mesh.h"
+#include "wavefront_integrator.h"
+#include "wide_bvh.h"
 
 namespace RenderConfig {
-constexpr int kMaxDepth = 50;
-constexpr double kTMin = 0.001;
 constexpr double kShutterOpen = 0.0;
 constexpr double kShutterClose = 1.0;
+// 窗口模式下渐进渲染，每遍每像素的样本数
+constexpr int kSamplesPerPass = 1;
+// 自适应采样 (--adaptive)：相对误差阈值和每像素最少样本数
+constexpr double kAdaptiveThreshold = 0.02;
+constexpr int kAdaptiveMinSamples = 16;
 } // namespace RenderConfig
 
 int main(int argc, char *args[]) {
 
-    int scene_id = 23;
-    int integrator_id = 4; // 0: Path, 1: RR, 2: PBR, 3: NEE, 4: MIS
+    RenderOptions options;
+    if (!parse_render_options(argc, args, options)) {
+        print_render_usage(args[0]);
+        return 1;
+    }
+    if (options.show_help) {
+        print_render_usage(args[0]);
+        return 0;
+    }
+#ifdef RT_HEADLESS
+    // 不链接 SDL 的版本只能无窗口渲染
+    options.headless = true;
+#endif
+    const int scene_id = options.scene_id;
+    const int integrator_id = options.integrator_id;
+
+    // 场景对象分配在 arena 的连续内存块中，场景句柄不持有所有权，
+    // 所以 arena 要在渲染器和场景之前声明、在它们之后析构
+    scene_arena arena;
 
-    if (argc > 1) {
-        scene_id = std::atoi(args[1]);
+    // 渲染器的常驻线程池同时用于 BVH 构建和图像输出
+    Renderer renderer(options.num_threads, options.pin_threads);
+    bvh_node::default_options().pool = &renderer.pool();
+    triangle_mesh::default_options().pool = &renderer.pool();
+
+    switch (options.bvh_builder_id) {
+    case 1:
+        bvh_node::default_options().split = bvh_split_method::random_axis;
+        break;
+    case 2:
+        bvh_node::default_options().split = bvh_split_method::lbvh;
+        break;
+    case 3:
+        bvh_node::default_options().split = bvh_split_method::hybrid;
+        break;
+    default:
+        bvh_node::default_options().split = bvh_split_method::sah;
+        break;
     }
-    if (argc > 2) {
-        integrator_id = std::atoi(args[2]);
+
+    auto scene_start = std::chrono::high_resolution_clock::now();
+    SceneConfig config;
+    {
+        scene_arena_scope arena_scope(&arena);
+        config = select_scene(scene_id);
+
+        if (auto bvh = std::dynamic_pointer_cast<bvh_node>(config.world)) {
+            std::cout << bvh->stats() << std::endl;
+            std::cout << "Top-level BVH built in " << bvh->build_seconds
+                      << " seconds." << std::endl;
+            config.world = make_pooled<default_wide_bvh>(
+                *bvh, RenderConfig::kShutterOpen, RenderConfig::kShutterClose);
+        }
     }
+    std::chrono::duration<double> scene_elapsed =
+        std::chrono::high_resolution_clock::now() - scene_start;
+    std::cout << "Scene and acceleration structures built in "
+              << scene_elapsed.count() << " seconds." << std::endl;
+    arena.print_report(std::cout);
 
-    SceneConfig config = select_scene(scene_id);
+    // 命令行给出的分辨率优先；只给一边时按场景宽高比推出另一边
+    int width = config.image_width;
+    int height = static_cast<int>(width / config.aspect_ratio);
+    if (options.width > 0) {
+        width = options.width;
+        height = options.height > 0
+                     ? options.height
+                     : static_cast<int>(width / config.aspect_ratio);
+    } else if (options.height > 0) {
+        height = options.height;
+        width = static_cast<int>(height * config.aspect_ratio);
+    }
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    const int samples_per_pixel = options.samples_per_pixel > 0
+                                      ? options.samples_per_pixel
+                                      : config.samples_per_pixel;
 
     auto cam = make_shared<camera>(
         config.lookfrom, config.lookat, config.vup, config.vfov,
-        config.aspect_ratio, config.aperture, config.focus_dist,
-        RenderConfig::kShutterOpen, RenderConfig::kShutterClose);
+        static_cast<double>(width) / height, config.aperture,
+        config.focus_dist, RenderConfig::kShutterOpen,
+        RenderConfig::kShutterClose);
 
-    int width = config.image_width;
-    int height = static_cast<int>(width / config.aspect_ratio);
     auto render_buffer = make_shared<RenderBuffer>(width, height);
+    // --aovs 时在 EXR 中附带全部 AOV (反照率、法线、深度、材质编号、
+    // 光照拆分、样本统计)；未启用的 AOV 不记录特征，渲染不受影响
+    if (options.aovs) {
+        for (int a = 0; a < kAovCount; ++a) {
+            render_buffer->enable_aov(static_cast<Aov>(a));
+        }
+    }
+    // --denoise 时渲染结束后用 à-trous 滤波额外输出一张降噪结果，
+    // 只在这时才记录它需要的引导 AOV
+    if (options.denoise) {
+        for (Aov aov : {Aov::albedo, Aov::normal, Aov::depth, Aov::variance,
+                        Aov::sample_count}) {
+            render_buffer->enable_aov(aov);
+        }
+    }
 
     auto integrator = make_shared<PathIntegrator>();
     auto rrIntegrator = make_shared<RRPathInterator>();
     auto pbrIntegrator = make_shared<PBRPathIntegrator>();
     auto dirlightIntegrator = make_shared<DirectLightIntegrator>();
     auto misIntegrator = make_shared<MISPathIntegrator>();
+    auto wavefrontIntegrator = make_shared<WavefrontPathIntegrator>();
+    wavefrontIntegrator->set_sorting(options.sort_rays, options.sort_rays);
+    wavefrontIntegrator->set_packet_size(options.packet_size);
 
-    Renderer renderer;
-    renderer.set_samples(config.samples_per_pixel);
+    renderer.set_samples(samples_per_pixel);
+    renderer.set_seed(options.seed);
+    renderer.set_sampler(
+        make_sampler(options.sampler, samples_per_pixel, options.seed));
+    // 无窗口时不需要中间结果，整帧一遍渲染完；只有 --adaptive 和
+    // 时间预算 / 噪声目标需要按遍进行
+    renderer.set_progressive(!options.headless,
+                             RenderConfig::kSamplesPerPass);
+    renderer.set_adaptive(options.adaptive,
+                          RenderConfig::kAdaptiveThreshold,
+                          RenderConfig::kAdaptiveMinSamples);
+    renderer.set_time_budget(options.time_budget, options.noise_target);
 
     switch (integrator_id) {
     case 0:
@@ -94,61 +202,141 @@ int main(int argc, char *args[]) {
     case 4:
         renderer.set_integrator(misIntegrator);
         break;
+    case 5:
+        renderer.set_integrator(wavefrontIntegrator);
+        break;
     default:
         renderer.set_integrator(misIntegrator);
         break;
     }
 
-    renderer.set_max_depth(50);
+    renderer.set_max_depth(options.max_depth);
 
-    // Create window app handle
-    WindowsApp::ptr winApp =
-        WindowsApp::getInstance(width, height, "CGAssignment4: Ray Tracing");
-    if (winApp == nullptr) {
-        std::cerr << "Error: failed to create a window handler" << std::endl;
-        return -1;
-    }
+    if (options.headless) {
+        renderer.render(config.world, cam, config.background, *render_buffer,
+                        config.lights);
+    } else {
+#ifndef RT_HEADLESS
+        // Create window app handle
+        WindowsApp::ptr winApp = WindowsApp::getInstance(
+            width, height, "CGAssignment4: Ray Tracing");
+        if (winApp == nullptr) {
+            std::cerr << "Error: failed to create a window handler"
+                      << std::endl;
+            return -1;
+        }
 
-    std::thread renderingThread([&renderer, world = config.world, cam,
-                                 render_buffer, bg = config.background,
-                                 lights = config.lights]() {
-        renderer.render(world, cam, bg, *render_buffer, lights);
-    });
+        // 只在一遍渲染完成后刷新窗口，不再每帧复制整张图
+        std::atomic<bool> frame_ready(true);
+        renderer.set_pass_callback(
+            [&frame_ready](int) { frame_ready = true; });
 
-    // Window app loop
-    while (!winApp->shouldWindowClose()) {
-        // Process event
-        winApp->processEvent();
+        std::thread renderingThread([&renderer, world = config.world, cam,
+                                     render_buffer, bg = config.background,
+                                     lights = config.lights]() {
+            renderer.render(world, cam, bg, *render_buffer, lights);
+        });
 
-        // Display to the screen
-        winApp->updateScreenSurface(render_buffer->get_data());
-        std::this_thread::sleep_for(std::chrono::milliseconds(33));
-    }
+        // Window app loop
+        while (!winApp->shouldWindowClose()) {
+            // Process event
+            winApp->processEvent();
 
-    renderer.cancel();
+            // Display to the screen
+            if (frame_ready.exchange(false)) {
+                winApp->updateScreenSurface(render_buffer->view());
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(33));
+        }
 
-    if (renderingThread.joinable()) {
-        renderingThread.join();
-    }
+        renderer.cancel();
 
-    // 创建 output 文件夹（如果不存在）
-    mkdir("output", 0755);
+        if (renderingThread.joinable()) {
+            renderingThread.join();
+        }
+        renderer.set_pass_callback(nullptr);
+#endif
+    }
+    if (integrator_id == 5) {
+        wavefrontIntegrator->print_stats(std::cout);
+    }
 
-    // 生成带编号的文件名
-    auto now = std::chrono::system_clock::now();
-    auto timestamp = std::chrono::system_clock::to_time_t(now);
-    std::stringstream filename;
-    filename << "output/scene" << std::setfill('0') << std::setw(2) << scene_id
-             << "_integrator" << integrator_id << "_" << timestamp << ".png";
+    // 输出文件名：--output 给出时去掉其格式扩展名作为前缀，
+    // 否则在 output 文件夹中生成带编号的文件名
+    std::string base_name = options.output;
+    if (base_name.empty()) {
+        mkdir("output", 0755);
+        auto now = std::chrono::system_clock::now();
+        auto timestamp = std::chrono::system_clock::to_time_t(now);
+        std::stringstream filename;
+        filename << "output/scene" << std::setfill('0') << std::setw(2)
+                 << scene_id << "_integrator" << integrator_id << "_"
+                 << timestamp;
+        base_name = filename.str();
+    } else if (is_render_output_format(
+                   render_output_extension(base_name))) {
+        base_name.erase(base_name.find_last_of('.'));
+    }
 
-    // 保存渲染结果到图片
+    // PNG / JPG 为色调映射后的结果；PFM / EXR 保存线性 HDR 结果
+    // (EXR 含 AOV)，便于之后重新色调映射、合成和降噪
     std::cout << "Saving rendered image..." << std::endl;
-    std::string output_file = filename.str();
-    if (render_buffer->save_to_png(output_file)) {
-        std::cout << "Image saved successfully to " << output_file << std::endl;
-    } else {
-        std::cerr << "Failed to save image to " << output_file << std::endl;
+    bool saved_all = true;
+    for (const std::string &format : options.formats) {
+        std::string output_file = base_name + "." + format;
+        bool saved = false;
+        if (format == "png") {
+            saved = render_buffer->save_to_png(output_file, &renderer.pool());
+        } else if (format == "jpg") {
+            saved = render_buffer->save_to_jpg(output_file, 90,
+                                               &renderer.pool());
+        } else if (format == "pfm") {
+            saved = render_buffer->save_to_pfm(output_file);
+        } else if (format == "exr") {
+            saved = render_buffer->save_to_exr(
+                output_file, ExrCompression::zip, &renderer.pool());
+        }
+        if (saved) {
+            std::cout << "Image saved successfully to " << output_file
+                      << std::endl;
+        } else {
+            std::cerr << "Failed to save image to " << output_file
+                      << std::endl;
+            saved_all = false;
+        }
+    }
+
+    // 降噪结果单独保存，原始渲染结果保持不变
+    if (options.denoise) {
+        RenderBuffer denoised(width, height);
+        Denoiser denoiser;
+        Denoiser::Stats stats =
+            denoiser.denoise(*render_buffer, denoised, &renderer.pool());
+        std::cout << "Denoising finished in " << stats.seconds
+                  << " seconds." << std::endl;
+        std::string denoised_file = base_name + "_denoised.png";
+        if (denoised.save_to_png(denoised_file, &renderer.pool())) {
+            std::cout << "Denoised image saved to " << denoised_file
+                      << std::endl;
+        } else {
+            std::cerr << "Failed to save denoised image to " << denoised_file
+                      << std::endl;
+        }
+    }
+
+    // 自适应采样的逐像素样本数热力图
+    if (options.adaptive) {
+        RenderBuffer heatmap(width, height);
+        renderer.write_sample_heatmap(heatmap);
+        std::string heatmap_file = base_name + "_samples.png";
+        if (heatmap.save_to_png(heatmap_file, &renderer.pool())) {
+            std::cout << "Sample heatmap saved to " << heatmap_file
+                      << std::endl;
+        } else {
+            std::cerr << "Failed to save sample heatmap to " << heatmap_file
+                      << std::endl;
+        }
     }
 
-    return 0;
+    return saved_all ? 0 : 1;
 }
\ No newline at end of file
@@ -5,8 +5,11 @@
 #include "onb.h"
 #include "ray.h"
 #include "rtweekend.h"
+#include "scene_arena.h"
 #include "texture.h"
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 
 struct hit_record;
 
@@ -21,8 +24,20 @@ struct BSDFSample {
 
 class material {
   public:
+    material() : m_id(next_id()) {
+    }
     virtual ~material() = default;
 
+    // 进程内唯一的材质编号，从 1 开始，0 留给未命中任何物体的像素
+    uint32_t id() const {
+        return m_id;
+    }
+
+    // 命中点的反照率，用于 AOV 和降噪的引导特征；没有明确底色的材质返回白色
+    virtual color base_color(const hit_record &rec) const {
+        return color(1, 1, 1);
+    }
+
     // 原emitted函数（保留旧接口）
     virtual color emitted(double u, double v, const point3 &p) const {
         return color(0, 0, 0);
@@ -38,12 +53,28 @@ class material {
         return false;
     }
 
-    // 采样 BSDF 生成入射方向 (Importance Sampling)
-    virtual bool sample(const hit_record &rec, const vec3 &wo,
-                        BSDFSample &sampled) const {
+    // 采样 BSDF 生成入射方向 (Importance Sampling)。
+    // u 为采样方向用的二维样本，u_lobe 用于选择反射 / 折射等分支，
+    // 均由调用方的 Sampler 提供
+    virtual bool sample(const hit_record &rec, const vec3 &wo, const vec2 &u,
+                        double u_lobe, BSDFSample &sampled) const {
         return false;
     }
 
+    // 是否实现了上面的 sample。只实现了 scatter 的材质 (如 isotropic)
+    // 返回 false，积分器对它们退回 scatter；实现了 sample 的材质
+    // sample 返回 false 即表示路径在此被吸收
+    virtual bool has_sample() const {
+        return false;
+    }
+
+    // 用全局随机数采样，供未接入 Sampler 的积分器使用
+    bool sample(const hit_record &rec, const vec3 &wo,
+                BSDFSample &sampled) const {
+        return sample(rec, wo, vec2(random_double(), random_double()),
+                      random_double(), sampled);
+    }
+
     // 给定两个方向，计算反射比率（BSDF值）
     virtual color eval(const hit_record &rec, const vec3 &wo,
                        const vec3 &wi) const {
@@ -67,23 +98,37 @@ class material {
                          color &attenuation, ray &scattered) const {
         return false;
     }
+
+  private:
+    static uint32_t next_id() {
+        static std::atomic<uint32_t> counter(0);
+        return ++counter;
+    }
+
+    uint32_t m_id;
 };
 
 class lambertian : public material {
   public:
-    lambertian(const color &a) : albedo(make_shared<solid_color>(a)) {
+    lambertian(const color &a) : albedo(make_pooled<solid_color>(a)) {
     }
     lambertian(shared_ptr<texture> a) : albedo(a) {
     }
 
-    virtual bool sample(const hit_record &rec, const vec3 &wo,
-                        BSDFSample &sampled) const override {
-        vec3 scatter_direction = rec.normal + random_unit_vector();
-        if (scatter_direction.near_zero()) {
-            scatter_direction = rec.normal;
-        }
-        sampled.wi = unit_vector(scatter_direction);
-        sampled.pdf = dot(rec.normal, sampled.wi) / pi;
+    virtual color base_color(const hit_record &rec) const override {
+        return albedo->value(rec.u, rec.v, rec.p);
+    }
+
+    virtual bool has_sample() const override {
+        return true;
+    }
+
+    virtual bool sample(const hit_record &rec, const vec3 &wo, const vec2 &u,
+                        double u_lobe, BSDFSample &sampled) const override {
+        onb uvw;
+        uvw.build_from_w(rec.normal);
+        sampled.wi = unit_vector(uvw.local(sample_cosine_direction(u)));
+        sampled.pdf = std::max(dot(rec.normal, sampled.wi), 0.0) / pi;
         sampled.f = albedo->value(rec.u, rec.v, rec.p) / pi;
         sampled.is_specular = false;
         return true;
@@ -106,7 +151,7 @@ class lambertian : public material {
         if (scatter_direction.near_zero()) {
             scatter_direction = rec.normal;
         }
-        scattered = ray(rec.p, scatter_direction, r_in.time());
+        scattered = spawn_ray(rec, scatter_direction, r_in.time());
         attenuation = albedo->value(rec.u, rec.v, rec.p);
         return true;
     }
@@ -120,10 +165,19 @@ class metal : public material {
     metal(const color &a, double f) : albedo(a), fuzz(f < 1 ? f : 1) {
     }
 
-    virtual bool sample(const hit_record &rec, const vec3 &wo,
-                        BSDFSample &sampled) const override {
+    virtual color base_color(const hit_record &rec) const override {
+        return albedo;
+    }
+
+    virtual bool has_sample() const override {
+        return true;
+    }
+
+    virtual bool sample(const hit_record &rec, const vec3 &wo, const vec2 &u,
+                        double u_lobe, BSDFSample &sampled) const override {
         vec3 reflected = reflect(unit_vector(-wo), rec.normal);
-        sampled.wi = unit_vector(reflected + fuzz * random_in_unit_sphere());
+        sampled.wi =
+            unit_vector(reflected + fuzz * sample_in_unit_sphere(u, u_lobe));
         sampled.f = albedo;
         sampled.pdf = 1.0;
         sampled.is_specular = true;
@@ -133,8 +187,8 @@ class metal : public material {
     virtual bool scatter(const ray &r_in, const hit_record &rec,
                          color &attenuation, ray &scattered) const override {
         vec3 reflected = reflect(unit_vector(r_in.direction()), rec.normal);
-        scattered =
-            ray(rec.p, reflected + fuzz * random_in_unit_sphere(), r_in.time());
+        scattered = spawn_ray(rec, reflected + fuzz * random_in_unit_sphere(),
+                              r_in.time());
         attenuation = albedo;
         return (dot(scattered.direction(), rec.normal) > 0);
     }
@@ -149,8 +203,12 @@ class dielectric : public material {
     dielectric(double index_of_refraction) : ir(index_of_refraction) {
     }
 
-    virtual bool sample(const hit_record &rec, const vec3 &wo,
-                        BSDFSample &sampled) const override {
+    virtual bool has_sample() const override {
+        return true;
+    }
+
+    virtual bool sample(const hit_record &rec, const vec3 &wo, const vec2 &u,
+                        double u_lobe, BSDFSample &sampled) const override {
         sampled.f = color(1.0, 1.0, 1.0);
         sampled.is_specular = true;
         sampled.pdf = 1.0;
@@ -163,7 +221,7 @@ class dielectric : public material {
         bool cannot_refract = refraction_ratio * sin_theta > 1.0;
 
         if (cannot_refract ||
-            reflectance(cos_theta, refraction_ratio) > random_double()) {
+            reflectance(cos_theta, refraction_ratio) > u_lobe) {
             sampled.wi = reflect(unit_direction, rec.normal);
             sampled.is_transmission = false;
         } else {
@@ -188,7 +246,7 @@ class dielectric : public material {
         } else {
             direction = refract(unit_direction, rec.normal, refraction_ratio);
         }
-        scattered = ray(rec.p, direction, r_in.time());
+        scattered = spawn_ray(rec, direction, r_in.time());
         return true;
     }
 
@@ -207,11 +265,11 @@ class diffuse_light : public material {
   public:
     diffuse_light(shared_ptr<texture> a) : emit(a) {
     }
-    diffuse_light(color c) : emit(make_shared<solid_color>(c)) {
+    diffuse_light(color c) : emit(make_pooled<solid_color>(c)) {
     }
 
-    virtual bool sample(const hit_record &rec, const vec3 &wo,
-                        BSDFSample &sampled) const override {
+    virtual bool sample(const hit_record &rec, const vec3 &wo, const vec2 &u,
+                        double u_lobe, BSDFSample &sampled) const override {
         return false;
     }
 
@@ -242,8 +300,16 @@ class PBRMaterial : public material {
         : albedo(a), roughness(r), metallic(m), normal_map(n) {
     }
 
-    virtual bool sample(const hit_record &rec, const vec3 &wo,
-                        BSDFSample &sampled) const override {
+    virtual color base_color(const hit_record &rec) const override {
+        return albedo->value(rec.u, rec.v, rec.p);
+    }
+
+    virtual bool has_sample() const override {
+        return true;
+    }
+
+    virtual bool sample(const hit_record &rec, const vec3 &wo, const vec2 &u,
+                        double u_lobe, BSDFSample &sampled) const override {
         vec3 N = rec.normal;
         if (normal_map) {
             onb uvw;
@@ -264,12 +330,12 @@ class PBRMaterial : public material {
         rough = clamp(rough, 0.01, 1.0);
 
         // 50% chance to sample specular (GGX), 50% diffuse (Cosine)
-        if (random_double() < 0.5) {
+        if (u_lobe < 0.5) {
             // Sample Specular (GGX)
             onb uvw;
             uvw.build_from_w(N);
-            double r1 = random_double();
-            double r2 = random_double();
+            double r1 = u.x();
+            double r2 = u.y();
             double a = rough * rough;
             double phi = 2.0 * pi * r1;
 
@@ -287,7 +353,7 @@ class PBRMaterial : public material {
             // Sample Diffuse (Cosine)
             onb uvw;
             uvw.build_from_w(N);
-            vec3 L = uvw.local(random_cosine_direction());
+            vec3 L = uvw.local(sample_cosine_direction(u));
             if (dot(N, L) <= 0)
                 L = N; // Should not happen with cosine sample but safety
             sampled.wi = unit_vector(L);
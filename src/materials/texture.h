@@ -4,6 +4,7 @@
 #include "perlin.h"
 #include "rtw_stb_image.h"
 #include "rtweekend.h"
+#include "scene_arena.h"
 #include "vec3.h"
 
 #include <iostream>
@@ -61,8 +62,8 @@ class checker_texture : public texture {
     }
 
     checker_texture(color c1, color c2)
-        : even(make_shared<solid_color>(c1)),
-          odd(make_shared<solid_color>(c2)) {
+        : even(make_pooled<solid_color>(c1)),
+          odd(make_pooled<solid_color>(c2)) {
     }
 
     virtual color value(double u, double v, const point3 &p) const override {
@@ -0,0 +1,103 @@
+#ifndef ACCUMULATION_BUFFER_H
+#define ACCUMULATION_BUFFER_H
+
+#include "rtweekend.h"
+#include "vec3.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// 相对误差的分母下限，避免近乎全黑的像素因均值过小而永远无法收敛
+constexpr double kRelativeErrorLuminanceFloor = 0.01;
+
+inline double luminance(const color &c) {
+    return 0.2126 * c.x() + 0.7152 * c.y() + 0.0722 * c.z();
+}
+
+// 渐进式渲染的累积缓冲：每个像素存未截断的线性辐亮度之和 (float)、
+// 亮度平方和及已累积的样本数。样本数逐像素记录，渲染在某一遍中途停止时，
+// 各像素的平均值依然无偏；平方和用于估计自适应采样所需的方差。
+// 平方和用 double 存储，样本数很多时 float 相减会丢失方差的有效位
+class AccumulationBuffer {
+  public:
+    void reset(int width, int height) {
+        m_width = width;
+        m_height = height;
+        m_sum.assign(static_cast<size_t>(width) * height * 3, 0.0f);
+        m_luminance_sq.assign(static_cast<size_t>(width) * height, 0.0);
+        m_samples.assign(static_cast<size_t>(width) * height, 0);
+    }
+
+    // radiance_sum 为这批样本的辐亮度之和，luminance_sq_sum 为各样本亮度的平方和
+    void add(int x, int y, const color &radiance_sum, double luminance_sq_sum,
+             int samples) {
+        size_t index = pixel_index(x, y);
+        float *sum = &m_sum[3 * index];
+        sum[0] += static_cast<float>(radiance_sum.x());
+        sum[1] += static_cast<float>(radiance_sum.y());
+        sum[2] += static_cast<float>(radiance_sum.z());
+        m_luminance_sq[index] += luminance_sq_sum;
+        m_samples[index] += samples;
+    }
+
+    // 像素的平均辐亮度，尚无样本时为黑色
+    color mean(int x, int y) const {
+        size_t index = pixel_index(x, y);
+        if (m_samples[index] == 0) {
+            return color(0, 0, 0);
+        }
+        const float *sum = &m_sum[3 * index];
+        double scale = 1.0 / m_samples[index];
+        return color(sum[0] * scale, sum[1] * scale, sum[2] * scale);
+    }
+
+    int samples(int x, int y) const {
+        return static_cast<int>(m_samples[pixel_index(x, y)]);
+    }
+
+    // 样本亮度的无偏样本方差，样本不足两个时为 0
+    double variance(int x, int y) const {
+        size_t index = pixel_index(x, y);
+        uint32_t n = m_samples[index];
+        if (n < 2) {
+            return 0.0;
+        }
+        double mean_luminance = luminance(mean(x, y));
+        double v =
+            (m_luminance_sq[index] - n * mean_luminance * mean_luminance) /
+            (n - 1);
+        return std::max(v, 0.0);
+    }
+
+    // 均值估计的相对标准误差：sqrt(方差 / n) / 均值亮度，样本不足两个时为无穷大
+    double relative_error(int x, int y) const {
+        uint32_t n = m_samples[pixel_index(x, y)];
+        if (n < 2) {
+            return infinity;
+        }
+        double standard_error = std::sqrt(variance(x, y) / n);
+        return standard_error / std::max(luminance(mean(x, y)),
+                                         kRelativeErrorLuminanceFloor);
+    }
+
+    int width() const {
+        return m_width;
+    }
+    int height() const {
+        return m_height;
+    }
+
+  private:
+    size_t pixel_index(int x, int y) const {
+        return static_cast<size_t>(y) * m_width + x;
+    }
+
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<float> m_sum;
+    std::vector<double> m_luminance_sq;
+    std::vector<uint32_t> m_samples;
+};
+
+#endif
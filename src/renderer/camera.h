@@ -30,13 +30,19 @@ class camera {
     }
 
     ray get_ray(double s, double t) const {
-        vec3 rd = lens_radius * random_in_unit_disk();
+        return get_ray(s, t, vec2(random_double(), random_double()),
+                       random_double());
+    }
+
+    // 镜头位置和快门时间由样本值 u_lens、u_time 确定
+    ray get_ray(double s, double t, const vec2 &u_lens, double u_time) const {
+        vec3 rd = lens_radius * sample_unit_disk(u_lens);
         vec3 offset = u * rd.x() + v * rd.y();
 
         return ray(origin + offset,
                    lower_left_corner + s * horizontal + t * vertical - origin -
                        offset,
-                   random_double(time0, time1));
+                   time0 + (time1 - time0) * u_time);
     }
 
   private:
@@ -0,0 +1,326 @@
+#ifndef DENOISER_H
+#define DENOISER_H
+
+#include "aligned_allocator.h"
+#include "render_buffer.h"
+#include "thread_pool.h"
+#include "vec3.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+constexpr int kDenoiseTileSize = 16;
+// 反照率下限，避免除以接近 0 的反照率放大噪声
+constexpr float kDenoiseAlbedoEpsilon = 0.01f;
+
+// 渲染结束后的边缘保持降噪：以第一个交点的反照率、法线、深度为引导的
+// à-trous 小波滤波 (Dammertz et al. 2010)，亮度权重按像素均值的方差归一化
+// (Schied et al. 2017, SVGF)。
+// 先除以反照率得到"照度"再滤波，最后乘回，纹理细节不会被模糊。
+// 每一轮按 tile 并行，各像素只读上一轮的结果，输出与线程数无关
+class Denoiser {
+  public:
+    struct Settings {
+        int iterations = 5;           // 第 k 轮的采样间隔为 2^k 像素
+        float sigma_luminance = 4.0f; // 亮度差相对于标准差的容忍度
+        float sigma_normal = 128.0f;  // 法线夹角权重 max(0, cos)^sigma
+        float sigma_depth = 1.0f;     // 深度差相对于局部深度梯度的容忍度
+    };
+
+    struct Stats {
+        double seconds = 0.0;
+        int iterations = 0;
+    };
+
+    Denoiser() = default;
+    explicit Denoiser(const Settings &settings) : m_settings(settings) {
+    }
+
+    void set_settings(const Settings &settings) {
+        m_settings = settings;
+    }
+    const Settings &settings() const {
+        return m_settings;
+    }
+
+    // 对 input 的颜色降噪并写入 output，两者可以是同一个缓冲。
+    // input 需要开启 albedo / normal / depth AOV；
+    // 同时开启 variance 和 sample_count 时用渲染器统计的方差，
+    // 否则用 3x3 邻域的亮度方差代替
+    Stats denoise(RenderBuffer &input, RenderBuffer &output,
+                  thread_pool *pool = nullptr) {
+        Stats stats;
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        if (!input.has_aov(Aov::albedo) || !input.has_aov(Aov::normal) ||
+            !input.has_aov(Aov::depth)) {
+            std::cerr << "Denoiser: albedo, normal and depth AOVs are required"
+                      << std::endl;
+            return stats;
+        }
+        if (output.width() != input.width() ||
+            output.height() != input.height()) {
+            std::cerr << "Denoiser: output size does not match input"
+                      << std::endl;
+            return stats;
+        }
+
+        m_width = input.width();
+        m_height = input.height();
+        const size_t pixel_count = static_cast<size_t>(m_width) * m_height;
+        m_color[0].assign(3 * pixel_count, 0.0f);
+        m_color[1].assign(3 * pixel_count, 0.0f);
+        m_variance[0].assign(pixel_count, 0.0f);
+        m_variance[1].assign(pixel_count, 0.0f);
+        m_albedo.assign(3 * pixel_count, 1.0f);
+        m_guides.assign(pixel_count, Guide());
+
+        const int tiles_x =
+            (m_width + kDenoiseTileSize - 1) / kDenoiseTileSize;
+        const int tiles_y =
+            (m_height + kDenoiseTileSize - 1) / kDenoiseTileSize;
+        auto for_each_tile = [&](const std::function<void(int, int)> &fn) {
+            auto run_tile = [&](int tile_index) {
+                int x0 = tile_index % tiles_x * kDenoiseTileSize;
+                int y0 = tile_index / tiles_x * kDenoiseTileSize;
+                int x1 = std::min(x0 + kDenoiseTileSize, m_width);
+                int y1 = std::min(y0 + kDenoiseTileSize, m_height);
+                for (int y = y0; y < y1; ++y) {
+                    for (int x = x0; x < x1; ++x) {
+                        fn(x, y);
+                    }
+                }
+            };
+            if (pool) {
+                pool->parallel_for(tiles_x * tiles_y, run_tile);
+            } else {
+                for (int t = 0; t < tiles_x * tiles_y; ++t) {
+                    run_tile(t);
+                }
+            }
+        };
+
+        const bool has_statistics = input.has_aov(Aov::variance) &&
+                                    input.has_aov(Aov::sample_count);
+        for_each_tile([&](int x, int y) { load_pixel(input, x, y); });
+        for_each_tile([&](int x, int y) { compute_depth_gradient(x, y); });
+        for_each_tile([&](int x, int y) {
+            estimate_variance(input, x, y, has_statistics);
+        });
+
+        int src = 0;
+        for (int k = 0; k < m_settings.iterations; ++k) {
+            const int step = 1 << k;
+            for_each_tile([&](int x, int y) {
+                filter_pixel(x, y, step, src, 1 - src);
+            });
+            src = 1 - src;
+        }
+
+        for_each_tile([&](int x, int y) {
+            size_t i = pixel_index(x, y);
+            const float *c = &m_color[src][3 * i];
+            const float *a = &m_albedo[3 * i];
+            output.store(x, y, color(c[0] * a[0], c[1] * a[1], c[2] * a[2]));
+        });
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end_time - start_time;
+        stats.seconds = elapsed.count();
+        stats.iterations = m_settings.iterations;
+        return stats;
+    }
+
+  private:
+    // 每个像素的引导特征：归一化法线、深度、局部深度梯度
+    struct Guide {
+        float normal[3] = {0, 0, 0};
+        float depth = std::numeric_limits<float>::infinity();
+        float depth_gradient = 0.0f;
+    };
+
+    size_t pixel_index(int x, int y) const {
+        return static_cast<size_t>(y) * m_width + x;
+    }
+
+    static float luminance(const float *c) {
+        return 0.2126f * c[0] + 0.7152f * c[1] + 0.0722f * c[2];
+    }
+
+    // 读入颜色和引导特征，颜色除以反照率；未命中的像素不做解调
+    void load_pixel(RenderBuffer &input, int x, int y) {
+        size_t i = pixel_index(x, y);
+        const float *c = input.row(y) + 3 * x;
+        const float *n = input.aov_row(Aov::normal, y) + 3 * x;
+        float depth = input.aov_row(Aov::depth, y)[x];
+        Guide &g = m_guides[i];
+        g.depth = depth;
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 0.0f) {
+            for (int a = 0; a < 3; ++a) {
+                g.normal[a] = n[a] / length;
+            }
+        }
+        float *albedo = &m_albedo[3 * i];
+        if (std::isfinite(depth)) {
+            const float *a = input.aov_row(Aov::albedo, y) + 3 * x;
+            for (int ch = 0; ch < 3; ++ch) {
+                albedo[ch] = a[ch] + kDenoiseAlbedoEpsilon;
+            }
+        }
+        for (int ch = 0; ch < 3; ++ch) {
+            m_color[0][3 * i + ch] = c[ch] / albedo[ch];
+        }
+    }
+
+    // 中心差分的深度梯度，用于在倾斜表面上放宽深度权重
+    void compute_depth_gradient(int x, int y) {
+        Guide &g = m_guides[pixel_index(x, y)];
+        if (!std::isfinite(g.depth)) {
+            return;
+        }
+        auto depth_at = [&](int px, int py) {
+            px = std::min(std::max(px, 0), m_width - 1);
+            py = std::min(std::max(py, 0), m_height - 1);
+            float d = m_guides[pixel_index(px, py)].depth;
+            return std::isfinite(d) ? d : g.depth;
+        };
+        float dx = 0.5f * std::abs(depth_at(x + 1, y) - depth_at(x - 1, y));
+        float dy = 0.5f * std::abs(depth_at(x, y + 1) - depth_at(x, y - 1));
+        g.depth_gradient = std::max(dx, dy);
+    }
+
+    // 解调后像素均值的亮度方差，再做一次 3x3 高斯平滑
+    void estimate_variance(RenderBuffer &input, int x, int y,
+                           bool has_statistics) {
+        static const float gaussian[3] = {0.25f, 0.5f, 0.25f};
+        size_t i = pixel_index(x, y);
+        const float albedo_luminance = luminance(&m_albedo[3 * i]);
+        float variance = 0.0f;
+        if (has_statistics) {
+            float weight_sum = 0.0f;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int px = x + dx;
+                    int py = y + dy;
+                    if (px < 0 || px >= m_width || py < 0 || py >= m_height) {
+                        continue;
+                    }
+                    float n = input.aov_row(Aov::sample_count, py)[px];
+                    float v = input.aov_row(Aov::variance, py)[px];
+                    float w = gaussian[dx + 1] * gaussian[dy + 1];
+                    variance += w * (n > 0 ? v / n : 0.0f);
+                    weight_sum += w;
+                }
+            }
+            variance /= weight_sum * albedo_luminance * albedo_luminance;
+        } else {
+            float sum = 0.0f;
+            float sum_sq = 0.0f;
+            int count = 0;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int px = x + dx;
+                    int py = y + dy;
+                    if (px < 0 || px >= m_width || py < 0 || py >= m_height) {
+                        continue;
+                    }
+                    float l = luminance(&m_color[0][3 * pixel_index(px, py)]);
+                    sum += l;
+                    sum_sq += l * l;
+                    ++count;
+                }
+            }
+            float mean = sum / count;
+            variance = std::max(sum_sq / count - mean * mean, 0.0f);
+        }
+        m_variance[0][i] = variance;
+    }
+
+    // à-trous 的一轮：5x5 B3 样条核，间隔 step，
+    // 权重乘以亮度、法线、深度三项边缘停止函数；方差按权重平方传播
+    void filter_pixel(int x, int y, int step, int src, int dst) {
+        static const float kernel[5] = {1.0f / 16, 1.0f / 4, 3.0f / 8,
+                                        1.0f / 4, 1.0f / 16};
+        const size_t i = pixel_index(x, y);
+        const Guide &gp = m_guides[i];
+        const float *cp = &m_color[src][3 * i];
+        const float lp = luminance(cp);
+        const float sigma_l =
+            m_settings.sigma_luminance * std::sqrt(m_variance[src][i]) +
+            1e-6f;
+        const bool p_hit = std::isfinite(gp.depth);
+
+        float sum[3] = {0, 0, 0};
+        float weight_sum = 0.0f;
+        float variance_sum = 0.0f;
+        for (int dy = -2; dy <= 2; ++dy) {
+            int qy = y + dy * step;
+            if (qy < 0 || qy >= m_height) {
+                continue;
+            }
+            for (int dx = -2; dx <= 2; ++dx) {
+                int qx = x + dx * step;
+                if (qx < 0 || qx >= m_width) {
+                    continue;
+                }
+                const size_t j = pixel_index(qx, qy);
+                const Guide &gq = m_guides[j];
+                const float *cq = &m_color[src][3 * j];
+                const bool q_hit = std::isfinite(gq.depth);
+                if (p_hit != q_hit) {
+                    continue;
+                }
+
+                float w = kernel[dx + 2] * kernel[dy + 2];
+                float exponent = std::abs(lp - luminance(cq)) / sigma_l;
+                if (p_hit) {
+                    float cos_theta = gp.normal[0] * gq.normal[0] +
+                                      gp.normal[1] * gq.normal[1] +
+                                      gp.normal[2] * gq.normal[2];
+                    w *= std::pow(std::max(cos_theta, 0.0f),
+                                  m_settings.sigma_normal);
+                    float distance =
+                        step * std::sqrt(static_cast<float>(dx * dx + dy * dy));
+                    exponent +=
+                        std::abs(gp.depth - gq.depth) /
+                        (m_settings.sigma_depth * gp.depth_gradient * distance +
+                         1e-3f * gp.depth);
+                }
+                w *= std::exp(-exponent);
+
+                for (int ch = 0; ch < 3; ++ch) {
+                    sum[ch] += w * cq[ch];
+                }
+                weight_sum += w;
+                variance_sum += w * w * m_variance[src][j];
+            }
+        }
+
+        float *out = &m_color[dst][3 * i];
+        if (weight_sum <= 0.0f) {
+            std::copy(cp, cp + 3, out);
+            m_variance[dst][i] = m_variance[src][i];
+            return;
+        }
+        for (int ch = 0; ch < 3; ++ch) {
+            out[ch] = sum[ch] / weight_sum;
+        }
+        m_variance[dst][i] = variance_sum / (weight_sum * weight_sum);
+    }
+
+    Settings m_settings;
+    int m_width = 0;
+    int m_height = 0;
+    // 解调后的颜色和方差，两份轮流作为每一轮的输入 / 输出
+    aligned_vector<float, 64> m_color[2];
+    aligned_vector<float, 64> m_variance[2];
+    aligned_vector<float, 64> m_albedo;
+    std::vector<Guide> m_guides;
+};
+
+#endif
@@ -25,6 +25,29 @@ class DirectLightIntegrator : public Integrator {
     virtual color
     Li(const ray &r, const hittable &scene, const color &background,
        const std::vector<shared_ptr<Light>> &lights) const override {
+        IndependentSampler sampler;
+        return trace<false>(r, scene, background, lights, sampler, nullptr);
+    }
+
+    virtual color Li(const ray &r, const hittable &scene,
+                     const color &background,
+                     const std::vector<shared_ptr<Light>> &lights,
+                     Sampler &sampler) const override {
+        return trace<false>(r, scene, background, lights, sampler, nullptr);
+    }
+
+    virtual color Li(const ray &r, const hittable &scene,
+                     const color &background,
+                     const std::vector<shared_ptr<Light>> &lights,
+                     Sampler &sampler, PathFeatures &features) const override {
+        return trace<true>(r, scene, background, lights, sampler, &features);
+    }
+
+  private:
+    template <bool kRecordFeatures>
+    color trace(const ray &r, const hittable &scene, const color &background,
+                const std::vector<shared_ptr<Light>> &lights, Sampler &sampler,
+                PathFeatures *features) const {
         color throughput(1.0, 1.0, 1.0);
         color L(0.0, 0.0, 0.0);
         ray current_ray = r;
@@ -34,34 +57,53 @@ class DirectLightIntegrator : public Integrator {
             hit_record rec;
             if (!scene.hit(current_ray, 0.001, infinity, rec)) {
                 // Check if there is an environment light in the lights list
+                color L_env(0, 0, 0);
                 bool found_env = false;
                 for (const auto &light : lights) {
                     if (light->is_infinite()) {
-                        L += throughput * light->Le(current_ray);
+                        L_env += throughput * light->Le(current_ray);
                         found_env = true;
                     }
                 }
                 if (!found_env) {
-                    L += throughput * background;
+                    L_env = throughput * background;
+                }
+                L += L_env;
+                if (kRecordFeatures) {
+                    features->add_contribution(depth, L_env);
                 }
                 break;
             }
 
+            if (kRecordFeatures && depth == 0) {
+                features->record_first_hit(current_ray, rec);
+            }
+            const BounceSample u = sampler.get_bounce(depth);
+
             vec3 wo = -unit_vector(current_ray.direction());
 
             if (depth == 0 || specular_bounce) {
-                color emitted = rec.mat_ptr->emitted(rec, wo);
-                L += throughput * emitted;
+                color L_emit = throughput * rec.mat_ptr->emitted(rec, wo);
+                L += L_emit;
+                if (kRecordFeatures) {
+                    features->add_contribution(depth, L_emit);
+                }
             }
 
             specular_bounce = rec.mat_ptr->is_specular();
 
             if (!specular_bounce && !lights.empty()) {
-                L += throughput * sample_lights_direct(rec, wo, scene, lights);
+                color L_direct =
+                    throughput *
+                    sample_lights_direct(rec, wo, scene, lights, u);
+                L += L_direct;
+                if (kRecordFeatures) {
+                    features->add_contribution(depth + 1, L_direct);
+                }
             }
 
             BSDFSample bs;
-            if (!rec.mat_ptr->sample(rec, wo, bs)) {
+            if (!rec.mat_ptr->sample(rec, wo, u.bsdf, u.lobe, bs)) {
                 break;
             }
 
@@ -78,13 +120,13 @@ class DirectLightIntegrator : public Integrator {
                 throughput *= bs.f * cos_theta / bs.pdf;
             }
 
-            current_ray = ray(rec.p, bs.wi, current_ray.time());
+            current_ray = spawn_ray(rec, bs.wi, current_ray.time());
 
             if (depth >= m_rr_start_depth) {
                 double p_survive =
                     std::max({throughput.x(), throughput.y(), throughput.z()});
                 p_survive = clamp(p_survive, 0.05, 0.95);
-                if (random_double() > p_survive) {
+                if (u.russian_roulette > p_survive) {
                     break;
                 }
                 throughput /= p_survive;
@@ -93,30 +135,29 @@ class DirectLightIntegrator : public Integrator {
         return L;
     }
 
-  private:
     color
     sample_lights_direct(const hit_record &rec, const vec3 &wo,
                          const hittable &scene,
-                         const std::vector<shared_ptr<Light>> &lights) const {
+                         const std::vector<shared_ptr<Light>> &lights,
+                         const BounceSample &u) const {
         if (lights.empty()) {
             return color(0, 0, 0);
         }
         color L_direct(0, 0, 0);
 
-        int light_idx = random_int(0, lights.size() - 1);
+        int light_count = static_cast<int>(lights.size());
+        int light_idx = std::min(
+            static_cast<int>(u.light_select * light_count), light_count - 1);
         const auto &light = lights[light_idx];
         double light_pdf = 1.0 / lights.size();
 
-        vec2 u(random_double(), random_double());
-
-        LightSample ls = light->sample(rec.p, u);
+        LightSample ls = light->sample(rec.p, u.light);
 
         if (ls.pdf > 0 && ls.Li.length_squared() > 0) {
-            ray shadow_ray(rec.p, ls.wi, 0);
-            hit_record shadow_rec;
-
-            bool in_shadow =
-                scene.hit(shadow_ray, 0.001, ls.dist - 0.001, shadow_rec);
+            double shadow_t_max;
+            ray shadow_ray =
+                spawn_shadow_ray(rec, ls.wi, ls.dist, shadow_t_max);
+            bool in_shadow = scene.occluded(shadow_ray, 0.001, shadow_t_max);
 
             if (!in_shadow) {
                 color f = rec.mat_ptr->eval(rec, wo, ls.wi);
@@ -0,0 +1,346 @@
+#ifndef IMAGE_IO_H
+#define IMAGE_IO_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "image_view.h"
+#include "thread_pool.h"
+
+// 由 stb_image_write 的实现提供（render_buffer.h 中定义
+// STB_IMAGE_WRITE_IMPLEMENTATION），返回的缓冲区需要 free
+extern "C" unsigned char *stbi_zlib_compress(unsigned char *data,
+                                             int data_len, int *out_len,
+                                             int quality);
+
+// 线性辐亮度的无损输出：PFM (32 位 float) 和 OpenEXR 兼容的半精度 EXR。
+// 均为本地实现，不依赖外部库
+
+// EXR 的压缩方式，取值与文件格式中的编码一致
+enum class ExrCompression {
+    none = 0,
+    rle = 1,  // 逐行游程编码
+    zips = 2, // 逐行 zlib
+    zip = 3   // 每 16 行一块的 zlib，压缩率最高
+};
+
+// EXR 的一个通道：第 y 行第 x 个像素位于
+// data[y * row_stride + x * pixel_stride]，y = 0 为图像底部
+struct ExrChannel {
+    std::string name;
+    const float *data;
+    size_t row_stride;
+    size_t pixel_stride;
+};
+
+// float -> IEEE 754 半精度，就近舍入到偶数；溢出为无穷大，保留 NaN
+inline uint16_t float_to_half(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const uint32_t exponent = (bits >> 23) & 0xffu;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    if (exponent == 0xff) {
+        return static_cast<uint16_t>(
+            sign | 0x7c00u | (mantissa ? 0x200u | (mantissa >> 13) : 0));
+    }
+    int half_exponent = static_cast<int>(exponent) - 127 + 15;
+    if (half_exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+
+    uint32_t half;
+    uint32_t remainder;
+    uint32_t halfway;
+    if (half_exponent <= 0) {
+        // 半精度的非规格化数
+        if (half_exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        int shift = 14 - half_exponent;
+        half = mantissa >> shift;
+        remainder = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    } else {
+        half = (static_cast<uint32_t>(half_exponent) << 10) | (mantissa >> 13);
+        remainder = mantissa & 0x1fffu;
+        halfway = 0x1000u;
+    }
+    // 尾数进位会自然进到指数，最大值进位后恰好是无穷大
+    if (remainder > halfway || (remainder == halfway && (half & 1))) {
+        half++;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+inline bool is_little_endian() {
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+// PFM：文本头 + 自下而下的 float RGB 行，比例因子的符号表示字节序
+inline bool write_pfm(const std::string &filename, const ImageView &image) {
+    FILE *file = std::fopen(filename.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "PF\n%d %d\n%s\n", image.width, image.height,
+                 is_little_endian() ? "-1.0" : "1.0");
+    bool ok = true;
+    const size_t row_floats = static_cast<size_t>(image.width) * 3;
+    for (int y = 0; y < image.height && ok; ++y) {
+        ok = std::fwrite(image.row(y), sizeof(float), row_floats, file) ==
+             row_floats;
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+inline void exr_put_u32(std::vector<unsigned char> &out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<unsigned char>(v >> (8 * i)));
+    }
+}
+
+inline void exr_put_u64(std::vector<unsigned char> &out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<unsigned char>(v >> (8 * i)));
+    }
+}
+
+inline void exr_put_f32(std::vector<unsigned char> &out, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    exr_put_u32(out, bits);
+}
+
+inline void exr_put_string(std::vector<unsigned char> &out,
+                           const std::string &s) {
+    out.insert(out.end(), s.begin(), s.end());
+    out.push_back(0);
+}
+
+// 写一个头部属性：名称、类型、字节数，之后由调用者追加属性值
+inline void exr_begin_attribute(std::vector<unsigned char> &out,
+                                const char *name, const char *type,
+                                uint32_t size) {
+    exr_put_string(out, name);
+    exr_put_string(out, type);
+    exr_put_u32(out, size);
+}
+
+// RLE 和 ZIP 压缩前的预处理：奇偶字节分开存放，再做差分预测，
+// 让半精度数的高字节（指数）与低字节各自连续，提高压缩率
+inline std::vector<unsigned char>
+exr_predict(const std::vector<unsigned char> &raw) {
+    const size_t n = raw.size();
+    std::vector<unsigned char> out(n);
+    size_t even = 0;
+    size_t odd = (n + 1) / 2;
+    for (size_t i = 0; i < n; i += 2) {
+        out[even++] = raw[i];
+        if (i + 1 < n) {
+            out[odd++] = raw[i + 1];
+        }
+    }
+    int previous = n > 0 ? out[0] : 0;
+    for (size_t i = 1; i < n; ++i) {
+        int current = out[i];
+        out[i] = static_cast<unsigned char>(current - previous + 128 + 256);
+        previous = current;
+    }
+    return out;
+}
+
+// OpenEXR 的字节游程编码：正计数 c 表示下一个字节重复 c + 1 次，
+// 负计数 -c 表示其后 c 个字节原样拷贝
+inline std::vector<unsigned char>
+exr_rle_compress(const std::vector<unsigned char> &in) {
+    constexpr ptrdiff_t kMinRun = 3;
+    constexpr ptrdiff_t kMaxRun = 127;
+    std::vector<unsigned char> out;
+    out.reserve(in.size() + in.size() / kMaxRun + 1);
+
+    const unsigned char *end = in.data() + in.size();
+    const unsigned char *run_start = in.data();
+    const unsigned char *run_end = run_start + 1;
+    while (run_start < end) {
+        while (run_end < end && *run_start == *run_end &&
+               run_end - run_start - 1 < kMaxRun) {
+            ++run_end;
+        }
+        if (run_end - run_start >= kMinRun) {
+            out.push_back(static_cast<unsigned char>(run_end - run_start - 1));
+            out.push_back(*run_start);
+            run_start = run_end;
+        } else {
+            // 一直拷贝到出现至少三个相同字节为止
+            while (run_end < end &&
+                   ((run_end + 1 >= end || *run_end != *(run_end + 1)) ||
+                    (run_end + 2 >= end ||
+                     *(run_end + 1) != *(run_end + 2))) &&
+                   run_end - run_start < kMaxRun) {
+                ++run_end;
+            }
+            out.push_back(static_cast<unsigned char>(run_start - run_end));
+            out.insert(out.end(), run_start, run_end);
+            run_start = run_end;
+        }
+        ++run_end;
+    }
+    return out;
+}
+
+inline std::vector<unsigned char>
+exr_zip_compress(const std::vector<unsigned char> &in) {
+    int length = 0;
+    unsigned char *data = stbi_zlib_compress(
+        const_cast<unsigned char *>(in.data()), static_cast<int>(in.size()),
+        &length, 8);
+    if (!data) {
+        return {};
+    }
+    std::vector<unsigned char> out(data, data + length);
+    std::free(data);
+    return out;
+}
+
+// 写出单部分、扫描线存储的 EXR。通道按名称排序（格式要求），
+// 每块行内按通道平面存放半精度数据；压缩后不比原始数据小的块原样存储。
+// 给定线程池时各块并行压缩
+inline bool write_exr(const std::string &filename, int width, int height,
+                      std::vector<ExrChannel> channels,
+                      ExrCompression compression = ExrCompression::zip,
+                      thread_pool *pool = nullptr) {
+    if (width <= 0 || height <= 0 || channels.empty()) {
+        return false;
+    }
+    std::sort(channels.begin(), channels.end(),
+              [](const ExrChannel &a, const ExrChannel &b) {
+                  return a.name < b.name;
+              });
+
+    std::vector<unsigned char> header = {0x76, 0x2f, 0x31, 0x01, 2, 0, 0, 0};
+    uint32_t chlist_size = 1;
+    for (const ExrChannel &c : channels) {
+        chlist_size += static_cast<uint32_t>(c.name.size()) + 1 + 16;
+    }
+    exr_begin_attribute(header, "channels", "chlist", chlist_size);
+    for (const ExrChannel &c : channels) {
+        exr_put_string(header, c.name);
+        exr_put_u32(header, 1); // HALF
+        exr_put_u32(header, 0); // pLinear + 保留字节
+        exr_put_u32(header, 1); // xSampling
+        exr_put_u32(header, 1); // ySampling
+    }
+    header.push_back(0);
+    exr_begin_attribute(header, "compression", "compression", 1);
+    header.push_back(static_cast<unsigned char>(compression));
+    for (const char *window : {"dataWindow", "displayWindow"}) {
+        exr_begin_attribute(header, window, "box2i", 16);
+        exr_put_u32(header, 0);
+        exr_put_u32(header, 0);
+        exr_put_u32(header, static_cast<uint32_t>(width - 1));
+        exr_put_u32(header, static_cast<uint32_t>(height - 1));
+    }
+    exr_begin_attribute(header, "lineOrder", "lineOrder", 1);
+    header.push_back(0); // INCREASING_Y
+    exr_begin_attribute(header, "pixelAspectRatio", "float", 4);
+    exr_put_f32(header, 1.0f);
+    exr_begin_attribute(header, "screenWindowCenter", "v2f", 8);
+    exr_put_f32(header, 0.0f);
+    exr_put_f32(header, 0.0f);
+    exr_begin_attribute(header, "screenWindowWidth", "float", 4);
+    exr_put_f32(header, 1.0f);
+    header.push_back(0);
+
+    const int lines_per_block = compression == ExrCompression::zip ? 16 : 1;
+    const int block_count = (height + lines_per_block - 1) / lines_per_block;
+    std::vector<std::vector<unsigned char>> blocks(block_count);
+
+    // EXR 的 y 轴自上而下，第 0 行对应缓冲区的最后一行
+    auto encode_block = [&](int block) {
+        int first_line = block * lines_per_block;
+        int last_line = std::min(first_line + lines_per_block, height);
+        std::vector<unsigned char> raw;
+        raw.reserve(static_cast<size_t>(last_line - first_line) * width *
+                    channels.size() * 2);
+        for (int line = first_line; line < last_line; ++line) {
+            size_t y = static_cast<size_t>(height - 1 - line);
+            for (const ExrChannel &c : channels) {
+                const float *row = c.data + y * c.row_stride;
+                for (int x = 0; x < width; ++x) {
+                    uint16_t h = float_to_half(row[x * c.pixel_stride]);
+                    raw.push_back(static_cast<unsigned char>(h));
+                    raw.push_back(static_cast<unsigned char>(h >> 8));
+                }
+            }
+        }
+
+        std::vector<unsigned char> packed;
+        if (compression == ExrCompression::rle) {
+            packed = exr_rle_compress(exr_predict(raw));
+        } else if (compression != ExrCompression::none) {
+            packed = exr_zip_compress(exr_predict(raw));
+        }
+        std::vector<unsigned char> &out = blocks[block];
+        exr_put_u32(out, static_cast<uint32_t>(first_line));
+        const std::vector<unsigned char> &data =
+            !packed.empty() && packed.size() < raw.size() ? packed : raw;
+        exr_put_u32(out, static_cast<uint32_t>(data.size()));
+        out.insert(out.end(), data.begin(), data.end());
+    };
+    if (pool) {
+        pool->parallel_for(block_count, encode_block);
+    } else {
+        for (int block = 0; block < block_count; ++block) {
+            encode_block(block);
+        }
+    }
+
+    // 偏移表：每块在文件中的绝对位置
+    std::vector<unsigned char> offsets;
+    uint64_t position = header.size() + 8 * static_cast<uint64_t>(block_count);
+    for (const auto &block : blocks) {
+        exr_put_u64(offsets, position);
+        position += block.size();
+    }
+
+    FILE *file = std::fopen(filename.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(header.data(), 1, header.size(), file) ==
+                  header.size() &&
+              std::fwrite(offsets.data(), 1, offsets.size(), file) ==
+                  offsets.size();
+    for (const auto &block : blocks) {
+        ok = ok && std::fwrite(block.data(), 1, block.size(), file) ==
+                       block.size();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+// RGB 图像写为 R / G / B 三个半精度通道
+inline bool write_exr(const std::string &filename, const ImageView &image,
+                      ExrCompression compression = ExrCompression::zip,
+                      thread_pool *pool = nullptr) {
+    std::vector<ExrChannel> channels;
+    const char *names[] = {"R", "G", "B"};
+    for (int c = 0; c < 3; ++c) {
+        channels.push_back({names[c], image.data + c, image.stride, 3});
+    }
+    return write_exr(filename, image.width, image.height, std::move(channels),
+                     compression, pool);
+}
+
+#endif
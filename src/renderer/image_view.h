@@ -0,0 +1,28 @@
+#ifndef IMAGE_VIEW_H
+#define IMAGE_VIEW_H
+
+#include <cmath>
+#include <cstddef>
+
+// 只读的 float 图像视图，不拥有也不复制像素，像素为线性辐亮度。
+// 行内按通道交错存放 (默认 r g b)，第 y 行从 data + y * stride 开始
+// （stride 以 float 计）。与 RenderBuffer 一致，y = 0 为图像底部
+struct ImageView {
+    const float *data = nullptr;
+    int width = 0;
+    int height = 0;
+    size_t stride = 0;
+    int channels = 3;
+
+    const float *row(int y) const {
+        return data + static_cast<size_t>(y) * stride;
+    }
+};
+
+// 线性辐亮度 -> 显示用 8 位值：gamma 2 校正并截断到 [0, 1]，NaN 视为 0
+inline unsigned char to_display_byte(float linear) {
+    float v = linear > 0.0f ? std::sqrt(linear) : 0.0f;
+    return static_cast<unsigned char>((v < 1.0f ? v : 1.0f) * 255);
+}
+
+#endif
@@ -3,8 +3,67 @@
 
 #include "hittable.h"
 #include "light.h"
+#include "material.h"
 #include "ray.h"
+#include "sampler.h"
 #include "vec3.h"
+#include <cmath>
+#include <cstdint>
+
+// 单个样本的路径顶点特征，供 AOV 输出和降噪使用。几何特征取自主光线的
+// 第一个交点；辐亮度按到达光源前的散射次数拆分：
+// 0 次为直接看到的自发光 / 背景，1 次为直接光照，2 次及以上为间接光照，
+// 三者之和等于 Li 的返回值
+struct PathFeatures {
+    bool hit = false;
+    color albedo{0, 0, 0};
+    vec3 normal{0, 0, 0}; // 着色法线，朝向入射一侧
+    double depth = infinity; // 沿主光线到第一个交点的距离
+    uint32_t material_id = 0;
+    color emitted{0, 0, 0};
+    color direct{0, 0, 0};
+    color indirect{0, 0, 0};
+
+    void record_first_hit(const ray &r, const hit_record &rec) {
+        hit = true;
+        albedo = rec.mat_ptr->base_color(rec);
+        normal = rec.normal;
+        depth = rec.t * r.direction().length();
+        material_id = rec.mat_ptr->id();
+    }
+
+    void add_contribution(int bounces, const color &L) {
+        if (bounces == 0) {
+            emitted += L;
+        } else if (bounces == 1) {
+            direct += L;
+        } else {
+            indirect += L;
+        }
+    }
+};
+
+// 用本次弹射的样本值 u 在交点处生成下一段光线，返回 false 表示路径终止。
+// 实现了 sample 的材质按 BSDF 重要性采样，weight 为 f * cos / pdf
+// (镜面分支为 f)；只实现了 scatter 的材质退回 scatter，仍用全局随机数
+inline bool sample_next_ray(const ray &r_in, const hit_record &rec,
+                            const BounceSample &u, color &weight,
+                            ray &next) {
+    if (!rec.mat_ptr->has_sample()) {
+        return rec.mat_ptr->scatter(r_in, rec, weight, next);
+    }
+    vec3 wo = -unit_vector(r_in.direction());
+    BSDFSample bs;
+    if (!rec.mat_ptr->sample(rec, wo, u.bsdf, u.lobe, bs) ||
+        (bs.pdf < 1e-8 && !bs.is_specular)) {
+        return false;
+    }
+    weight = bs.is_specular
+                 ? bs.f
+                 : bs.f * std::abs(dot(bs.wi, rec.normal)) / bs.pdf;
+    next = spawn_ray(rec, bs.wi, r_in.time());
+    return true;
+}
 
 class Integrator {
   public:
@@ -17,7 +76,35 @@ class Integrator {
         // 默认实现：调用旧接口，忽略光源
         return Li(r, scene, background);
     }
+    // 样本值取自 sampler 的版本，渲染器总是调用这个版本。
+    // 内置积分器都会覆盖它；默认实现忽略 sampler，退回使用全局随机数的
+    // 旧接口
+    virtual color Li(const ray &r, const hittable &scene,
+                     const color &background,
+                     const std::vector<shared_ptr<Light>> &lights,
+                     Sampler &sampler) const {
+        return Li(r, scene, background, lights);
+    }
+    // 同时填写路径顶点特征，只有开启了 AOV 时渲染器才调用这个版本，
+    // 普通 Li 不受影响。默认实现对主光线再求一次交来取几何特征，
+    // 无法拆分直接 / 间接光照，除第一个交点的自发光外都记入 indirect
+    virtual color Li(const ray &r, const hittable &scene,
+                     const color &background,
+                     const std::vector<shared_ptr<Light>> &lights,
+                     Sampler &sampler, PathFeatures &features) const {
+        color L = Li(r, scene, background, lights, sampler);
+        hit_record rec;
+        if (scene.hit(r, 0.001, infinity, rec)) {
+            features.record_first_hit(r, rec);
+            features.emitted = rec.mat_ptr->emitted(
+                rec, -unit_vector(r.direction()));
+        } else {
+            features.emitted = background;
+        }
+        features.indirect = L - features.emitted;
+        return L;
+    }
     virtual void set_max_depth(int depth) = 0;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -25,6 +25,30 @@ class MISPathIntegrator : public Integrator {
     virtual color
     Li(const ray &r, const hittable &scene, const color &background,
        const std::vector<shared_ptr<Light>> &lights) const override {
+        IndependentSampler sampler;
+        return trace<false>(r, scene, background, lights, sampler, nullptr);
+    }
+
+    virtual color Li(const ray &r, const hittable &scene,
+                     const color &background,
+                     const std::vector<shared_ptr<Light>> &lights,
+                     Sampler &sampler) const override {
+        return trace<false>(r, scene, background, lights, sampler, nullptr);
+    }
+
+    virtual color Li(const ray &r, const hittable &scene,
+                     const color &background,
+                     const std::vector<shared_ptr<Light>> &lights,
+                     Sampler &sampler, PathFeatures &features) const override {
+        return trace<true>(r, scene, background, lights, sampler, &features);
+    }
+
+  protected:
+    // kRecordFeatures 为 false 时特征相关的分支在编译期被消除
+    template <bool kRecordFeatures>
+    color trace(const ray &r, const hittable &scene, const color &background,
+                const std::vector<shared_ptr<Light>> &lights, Sampler &sampler,
+                PathFeatures *features) const {
         color throughput(1.0, 1.0, 1.0);
         color L(0.0, 0.0, 0.0);
         ray current_ray = r;
@@ -45,11 +69,12 @@ class MISPathIntegrator : public Integrator {
                     }
                 }
 
+                color L_env(0, 0, 0);
                 if (!found_env) {
-                    L += throughput * background;
+                    L_env = throughput * background;
                 } else {
                     if (depth == 0 || specular_bounce) {
-                        L += throughput * env_L;
+                        L_env = throughput * env_L;
                     } else {
                         double light_pdf = 0.0;
                         double light_select_pdf = 1.0 / lights.size();
@@ -60,12 +85,21 @@ class MISPathIntegrator : public Integrator {
                         }
                         double mis_weight =
                             power_heuristic(prev_bsdf_pdf, light_pdf);
-                        L += throughput * env_L * mis_weight;
+                        L_env = throughput * env_L * mis_weight;
                     }
                 }
+                L += L_env;
+                if (kRecordFeatures) {
+                    features->add_contribution(depth, L_env);
+                }
                 break;
             }
 
+            if (kRecordFeatures && depth == 0) {
+                features->record_first_hit(current_ray, rec);
+            }
+            const BounceSample u = sampler.get_bounce(depth);
+
             vec3 wo = -unit_vector(current_ray.direction());
 
             // 处理发射光（带 MIS 权重）
@@ -86,10 +120,12 @@ class MISPathIntegrator : public Integrator {
                     L_emit = throughput * emitted;
                 }
 
-                if (depth == 0) {
-                    L += L_emit;
-                } else {
-                    L += clamp_radiance(L_emit);
+                if (depth != 0) {
+                    L_emit = clamp_radiance(L_emit);
+                }
+                L += L_emit;
+                if (kRecordFeatures) {
+                    features->add_contribution(depth, L_emit);
                 }
             }
 
@@ -97,14 +133,17 @@ class MISPathIntegrator : public Integrator {
 
             // 对于非镜面材质，进行显式光源采样（带 MIS）
             if (!specular_bounce && !lights.empty()) {
-                color L_direct =
-                    throughput * sample_lights_mis(rec, wo, scene, lights);
-                L += clamp_radiance(L_direct);
+                color L_direct = clamp_radiance(
+                    throughput * sample_lights_mis(rec, wo, scene, lights, u));
+                L += L_direct;
+                if (kRecordFeatures) {
+                    features->add_contribution(depth + 1, L_direct);
+                }
             }
 
             // BSDF 采样
             BSDFSample bs;
-            if (!rec.mat_ptr->sample(rec, wo, bs)) {
+            if (!rec.mat_ptr->sample(rec, wo, u.bsdf, u.lobe, bs)) {
                 ray scattered;
                 color attenuation;
                 if (!rec.mat_ptr->scatter(current_ray, rec, attenuation,
@@ -130,7 +169,7 @@ class MISPathIntegrator : public Integrator {
                     throughput *= bs.f * cos_theta / bs.pdf;
                 }
 
-                current_ray = ray(rec.p, bs.wi, current_ray.time());
+                current_ray = spawn_ray(rec, bs.wi, current_ray.time());
             }
 
             // 俄罗斯轮盘赌
@@ -139,7 +178,7 @@ class MISPathIntegrator : public Integrator {
                     std::max({throughput.x(), throughput.y(), throughput.z()});
                 p_survive = clamp(p_survive, 0.05, 0.95);
 
-                if (random_double() > p_survive) {
+                if (u.russian_roulette > p_survive) {
                     break;
                 }
                 throughput /= p_survive;
@@ -149,7 +188,6 @@ class MISPathIntegrator : public Integrator {
         return L;
     }
 
-  private:
     // Clamping helper to reduce fireflies
     static color clamp_radiance(const color &L, double max_value = 100.0) {
         if (L.x() > max_value || L.y() > max_value || L.z() > max_value) {
@@ -191,26 +229,28 @@ class MISPathIntegrator : public Integrator {
     color
     sample_lights_mis(const hit_record &rec, const vec3 &wo,
                       const hittable &scene,
-                      const std::vector<shared_ptr<Light>> &lights) const {
+                      const std::vector<shared_ptr<Light>> &lights,
+                      const BounceSample &u) const {
         if (lights.empty())
             return color(0, 0, 0);
 
         color L_direct(0, 0, 0);
 
         // 随机选择一个光源
-        int light_idx = random_int(0, lights.size() - 1);
+        int light_count = static_cast<int>(lights.size());
+        int light_idx = std::min(
+            static_cast<int>(u.light_select * light_count), light_count - 1);
         const auto &light = lights[light_idx];
         double light_select_pdf = 1.0 / lights.size();
 
-        vec2 u(random_double(), random_double());
-        LightSample ls = light->sample(rec.p, u);
+        LightSample ls = light->sample(rec.p, u.light);
 
         if (ls.pdf > 0 && ls.Li.length_squared() > 0) {
             // 阴影测试
-            ray shadow_ray(rec.p, ls.wi, 0);
-            hit_record shadow_rec;
-            bool in_shadow =
-                scene.hit(shadow_ray, 0.001, ls.dist - 0.001, shadow_rec);
+            double shadow_t_max;
+            ray shadow_ray =
+                spawn_shadow_ray(rec, ls.wi, ls.dist, shadow_t_max);
+            bool in_shadow = scene.occluded(shadow_ray, 0.001, shadow_t_max);
 
             if (!in_shadow) {
                 color f = rec.mat_ptr->eval(rec, wo, ls.wi);
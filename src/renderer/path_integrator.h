@@ -15,15 +15,24 @@ class PathIntegrator : public Integrator {
 
     virtual color Li(const ray &r, const hittable &scene,
                      const color &background) const override {
-        return Li_internal(r, scene, background, m_max_depth);
+        IndependentSampler sampler;
+        return Li_internal(r, scene, background, sampler, 0);
+    }
+
+    virtual color Li(const ray &r, const hittable &scene,
+                     const color &background,
+                     const std::vector<shared_ptr<Light>> &lights,
+                     Sampler &sampler) const override {
+        return Li_internal(r, scene, background, sampler, 0);
     }
 
   private:
     color Li_internal(const ray &r, const hittable &scene,
-                      const color &background, int depth) const {
+                      const color &background, Sampler &sampler,
+                      int depth) const {
         hit_record rec;
 
-        if (depth <= 0) {
+        if (depth >= m_max_depth) {
             return color(0, 0, 0);
         }
 
@@ -35,12 +44,13 @@ class PathIntegrator : public Integrator {
         color attenuation;
         color emitted = rec.mat_ptr->emitted(rec.u, rec.v, rec.p);
 
-        if (!rec.mat_ptr->scatter(r, rec, attenuation, scattered)) {
+        if (!sample_next_ray(r, rec, sampler.get_bounce(depth), attenuation,
+                             scattered)) {
             return emitted;
         }
 
         return emitted + attenuation * Li_internal(scattered, scene, background,
-                                                   depth - 1);
+                                                   sampler, depth + 1);
     }
     int m_max_depth;
 };
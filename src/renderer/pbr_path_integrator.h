@@ -20,6 +20,20 @@ class PBRPathIntegrator : public Integrator {
 
     virtual color Li(const ray &r, const hittable &scene,
                      const color &background) const override {
+        IndependentSampler sampler;
+        return trace(r, scene, background, sampler);
+    }
+
+    virtual color Li(const ray &r, const hittable &scene,
+                     const color &background,
+                     const std::vector<shared_ptr<Light>> &lights,
+                     Sampler &sampler) const override {
+        return trace(r, scene, background, sampler);
+    }
+
+  private:
+    color trace(const ray &r, const hittable &scene, const color &background,
+                Sampler &sampler) const {
         color throughput(1.0, 1.0, 1.0);
         color L(0.0, 0.0, 0.0);
         ray current_ray = r;
@@ -37,25 +51,14 @@ class PBRPathIntegrator : public Integrator {
             color emitted = rec.mat_ptr->emitted(rec, wo);
             L += throughput * emitted;
 
-            BSDFSample bs;
-
-            if (!rec.mat_ptr->sample(rec, wo, bs)) {
+            const BounceSample u = sampler.get_bounce(depth);
+            ray scattered;
+            color weight;
+            if (!sample_next_ray(current_ray, rec, u, weight, scattered)) {
                 break; // 采样失败（例如被吸收），停止追踪
             }
-
-            if (bs.pdf < 1e-8 && !bs.is_specular) {
-                break;
-            }
-
-            double cos_theta = std::abs(dot(bs.wi, rec.normal));
-
-            if (bs.is_specular) {
-                throughput *= bs.f;
-            } else {
-                throughput *= bs.f * cos_theta / bs.pdf;
-            }
-
-            current_ray = ray(rec.p, bs.wi, current_ray.time());
+            throughput *= weight;
+            current_ray = scattered;
 
             if (depth >= m_rr_start_depth) {
                 double p_survive =
@@ -63,7 +66,7 @@ class PBRPathIntegrator : public Integrator {
 
                 p_survive = clamp(p_survive, 0.05, 0.95);
 
-                if (random_double() > p_survive) {
+                if (u.russian_roulette > p_survive) {
                     break;
                 }
                 throughput /= p_survive;
@@ -72,7 +75,6 @@ class PBRPathIntegrator : public Integrator {
         return L;
     }
 
-  private:
     int m_max_depth = 50;
     int m_rr_start_depth = 3;
 };
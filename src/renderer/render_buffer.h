@@ -1,27 +1,160 @@
 #ifndef RENDER_BUFFER_H
 #define RENDER_BUFFER_H
 
+#include "aligned_allocator.h"
+#include "image_view.h"
+#include "thread_pool.h"
 #include "vec3.h"
+#include <limits>
 #include <string>
 #include <vector>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
+#include "image_io.h"
+
+// 每行 float 数补齐到缓存行 (16 个 float) 的整数倍
+constexpr size_t kRenderBufferRowAlignment = 16;
+
+// 可选的辅助输出 (AOV)，每个开启的 AOV 占用 RenderBuffer 中独立的一个平面。
+// albedo 到 indirect 取自积分器填写的 PathFeatures，
+// sample_count 和 variance 取自累积缓冲
+enum class Aov {
+    albedo,      // 第一个交点的反照率，样本平均
+    normal,      // 第一个交点的着色法线，样本平均 (未归一化)
+    depth,       // 到第一个交点的最近距离，未命中为无穷大
+    material_id, // 第一个命中样本的材质编号，0 为背景
+    emission,    // 直接看到的自发光 / 背景
+    direct,      // 直接光照
+    indirect,    // 间接光照
+    sample_count,
+    variance, // 样本亮度的方差
+};
+constexpr int kAovCount = 9;
+
+inline int aov_channels(Aov aov) {
+    switch (aov) {
+    case Aov::depth:
+    case Aov::material_id:
+    case Aov::sample_count:
+    case Aov::variance:
+        return 1;
+    default:
+        return 3;
+    }
+}
+
+// 写 EXR 时的通道名，多通道的 AOV 以 "层名.通道" 的形式分层
+inline std::vector<std::string> aov_channel_names(Aov aov) {
+    switch (aov) {
+    case Aov::albedo:
+        return {"albedo.R", "albedo.G", "albedo.B"};
+    case Aov::normal:
+        return {"N.X", "N.Y", "N.Z"};
+    case Aov::depth:
+        return {"Z"};
+    case Aov::material_id:
+        return {"materialId"};
+    case Aov::emission:
+        return {"emission.R", "emission.G", "emission.B"};
+    case Aov::direct:
+        return {"direct.R", "direct.G", "direct.B"};
+    case Aov::indirect:
+        return {"indirect.R", "indirect.G", "indirect.B"};
+    case Aov::sample_count:
+        return {"sampleCount"};
+    case Aov::variance:
+        return {"variance"};
+    }
+    return {};
+}
+
+// 需要积分器填写 PathFeatures 的 AOV
+inline bool is_feature_aov(Aov aov) {
+    return aov != Aov::sample_count && aov != Aov::variance;
+}
+
+// 帧缓冲：一块连续、按缓存行对齐的 float RGB 数组，存未截断的线性辐亮度，
+// 行内 r g b 交错，行间距为 stride()。y = 0 为图像底部。
+// PNG / JPG 输出和窗口显示时才做 gamma 校正和截断，PFM / EXR 保留 HDR 数据。
+// AOV 平面默认不分配，enable_aov 之后渲染器才会写入
 class RenderBuffer {
   public:
-    RenderBuffer(int width, int height) : m_width(width), m_height(height) {
-        m_pixels.resize(height, std::vector<color>(width));
+    RenderBuffer(int width, int height)
+        : m_width(width), m_height(height), m_stride(padded_stride(width, 3)) {
+        m_pixels.resize(m_stride * height, 0.0f);
+    }
+
+    void enable_aov(Aov aov) {
+        AovPlane &plane = m_aovs[static_cast<int>(aov)];
+        if (!plane.pixels.empty()) {
+            return;
+        }
+        plane.stride = padded_stride(m_width, aov_channels(aov));
+        plane.pixels.resize(plane.stride * m_height,
+                            aov == Aov::depth
+                                ? std::numeric_limits<float>::infinity()
+                                : 0.0f);
+    }
+    bool has_aov(Aov aov) const {
+        return !m_aovs[static_cast<int>(aov)].pixels.empty();
+    }
+    // 是否开启了任何需要积分器填写特征的 AOV
+    bool has_feature_aovs() const {
+        for (int a = 0; a < kAovCount; ++a) {
+            if (is_feature_aov(static_cast<Aov>(a)) &&
+                has_aov(static_cast<Aov>(a))) {
+                return true;
+            }
+        }
+        return false;
+    }
+    // AOV 平面第 y 行，未开启时为 nullptr
+    float *aov_row(Aov aov, int y) {
+        AovPlane &plane = m_aovs[static_cast<int>(aov)];
+        if (plane.pixels.empty()) {
+            return nullptr;
+        }
+        return plane.pixels.data() + static_cast<size_t>(y) * plane.stride;
+    }
+    ImageView aov_view(Aov aov) const {
+        const AovPlane &plane = m_aovs[static_cast<int>(aov)];
+        ImageView v;
+        v.data = plane.pixels.empty() ? nullptr : plane.pixels.data();
+        v.width = m_width;
+        v.height = m_height;
+        v.stride = plane.stride;
+        v.channels = aov_channels(aov);
+        return v;
     }
 
     void set_pixel(int x, int y, const color &pixel_color) {
         if (x >= 0 && x < m_width && y >= 0 && y < m_height) {
-            m_pixels[y][x] = pixel_color;
+            store(x, y, pixel_color);
         }
     }
 
-    const std::vector<std::vector<color>> &get_data() const {
-        return m_pixels;
+    // 不做边界检查的写入，供按 tile 写像素的渲染循环使用
+    void store(int x, int y, const color &pixel_color) {
+        float *p = row(y) + 3 * x;
+        p[0] = static_cast<float>(pixel_color.x());
+        p[1] = static_cast<float>(pixel_color.y());
+        p[2] = static_cast<float>(pixel_color.z());
+    }
+
+    float *row(int y) {
+        return m_pixels.data() + static_cast<size_t>(y) * m_stride;
+    }
+
+    // 零拷贝视图，供窗口显示和图像写出直接读取
+    ImageView view() const {
+        ImageView v;
+        v.data = m_pixels.data();
+        v.width = m_width;
+        v.height = m_height;
+        v.stride = m_stride;
+        return v;
     }
 
     int width() const {
@@ -30,57 +163,98 @@ class RenderBuffer {
     int height() const {
         return m_height;
     }
+    size_t stride() const {
+        return m_stride;
+    }
 
-    // 保存为PNG图片
-    bool save_to_png(const std::string &filename) const {
-        std::vector<unsigned char> image_data(m_width * m_height * 3);
-
-        for (int j = 0; j < m_height; ++j) {
-            for (int i = 0; i < m_width; ++i) {
-                // 翻转Y坐标，使图片正确显示
-                int flipped_j = m_height - 1 - j;
-                int index = (j * m_width + i) * 3;
-                const auto &pixel = m_pixels[flipped_j][i];
-                image_data[index + 0] =
-                    static_cast<unsigned char>(pixel[0] * 255);
-                image_data[index + 1] =
-                    static_cast<unsigned char>(pixel[1] * 255);
-                image_data[index + 2] =
-                    static_cast<unsigned char>(pixel[2] * 255);
-            }
-        }
-
+    // 保存为PNG图片；给定线程池时并行转换像素
+    bool save_to_png(const std::string &filename,
+                     thread_pool *pool = nullptr) const {
+        std::vector<unsigned char> image_data = to_rgb8(view(), pool);
         return stbi_write_png(filename.c_str(), m_width, m_height, 3,
                               image_data.data(), m_width * 3);
     }
 
     // 保存为JPG图片
-    bool save_to_jpg(const std::string &filename, int quality = 90) const {
-        std::vector<unsigned char> image_data(m_width * m_height * 3);
-
-        for (int j = 0; j < m_height; ++j) {
-            for (int i = 0; i < m_width; ++i) {
-                // 翻转Y坐标，使图片正确显示
-                int flipped_j = m_height - 1 - j;
-                int index = (j * m_width + i) * 3;
-                const auto &pixel = m_pixels[flipped_j][i];
-                image_data[index + 0] =
-                    static_cast<unsigned char>(pixel[0] * 255);
-                image_data[index + 1] =
-                    static_cast<unsigned char>(pixel[1] * 255);
-                image_data[index + 2] =
-                    static_cast<unsigned char>(pixel[2] * 255);
-            }
-        }
-
+    bool save_to_jpg(const std::string &filename, int quality = 90,
+                     thread_pool *pool = nullptr) const {
+        std::vector<unsigned char> image_data = to_rgb8(view(), pool);
         return stbi_write_jpg(filename.c_str(), m_width, m_height, 3,
                               image_data.data(), quality);
     }
 
+    // 保存为 32 位 float 的 PFM，线性辐亮度
+    bool save_to_pfm(const std::string &filename) const {
+        return write_pfm(filename, view());
+    }
+
+    // 保存为半精度 EXR，线性辐亮度；开启的 AOV 作为额外的通道一并写入
+    bool save_to_exr(const std::string &filename,
+                     ExrCompression compression = ExrCompression::zip,
+                     thread_pool *pool = nullptr) const {
+        std::vector<ExrChannel> channels;
+        const char *names[] = {"R", "G", "B"};
+        for (int c = 0; c < 3; ++c) {
+            channels.push_back({names[c], m_pixels.data() + c, m_stride, 3});
+        }
+        for (int a = 0; a < kAovCount; ++a) {
+            Aov aov = static_cast<Aov>(a);
+            if (!has_aov(aov)) {
+                continue;
+            }
+            ImageView plane = aov_view(aov);
+            std::vector<std::string> aov_names = aov_channel_names(aov);
+            for (int c = 0; c < plane.channels; ++c) {
+                channels.push_back({aov_names[c], plane.data + c, plane.stride,
+                                    static_cast<size_t>(plane.channels)});
+            }
+        }
+        return write_exr(filename, m_width, m_height, std::move(channels),
+                         compression, pool);
+    }
+
   private:
+    struct AovPlane {
+        size_t stride = 0;
+        aligned_vector<float, 64> pixels;
+    };
+
     int m_width;
     int m_height;
-    std::vector<std::vector<color>> m_pixels;
+    size_t m_stride; // 每行的 float 数
+    aligned_vector<float, 64> m_pixels;
+    AovPlane m_aovs[kAovCount];
+
+    static size_t padded_stride(int width, int channels) {
+        return (static_cast<size_t>(width) * channels +
+                kRenderBufferRowAlignment - 1) /
+               kRenderBufferRowAlignment * kRenderBufferRowAlignment;
+    }
+
+    // 转换为自上而下的 8 位 RGB，按行并行
+    static std::vector<unsigned char> to_rgb8(const ImageView &image,
+                                              thread_pool *pool) {
+        std::vector<unsigned char> image_data(static_cast<size_t>(image.width) *
+                                              image.height * 3);
+
+        auto convert_row = [&](int j) {
+            // 翻转Y坐标，使图片正确显示
+            const float *src = image.row(image.height - 1 - j);
+            unsigned char *dst =
+                &image_data[static_cast<size_t>(j) * image.width * 3];
+            for (int i = 0; i < image.width * 3; ++i) {
+                dst[i] = to_display_byte(src[i]);
+            }
+        };
+        if (pool) {
+            pool->parallel_for(image.height, convert_row);
+        } else {
+            for (int j = 0; j < image.height; ++j) {
+                convert_row(j);
+            }
+        }
+        return image_data;
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,32 +1,108 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include "accumulation_buffer.h"
 #include "camera.h"
 #include "hittable.h"
 #include "integrator.h"
 #include "material.h"
 #include "render_buffer.h"
 #include "rtweekend.h"
+#include "sampler.h"
+#include "thread_pool.h"
+#include "tile_scheduler.h"
+#include "triangle_mesh.h"
+#include "wavefront_integrator.h"
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <functional>
 #include <iostream>
 #include <memory>
-#include <thread>
 #include <vector>
 
+// 按时间预算渲染时单个像素的样本数上限，只用于防止计数溢出
+constexpr int kTimeBudgetMaxSamples = 1 << 24;
+
 class Renderer {
   public:
     struct Settings {
         int samples_per_pixel = 10;
+        // 渐进模式按每遍 samples_per_pass 个样本渲染整帧，
+        // 否则一遍渲染完全部 samples_per_pixel
+        bool progressive = false;
+        int samples_per_pass = 1;
+        // 自适应采样：像素至少采 adaptive_min_samples 个样本后，
+        // 相对误差低于 adaptive_threshold 即停止；省下的预算
+        // (samples_per_pixel x 像素数) 继续分给未收敛的像素，
+        // 单个像素最多 adaptive_max_factor 倍 samples_per_pixel
+        bool adaptive = false;
+        double adaptive_threshold = 0.02;
+        int adaptive_min_samples = 16;
+        int adaptive_max_factor = 8;
+        // 随机流的种子。每个像素样本的随机数只由 (像素, 样本序号, seed)
+        // 决定，结果与线程数、tile 的执行顺序无关，可以逐位比较
+        uint64_t seed = 0;
+        // 只渲染 [region_x0, region_x1) x [region_y0, region_y1) 内的像素，
+        // x1 / y1 小于 0 表示到图像边缘。各像素的结果与区域划分无关，
+        // 一帧可以拆成多个区域分到不同机器上渲染后拼接；
+        // 自适应采样的样本预算在区域内统筹，开启时拆分渲染的结果会不同
+        int region_x0 = 0;
+        int region_y0 = 0;
+        int region_x1 = -1;
+        int region_y1 = -1;
+        // 时间预算 (秒)：大于 0 时不再以 samples_per_pixel 为样本上限，
+        // 每遍给整帧追加 samples_per_pass 个样本，按上一遍的耗时预计
+        // 下一遍会超出预算时停止，至少渲染一遍
+        double time_budget = 0.0;
+        // 噪声目标：大于 0 时，区域内像素的平均相对标准误差降到该值以下
+        // 即停止，样本预算或时间预算没有用完也一样
+        double noise_target = 0.0;
+    };
+
+    // 最近一次渲染的统计
+    struct Stats {
+        double seconds = 0.0;
+        int passes = 0;
+        double samples_per_pixel = 0.0; // 区域内每像素的平均样本数
+        double noise = infinity;        // 区域内像素的平均相对标准误差
     };
 
-    Renderer() : m_is_rendering(false) {
+    // 每完成一遍调用一次，参数为当前每像素平均累积的样本数
+    using PassCallback = std::function<void(int samples)>;
+
+    // num_threads 为 0 时使用全部硬件线程；线程池在 Renderer 的整个生命周期内
+    // 常驻，多次 render 调用、BVH 构建和图像输出都复用同一组线程
+    explicit Renderer(int num_threads = 0, bool pin_threads = false)
+        : m_is_rendering(false),
+          m_pool(new thread_pool(num_threads, pin_threads)),
+          m_sampler(new IndependentSampler()) {
+    }
+    ~Renderer() {
+        retarget_build_pools(m_pool.get(), nullptr);
+    }
+
+    // 按新的线程数和 CPU 绑定方式重建线程池，不能在渲染过程中调用。
+    // 指向旧线程池的 BVH 默认构建选项会改为指向新线程池
+    void set_threads(int num_threads, bool pin_threads = false) {
+        thread_pool *old_pool = m_pool.get();
+        m_pool.reset();
+        m_pool.reset(new thread_pool(num_threads, pin_threads));
+        retarget_build_pools(old_pool, m_pool.get());
+    }
+    thread_pool &pool() {
+        return *m_pool;
     }
 
     void set_integrator(std::shared_ptr<Integrator> integrator) {
         m_integrator = integrator;
     }
 
+    // 样本生成器的原型，每个 tile 使用它的一个副本
+    void set_sampler(std::unique_ptr<Sampler> sampler) {
+        m_sampler = std::move(sampler);
+    }
+
     void render(shared_ptr<hittable> world, shared_ptr<camera> cam,
                 const color &background, RenderBuffer &target_buffer,
                 const std::vector<shared_ptr<Light>> &lights = {}) {
@@ -37,73 +113,347 @@ class Renderer {
         int image_width = target_buffer.width();
         int image_height = target_buffer.height();
 
-        constexpr int TILE_SIZE = 16;
+        const bool adaptive = m_settings.adaptive;
+        const bool time_budgeted = m_settings.time_budget > 0.0;
+        const bool noise_targeted = m_settings.noise_target > 0.0;
+        const int total_samples =
+            time_budgeted ? kTimeBudgetMaxSamples
+                          : m_settings.samples_per_pixel;
+        const int samples_per_pass =
+            m_settings.progressive || adaptive || time_budgeted ||
+                    noise_targeted
+                ? std::max(1, std::min(m_settings.samples_per_pass,
+                                       total_samples))
+                : total_samples;
+        const int max_samples =
+            adaptive && !time_budgeted
+                ? total_samples * std::max(1, m_settings.adaptive_max_factor)
+                : total_samples;
+        const int region_x0 = std::max(m_settings.region_x0, 0);
+        const int region_y0 = std::max(m_settings.region_y0, 0);
+        const int region_x1 = m_settings.region_x1 < 0
+                                  ? image_width
+                                  : std::min(m_settings.region_x1, image_width);
+        const int region_y1 =
+            m_settings.region_y1 < 0
+                ? image_height
+                : std::min(m_settings.region_y1, image_height);
+        if (region_x0 >= region_x1 || region_y0 >= region_y1) {
+            std::cerr << "Renderer: empty render region" << std::endl;
+            m_is_rendering = false;
+            return;
+        }
+        const uint64_t pixel_count =
+            static_cast<uint64_t>(region_x1 - region_x0) *
+            (region_y1 - region_y0);
+        const uint64_t sample_budget = pixel_count * total_samples;
+        m_accumulation.reset(image_width, image_height);
+
+        // AOV 只在目标缓冲开启了对应平面时才计算，否则走普通的 Li
+        const bool record_features = target_buffer.has_feature_aovs();
+        const bool record_statistics =
+            target_buffer.has_aov(Aov::sample_count) ||
+            target_buffer.has_aov(Aov::variance);
 
-        int tiles_x = (image_width + TILE_SIZE - 1) / TILE_SIZE;
-        int tiles_y = (image_height + TILE_SIZE - 1) / TILE_SIZE;
-        int total_tiles = tiles_x * tiles_y;
+        // 像素是否还需要继续采样
+        auto needs_samples = [&](int i, int j) {
+            int n = m_accumulation.samples(i, j);
+            if (n >= max_samples) {
+                return false;
+            }
+            return !adaptive || n < m_settings.adaptive_min_samples ||
+                   m_accumulation.relative_error(i, j) >=
+                       m_settings.adaptive_threshold;
+        };
+
+        // 波前积分器整批追踪路径，其他积分器逐条调用 Li
+        auto wavefront =
+            std::dynamic_pointer_cast<WavefrontPathIntegrator>(m_integrator);
+        if (wavefront) {
+            wavefront->reset_stats();
+        }
 
-        std::atomic<int> next_tile_index(0);
+        // 每个 tile 累积完一遍后立即把平均值写回显示缓冲，
+        // 因此任意时刻停止都能得到整幅均匀收敛的图像
+        std::atomic<uint64_t> samples_spent(0);
+        std::atomic<int> pending_pixels(0);
+        auto render_tile = [&](const TileRect &tile) {
+            if (!m_is_rendering) {
+                return;
+            }
 
-        const int num_threads = std::thread::hardware_concurrency();
-        std::vector<std::thread> threads;
+            const int x_start = tile.x0;
+            const int y_start = tile.y0;
+            const int x_end = tile.x1;
+            const int y_end = tile.y1;
 
-        auto render_worker = [&]() {
-            while (true) {
-                int tile_index = next_tile_index.fetch_add(1);
-                if (tile_index >= total_tiles) {
-                    break;
+            uint64_t tile_samples = 0;
+            int tile_pending = 0;
+            std::unique_ptr<Sampler> sampler = m_sampler->clone();
+
+            // 一个像素的一批样本追踪完后，累积并写回显示缓冲和 AOV
+            auto finish_pixel = [&](int i, int j, const color &pixel_color,
+                                    double luminance_sq,
+                                    const FeatureBatch &features,
+                                    int first_sample, int pass_samples) {
+                m_accumulation.add(i, j, pixel_color, luminance_sq,
+                                   pass_samples);
+                write_color_to_buffer(target_buffer, i, j,
+                                      m_accumulation.mean(i, j));
+                if (record_features) {
+                    write_feature_aovs(target_buffer, i, j, features,
+                                       first_sample, pass_samples);
                 }
-                if (!m_is_rendering) {
-                    break;
+                if (record_statistics) {
+                    write_statistic_aovs(target_buffer, i, j);
                 }
+                tile_samples += pass_samples;
+                tile_pending += needs_samples(i, j) ? 1 : 0;
+            };
 
-                int tile_y = (tiles_y - 1) - tile_index / tiles_x;
-                int tile_x = tile_index % tiles_x;
+            // 生成像素样本的主光线并设置该样本的随机流
+            auto camera_ray = [&](int i, int j, int sample_index) {
+                // 样本序号跨遍连续，渐进渲染与一次渲染完的样本序列相同
+                sampler->start_pixel_sample(i, j, sample_index);
+                seed_random_stream(
+                    hash_values(i, j, sample_index, m_settings.seed));
+                vec2 u_pixel = sampler->get_2d();
+                vec2 u_lens = sampler->get_2d();
+                double u_time = sampler->get_1d();
+                auto u = (i + u_pixel.x()) / (image_width - 1);
+                auto v = (j + u_pixel.y()) / (image_height - 1);
+                return cam->get_ray(u, v, u_lens, u_time);
+            };
 
-                int x_start = tile_x * TILE_SIZE;
-                int y_start = tile_y * TILE_SIZE;
-                int x_end = std::min(x_start + TILE_SIZE, image_width);
-                int y_end = std::min(y_start + TILE_SIZE, image_height);
+            if (wavefront) {
+                // 波前模式：先为整块 tile 生成主光线，攒够一批再统一追踪，
+                // 之后按像素、样本序号的顺序累积，与逐条追踪的结果相同
+                static thread_local WavefrontBatch batch;
+                struct BatchPixel {
+                    int i, j, first_sample, samples;
+                };
+                std::vector<BatchPixel> pixels;
+                auto flush = [&]() {
+                    wavefront->trace_batch(batch, *world, background, lights,
+                                           *sampler, record_features);
+                    int path = 0;
+                    for (const BatchPixel &px : pixels) {
+                        color pixel_color(0, 0, 0);
+                        double luminance_sq = 0.0;
+                        FeatureBatch features;
+                        for (int s = 0; s < px.samples; ++s, ++path) {
+                            const color &radiance = batch.radiance[path];
+                            if (record_features) {
+                                features.add(batch.features[path]);
+                            }
+                            double y = luminance(radiance);
+                            pixel_color += radiance;
+                            luminance_sq += y * y;
+                        }
+                        finish_pixel(px.i, px.j, pixel_color, luminance_sq,
+                                     features, px.first_sample, px.samples);
+                    }
+                    pixels.clear();
+                    batch.clear();
+                };
 
+                batch.clear();
                 for (int j = y_end - 1; j >= y_start; j--) {
                     for (int i = x_start; i < x_end; i++) {
-                        color pixel_color(0, 0, 0);
-                        for (int s = 0; s < m_settings.samples_per_pixel; ++s) {
-                            auto u = (i + random_double()) / (image_width - 1);
-                            auto v = (j + random_double()) / (image_height - 1);
-                            ray r = cam->get_ray(u, v);
-                            if (m_integrator) {
-                                pixel_color += m_integrator->Li(
-                                    r, *world, background, lights);
+                        if (!needs_samples(i, j)) {
+                            continue;
+                        }
+                        int pass_samples = std::min(
+                            samples_per_pass,
+                            max_samples - m_accumulation.samples(i, j));
+                        const int first_sample = m_accumulation.samples(i, j);
+                        for (int s = 0; s < pass_samples; ++s) {
+                            ray r = camera_ray(i, j, first_sample + s);
+                            batch.add(r, i, j, first_sample + s,
+                                      thread_random_stream());
+                        }
+                        pixels.push_back({i, j, first_sample, pass_samples});
+                        if (batch.size() >= kWavefrontBatchSize) {
+                            flush();
+                        }
+                    }
+                }
+                if (!pixels.empty()) {
+                    flush();
+                }
+                samples_spent += tile_samples;
+                pending_pixels += tile_pending;
+                return;
+            }
+
+            for (int j = y_end - 1; j >= y_start; j--) {
+                for (int i = x_start; i < x_end; i++) {
+                    if (!needs_samples(i, j)) {
+                        continue;
+                    }
+                    int pass_samples = std::min(
+                        samples_per_pass,
+                        max_samples - m_accumulation.samples(i, j));
+                    color pixel_color(0, 0, 0);
+                    double luminance_sq = 0.0;
+                    FeatureBatch features;
+                    const int first_sample = m_accumulation.samples(i, j);
+                    for (int s = 0; s < pass_samples; ++s) {
+                        ray r = camera_ray(i, j, first_sample + s);
+                        if (m_integrator) {
+                            color radiance;
+                            if (record_features) {
+                                PathFeatures f;
+                                radiance = m_integrator->Li(
+                                    r, *world, background, lights, *sampler, f);
+                                features.add(f);
+                            } else {
+                                radiance = m_integrator->Li(
+                                    r, *world, background, lights, *sampler);
                             }
+                            double y = luminance(radiance);
+                            pixel_color += radiance;
+                            luminance_sq += y * y;
                         }
-                        write_color_to_buffer(target_buffer, i, j, pixel_color,
-                                              m_settings.samples_per_pixel);
                     }
+                    finish_pixel(i, j, pixel_color, luminance_sq, features,
+                                 first_sample, pass_samples);
                 }
             }
+            samples_spent += tile_samples;
+            pending_pixels += tile_pending;
         };
 
-        for (int t = 0; t < num_threads; t++) {
-            threads.emplace_back(render_worker);
-        }
-
-        for (auto &t : threads) {
-            t.join();
+        m_stats = Stats();
+        m_scheduler.reset_stats();
+        const TileRect region = {region_x0, region_y0, region_x1, region_y1};
+        while (m_is_rendering) {
+            pending_pixels = 0;
+            auto pass_start = std::chrono::high_resolution_clock::now();
+            m_scheduler.run(*m_pool, region, render_tile);
+            auto pass_end = std::chrono::high_resolution_clock::now();
+            if (!m_is_rendering) {
+                break;
+            }
+            ++m_stats.passes;
+            if (m_pass_callback) {
+                m_pass_callback(static_cast<int>(samples_spent / pixel_count));
+            }
+            if (pending_pixels == 0 || samples_spent >= sample_budget) {
+                break;
+            }
+            if (noise_targeted &&
+                estimate_noise(region_x0, region_y0, region_x1, region_y1) <
+                    m_settings.noise_target) {
+                break;
+            }
+            if (time_budgeted) {
+                std::chrono::duration<double> elapsed = pass_end - start_time;
+                std::chrono::duration<double> pass = pass_end - pass_start;
+                if (elapsed.count() + pass.count() > m_settings.time_budget) {
+                    break;
+                }
+            }
         }
 
         auto end_time = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> elapsed = end_time - start_time;
 
         m_is_rendering = false;
+        m_stats.seconds = elapsed.count();
+        m_stats.samples_per_pixel =
+            static_cast<double>(samples_spent) / pixel_count;
+        m_stats.noise =
+            estimate_noise(region_x0, region_y0, region_x1, region_y1);
         std::cout << "Rendering finished in " << elapsed.count() << " seconds."
                   << std::endl;
+        if (time_budgeted || noise_targeted) {
+            std::cout << "Budgeted rendering: " << m_stats.samples_per_pixel
+                      << " samples per pixel in " << m_stats.passes
+                      << " passes, estimated noise " << m_stats.noise << "."
+                      << std::endl;
+        }
+        if (adaptive) {
+            std::cout << "Adaptive sampling: "
+                      << static_cast<double>(samples_spent) / pixel_count
+                      << " samples per pixel on average, "
+                      << 100.0 * (pixel_count - pending_pixels) / pixel_count
+                      << "% of pixels converged." << std::endl;
+        }
+        print_scheduling_stats();
     }
 
     void set_samples(int samples) {
         m_settings.samples_per_pixel = samples;
     }
+    void set_progressive(bool enabled, int samples_per_pass = 1) {
+        m_settings.progressive = enabled;
+        m_settings.samples_per_pass = samples_per_pass;
+    }
+    void set_seed(uint64_t seed) {
+        m_settings.seed = seed;
+    }
+    void set_region(int x0, int y0, int x1, int y1) {
+        m_settings.region_x0 = x0;
+        m_settings.region_y0 = y0;
+        m_settings.region_x1 = x1;
+        m_settings.region_y1 = y1;
+    }
+    void set_adaptive(bool enabled, double threshold = 0.02,
+                      int min_samples = 16) {
+        m_settings.adaptive = enabled;
+        m_settings.adaptive_threshold = threshold;
+        m_settings.adaptive_min_samples = min_samples;
+    }
+    // seconds 为 0 时恢复按 samples_per_pixel 渲染
+    void set_time_budget(double seconds, double noise_target = 0.0) {
+        m_settings.time_budget = seconds;
+        m_settings.noise_target = noise_target;
+    }
+    void set_pass_callback(PassCallback callback) {
+        m_pass_callback = std::move(callback);
+    }
+    const Stats &stats() const {
+        return m_stats;
+    }
+    // 最近一次渲染中各线程的忙碌 / 空闲时间、窃取和拆分次数
+    const TileScheduler::Stats &scheduling_stats() const {
+        return m_scheduler.stats();
+    }
+    // 最近一次渲染的线性辐亮度累积结果
+    const AccumulationBuffer &accumulation() const {
+        return m_accumulation;
+    }
+    // 把最近一次渲染的逐像素样本数画成热力图 (蓝 -> 青 -> 绿 -> 黄 -> 红)，
+    // 按最大样本数归一化，用于按场景调节自适应采样的阈值
+    void write_sample_heatmap(RenderBuffer &target) const {
+        const int width = std::min(target.width(), m_accumulation.width());
+        const int height = std::min(target.height(), m_accumulation.height());
+        int max_samples = 1;
+        for (int j = 0; j < height; ++j) {
+            for (int i = 0; i < width; ++i) {
+                max_samples =
+                    std::max(max_samples, m_accumulation.samples(i, j));
+            }
+        }
+
+        static const color stops[] = {color(0, 0, 1), color(0, 1, 1),
+                                      color(0, 1, 0), color(1, 1, 0),
+                                      color(1, 0, 0)};
+        constexpr int kSegments = 4;
+        for (int j = 0; j < height; ++j) {
+            for (int i = 0; i < width; ++i) {
+                double t = kSegments *
+                           static_cast<double>(m_accumulation.samples(i, j)) /
+                           max_samples;
+                int segment = std::min(static_cast<int>(t), kSegments - 1);
+                double f = t - segment;
+                target.store(i, j, (1 - f) * stops[segment] +
+                                       f * stops[segment + 1]);
+            }
+        }
+    }
+
     void set_max_depth(int depth) {
         if (m_integrator) {
             m_integrator->set_max_depth(depth);
@@ -122,21 +472,134 @@ class Renderer {
     std::atomic<bool> m_is_rendering;
 
     std::shared_ptr<Integrator> m_integrator;
+    std::unique_ptr<thread_pool> m_pool;
+    std::unique_ptr<Sampler> m_sampler;
+    AccumulationBuffer m_accumulation;
+    PassCallback m_pass_callback;
+    Stats m_stats;
+    TileScheduler m_scheduler;
+
+    // bvh_node / triangle_mesh 的默认构建选项保存线程池的裸指针，
+    // 线程池重建或销毁时要同步更新，否则会悬空
+    static void retarget_build_pools(thread_pool *from, thread_pool *to) {
+        if (bvh_node::default_options().pool == from) {
+            bvh_node::default_options().pool = to;
+        }
+        if (triangle_mesh::default_options().pool == from) {
+            triangle_mesh::default_options().pool = to;
+        }
+    }
 
+    void print_scheduling_stats() const {
+        const TileScheduler::Stats &stats = m_scheduler.stats();
+        std::cout << "Tile scheduling: " << stats.total_steals()
+                  << " steals, " << stats.total_splits()
+                  << " splits, max idle " << stats.max_idle_seconds()
+                  << " seconds." << std::endl;
+        for (size_t w = 0; w < stats.workers.size(); ++w) {
+            const TileScheduler::WorkerStats &worker = stats.workers[w];
+            std::cout << "  worker " << w << ": busy " << worker.busy_seconds
+                      << " s, idle " << worker.idle_seconds << " s, "
+                      << worker.tiles << " tiles, " << worker.steals
+                      << " steals" << std::endl;
+        }
+    }
+
+    // 区域内像素的平均相对标准误差，样本不足两个的像素为无穷大。
+    // 按行并行求和后再按行序累加，结果与线程数无关
+    double estimate_noise(int x0, int y0, int x1, int y1) {
+        std::vector<double> row_error(y1 - y0, 0.0);
+        m_pool->parallel_for(y1 - y0, [&](int row) {
+            double sum = 0.0;
+            for (int i = x0; i < x1; ++i) {
+                sum += m_accumulation.relative_error(i, y0 + row);
+            }
+            row_error[row] = sum;
+        });
+        double total = 0.0;
+        for (double e : row_error) {
+            total += e;
+        }
+        return total / (static_cast<double>(x1 - x0) * (y1 - y0));
+    }
+
+    // 一个像素一批样本的特征之和
+    struct FeatureBatch {
+        color albedo{0, 0, 0};
+        vec3 normal{0, 0, 0};
+        color emitted{0, 0, 0};
+        color direct{0, 0, 0};
+        color indirect{0, 0, 0};
+        double depth = infinity;
+        uint32_t material_id = 0;
+
+        void add(const PathFeatures &f) {
+            albedo += f.albedo;
+            normal += f.normal;
+            emitted += f.emitted;
+            direct += f.direct;
+            indirect += f.indirect;
+            depth = std::min(depth, f.depth);
+            if (material_id == 0) {
+                material_id = f.material_id;
+            }
+        }
+    };
+
+    // 写入平均线性辐亮度；显示和 LDR 输出时再做 gamma 校正与截断
     void write_color_to_buffer(RenderBuffer &buffer, int x, int y,
-                               color pixel_color, int samples) {
-        auto r = pixel_color.x();
-        auto g = pixel_color.y();
-        auto b = pixel_color.z();
-
-        auto scale = 1.0 / samples;
-        r = sqrt(scale * r);
-        g = sqrt(scale * g);
-        b = sqrt(scale * b);
-
-        buffer.set_pixel(
-            x, y,
-            color(clamp(r, 0.0, 1.0), clamp(g, 0.0, 1.0), clamp(b, 0.0, 1.0)));
+                               color pixel_color) {
+        buffer.store(x, y, pixel_color);
+    }
+
+    // 把 batch 个样本之和并入已有 previous 个样本的平均值
+    static void blend_mean(float *p, const color &sum, int previous,
+                           int batch) {
+        double scale = 1.0 / (previous + batch);
+        for (int c = 0; c < 3; ++c) {
+            double old_sum = previous > 0 ? p[c] * previous : 0.0;
+            p[c] = static_cast<float>((old_sum + sum[c]) * scale);
+        }
+    }
+
+    // 各 AOV 平面的值与累积缓冲一样按样本平均，depth 取最近的交点，
+    // material_id 取第一个命中的样本；previous 为 0 时覆盖上一次渲染的结果
+    static void write_feature_aovs(RenderBuffer &buffer, int x, int y,
+                                   const FeatureBatch &batch, int previous,
+                                   int count) {
+        if (float *row = buffer.aov_row(Aov::albedo, y)) {
+            blend_mean(row + 3 * x, batch.albedo, previous, count);
+        }
+        if (float *row = buffer.aov_row(Aov::normal, y)) {
+            blend_mean(row + 3 * x, batch.normal, previous, count);
+        }
+        if (float *row = buffer.aov_row(Aov::emission, y)) {
+            blend_mean(row + 3 * x, batch.emitted, previous, count);
+        }
+        if (float *row = buffer.aov_row(Aov::direct, y)) {
+            blend_mean(row + 3 * x, batch.direct, previous, count);
+        }
+        if (float *row = buffer.aov_row(Aov::indirect, y)) {
+            blend_mean(row + 3 * x, batch.indirect, previous, count);
+        }
+        if (float *row = buffer.aov_row(Aov::depth, y)) {
+            float depth = static_cast<float>(batch.depth);
+            row[x] = previous > 0 ? std::min(row[x], depth) : depth;
+        }
+        if (float *row = buffer.aov_row(Aov::material_id, y)) {
+            if (previous == 0 || row[x] == 0.0f) {
+                row[x] = static_cast<float>(batch.material_id);
+            }
+        }
+    }
+
+    void write_statistic_aovs(RenderBuffer &buffer, int x, int y) const {
+        if (float *row = buffer.aov_row(Aov::sample_count, y)) {
+            row[x] = static_cast<float>(m_accumulation.samples(x, y));
+        }
+        if (float *row = buffer.aov_row(Aov::variance, y)) {
+            row[x] = static_cast<float>(m_accumulation.variance(x, y));
+        }
     }
 };
 
@@ -20,6 +20,20 @@ class RRPathInterator : public Integrator {
 
     virtual color Li(const ray &r, const hittable &scene,
                      const color &background) const override {
+        IndependentSampler sampler;
+        return trace(r, scene, background, sampler);
+    }
+
+    virtual color Li(const ray &r, const hittable &scene,
+                     const color &background,
+                     const std::vector<shared_ptr<Light>> &lights,
+                     Sampler &sampler) const override {
+        return trace(r, scene, background, sampler);
+    }
+
+  private:
+    color trace(const ray &r, const hittable &scene, const color &background,
+                Sampler &sampler) const {
         color throughput(1.0, 1.0, 1.0);
         color L(0.0, 0.0, 0.0);
         ray current_ray = r;
@@ -35,10 +49,11 @@ class RRPathInterator : public Integrator {
             color emitted = rec.mat_ptr->emitted(rec.u, rec.v, rec.p);
             L += throughput * emitted;
 
+            const BounceSample u = sampler.get_bounce(depth);
             ray scattered;
             color attenuation;
-            if (!rec.mat_ptr->scatter(current_ray, rec, attenuation,
-                                      scattered)) {
+            if (!sample_next_ray(current_ray, rec, u, attenuation,
+                                 scattered)) {
                 break;
             }
             throughput *= attenuation;
@@ -48,7 +63,7 @@ class RRPathInterator : public Integrator {
                     std::max({throughput.x(), throughput.y(), throughput.z()});
                 p_survive = clamp(p_survive, 0.005, 0.95);
 
-                if (random_double() > p_survive) {
+                if (u.russian_roulette > p_survive) {
                     break;
                 }
                 throughput /= p_survive;
@@ -58,7 +73,6 @@ class RRPathInterator : public Integrator {
         return L;
     }
 
-  private:
     int m_max_depth = 50;
     int m_rr_start_depth = 3;
 };
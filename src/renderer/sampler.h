@@ -0,0 +1,333 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "rtweekend.h"
+#include "vec3.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+// 每个相机样本用到的维度：像素内位置 2 + 镜头 2 + 快门时间 1
+constexpr int kCameraSampleDimensions = 5;
+// 每次弹射用到的维度，见 BounceSample
+constexpr int kBounceSampleDimensions = 7;
+
+// 一次弹射用到的全部样本值。每次弹射从固定的维度块开始、按固定顺序取出，
+// 路径上的分支（镜面、没有光源等）不会改变后续弹射的维度分配
+struct BounceSample {
+    double light_select;
+    vec2 light;
+    double lobe;
+    vec2 bsdf;
+    double russian_roulette;
+};
+
+// 哈希值的高 32 位映射到 [0, 1)
+inline double hash_to_double(uint64_t h) {
+    return static_cast<uint32_t>(h >> 32) * 2.3283064365386963e-10;
+}
+
+inline uint32_t reverse_bits(uint32_t x) {
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00ff00ffu) << 8) | ((x & 0xff00ff00u) >> 8);
+    x = ((x & 0x0f0f0f0fu) << 4) | ((x & 0xf0f0f0f0u) >> 4);
+    x = ((x & 0x33333333u) << 2) | ((x & 0xccccccccu) >> 2);
+    x = ((x & 0x55555555u) << 1) | ((x & 0xaaaaaaaau) >> 1);
+    return x;
+}
+
+// Laine-Karras 置换：每一位只受更低位的影响
+inline uint32_t laine_karras_permutation(uint32_t x, uint32_t seed) {
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return x;
+}
+
+// Owen 嵌套均匀置乱的快速近似 (Burley 2020)：
+// 对位反转后的值做 Laine-Karras 置换，再反转回来
+inline uint32_t owen_scramble(uint32_t x, uint32_t seed) {
+    return reverse_bits(laine_karras_permutation(reverse_bits(x), seed));
+}
+
+// Sobol 序列的前两个维度：第 0 维即位反转 (van der Corput)
+inline uint32_t sobol_dimension1(uint32_t index) {
+    uint32_t result = 0;
+    for (uint32_t v = 1u << 31; index; index >>= 1, v ^= v >> 1) {
+        if (index & 1) {
+            result ^= v;
+        }
+    }
+    return result;
+}
+
+// [0, length) 的一个伪随机排列中第 index 个元素 (Kensler 2013)
+inline uint32_t permutation_element(uint32_t index, uint32_t length,
+                                    uint32_t seed) {
+    uint32_t w = length - 1;
+    w |= w >> 1;
+    w |= w >> 2;
+    w |= w >> 4;
+    w |= w >> 8;
+    w |= w >> 16;
+    do {
+        index ^= seed;
+        index *= 0xe170893du;
+        index ^= seed >> 16;
+        index ^= (index & w) >> 4;
+        index ^= seed >> 8;
+        index *= 0x0929eb3fu;
+        index ^= seed >> 23;
+        index ^= (index & w) >> 1;
+        index *= 1 | seed >> 27;
+        index *= 0x6935fa69u;
+        index ^= (index & w) >> 11;
+        index *= 0x74dcb303u;
+        index ^= (index & w) >> 2;
+        index *= 0x9e501cc3u;
+        index ^= (index & w) >> 2;
+        index *= 0xc860a3dfu;
+        index &= w;
+        index ^= index >> 5;
+    } while (index >= length);
+    return (index + seed) % length;
+}
+
+inline double uint32_to_unit(uint32_t x) {
+    // 保证结果严格小于 1
+    return std::min(x * 2.3283064365386963e-10, 0.99999999999999989);
+}
+
+// 样本生成器。渲染器在每个像素样本开始时调用 start_pixel_sample，
+// 相机先取 kCameraSampleDimensions 个维度，积分器在每次弹射开始时
+// 调用 get_bounce 取该次弹射的全部样本值。
+// 每个线程持有自己的副本 (clone)，副本之间不共享状态
+class Sampler {
+  public:
+    virtual ~Sampler() = default;
+
+    virtual void start_pixel_sample(int x, int y, int sample_index) {
+        if (x != m_x || y != m_y || !m_has_pixel) {
+            m_x = x;
+            m_y = y;
+            m_has_pixel = true;
+            m_pixel_hash = hash_values(static_cast<uint32_t>(x),
+                                       static_cast<uint32_t>(y), m_seed);
+        }
+        m_sample_index = sample_index;
+        m_dimension = 0;
+    }
+
+    virtual double get_1d() = 0;
+    virtual vec2 get_2d() = 0;
+
+    // 跳到第 depth 次弹射的维度块并取出该次弹射的全部样本值
+    BounceSample get_bounce(int depth) {
+        m_dimension =
+            kCameraSampleDimensions + depth * kBounceSampleDimensions;
+        BounceSample s;
+        s.light_select = get_1d();
+        s.light = get_2d();
+        s.lobe = get_1d();
+        s.bsdf = get_2d();
+        s.russian_roulette = get_1d();
+        return s;
+    }
+
+    virtual std::unique_ptr<Sampler> clone() const = 0;
+
+  protected:
+    // 像素和维度对应的哈希，用作置乱种子
+    uint64_t dimension_hash(int dimension) const {
+        return mix_bits(m_pixel_hash ^
+                        (static_cast<uint64_t>(dimension) + 1) *
+                            0x9e3779b97f4a7c15ull);
+    }
+
+    int m_x = 0;
+    int m_y = 0;
+    int m_sample_index = 0;
+    int m_dimension = 0;
+    uint64_t m_seed = 0;
+    uint64_t m_pixel_hash = 0; // 当前像素的哈希，同一像素的样本之间复用
+    bool m_has_pixel = false;
+};
+
+// 各维度独立的均匀随机数，即原来直接调用 random_double() 的行为
+class IndependentSampler : public Sampler {
+  public:
+    double get_1d() override {
+        ++m_dimension;
+        return random_double();
+    }
+    vec2 get_2d() override {
+        m_dimension += 2;
+        return vec2(random_double(), random_double());
+    }
+    std::unique_ptr<Sampler> clone() const override {
+        return std::unique_ptr<Sampler>(new IndependentSampler(*this));
+    }
+};
+
+// 分层抖动采样：每个维度把 [0, 1) 分成 samples_per_pixel 层
+// (二维为 sqrt x sqrt 的网格)，各像素、各维度用不同的排列决定
+// 第 i 个样本落在哪一层。样本序号超出 samples_per_pixel 时
+// (自适应采样追加的样本) 退化为独立随机数
+class StratifiedSampler : public Sampler {
+  public:
+    explicit StratifiedSampler(int samples_per_pixel, uint64_t seed = 0)
+        : m_samples_per_pixel(std::max(1, samples_per_pixel)) {
+        m_seed = seed;
+    }
+
+    double get_1d() override {
+        uint64_t h = dimension_hash(m_dimension++);
+        if (m_sample_index >= m_samples_per_pixel) {
+            return hash_to_double(mix_bits(h ^ m_sample_index));
+        }
+        uint32_t stratum = permutation_element(
+            m_sample_index, m_samples_per_pixel, static_cast<uint32_t>(h));
+        double jitter = hash_to_double(mix_bits(h + m_sample_index));
+        return (stratum + jitter) / m_samples_per_pixel;
+    }
+
+    vec2 get_2d() override {
+        uint64_t h = dimension_hash(m_dimension);
+        m_dimension += 2;
+        int n = static_cast<int>(std::sqrt(m_samples_per_pixel));
+        if (m_sample_index >= n * n) {
+            return vec2(hash_to_double(mix_bits(h ^ m_sample_index)),
+                        hash_to_double(mix_bits(h + m_sample_index)));
+        }
+        uint32_t stratum = permutation_element(
+            m_sample_index, n * n, static_cast<uint32_t>(h));
+        uint64_t jitter = mix_bits(h ^ (0x51ed27ull << 32) ^ m_sample_index);
+        return vec2((stratum % n + hash_to_double(jitter)) / n,
+                    (stratum / n + hash_to_double(mix_bits(jitter))) / n);
+    }
+
+    std::unique_ptr<Sampler> clone() const override {
+        return std::unique_ptr<Sampler>(new StratifiedSampler(*this));
+    }
+
+  private:
+    int m_samples_per_pixel;
+};
+
+// Owen 置乱的 Sobol 序列。每个维度 (或维度对) 单独使用 Sobol 的前一 (两) 维，
+// 以像素和维度的哈希为种子打乱样本序号并置乱数值 (pbrt 的 padded Sobol)：
+// 任意前 2^k 个样本在每个维度对上都是分层的，且不需要预先知道样本数，
+// 适合渐进和自适应渲染
+class SobolSampler : public Sampler {
+  public:
+    explicit SobolSampler(uint64_t seed = 0) {
+        m_seed = seed;
+    }
+
+    double get_1d() override {
+        uint64_t h = dimension_hash(m_dimension++);
+        uint32_t index = owen_scramble(static_cast<uint32_t>(m_sample_index),
+                                       static_cast<uint32_t>(h));
+        // 第 0 维是 index 的位反转，置乱时两次反转相互抵消
+        return uint32_to_unit(reverse_bits(
+            laine_karras_permutation(index, static_cast<uint32_t>(h >> 32))));
+    }
+
+    vec2 get_2d() override {
+        uint64_t h = dimension_hash(m_dimension);
+        m_dimension += 2;
+        uint32_t index = owen_scramble(static_cast<uint32_t>(m_sample_index),
+                                       static_cast<uint32_t>(h));
+        uint64_t h2 = mix_bits(h);
+        return vec2(uint32_to_unit(reverse_bits(laine_karras_permutation(
+                        index, static_cast<uint32_t>(h >> 32)))),
+                    uint32_to_unit(owen_scramble(sobol_dimension1(index),
+                                                 static_cast<uint32_t>(h2))));
+    }
+
+    std::unique_ptr<Sampler> clone() const override {
+        return std::unique_ptr<Sampler>(new SobolSampler(*this));
+    }
+};
+
+constexpr int kHaltonDimensions = 32;
+constexpr int kHaltonPrimes[kHaltonDimensions] = {
+    2,  3,  5,  7,  11, 13, 17, 19, 23, 29,  31,  37,  41,  43,  47,  53,
+    59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131};
+
+// 以 base 为底、各位数字经过 Owen 置乱的根式反演：第 k 位数字用
+// 由种子和更高位数字决定的排列重新映射，数字为 0 的高位同样参与置乱，
+// 直到精度达到 2^-24 (float 的精度，更低的位对采样没有影响)
+inline double owen_scrambled_radical_inverse(int base, uint32_t index,
+                                             uint64_t seed) {
+    const double inv_base = 1.0 / base;
+    double inv_base_n = 1.0;
+    uint64_t reversed = 0;
+    while (inv_base_n > 5.9604644775390625e-08) {
+        uint32_t next = index / base;
+        uint32_t digit = index - next * base;
+        uint32_t digit_hash = static_cast<uint32_t>(mix_bits(seed ^ reversed));
+        digit = permutation_element(digit, base, digit_hash);
+        reversed = reversed * base + digit;
+        inv_base_n *= inv_base;
+        index = next;
+    }
+    return std::min(reversed * inv_base_n, 0.99999999999999989);
+}
+
+// Halton 序列，第 d 维以第 d 个素数为底。各像素、各维度以哈希为种子
+// 置乱每一位数字：只做整体平移时，底数较大的维度在样本数较少时
+// 近乎线性相关。超出素数表的维度使用哈希随机数
+class HaltonSampler : public Sampler {
+  public:
+    explicit HaltonSampler(uint64_t seed = 0) {
+        m_seed = seed;
+    }
+
+    double get_1d() override {
+        return sample_dimension(m_dimension++);
+    }
+
+    vec2 get_2d() override {
+        double a = sample_dimension(m_dimension++);
+        double b = sample_dimension(m_dimension++);
+        return vec2(a, b);
+    }
+
+    std::unique_ptr<Sampler> clone() const override {
+        return std::unique_ptr<Sampler>(new HaltonSampler(*this));
+    }
+
+  private:
+    double sample_dimension(int dimension) const {
+        uint64_t h = dimension_hash(dimension);
+        if (dimension >= kHaltonDimensions) {
+            return hash_to_double(mix_bits(h ^ m_sample_index));
+        }
+        return owen_scrambled_radical_inverse(
+            kHaltonPrimes[dimension], static_cast<uint32_t>(m_sample_index), h);
+    }
+};
+
+enum class SamplerType { independent, stratified, sobol, halton };
+
+inline std::unique_ptr<Sampler> make_sampler(SamplerType type,
+                                             int samples_per_pixel,
+                                             uint64_t seed = 0) {
+    switch (type) {
+    case SamplerType::stratified:
+        return std::unique_ptr<Sampler>(
+            new StratifiedSampler(samples_per_pixel, seed));
+    case SamplerType::sobol:
+        return std::unique_ptr<Sampler>(new SobolSampler(seed));
+    case SamplerType::halton:
+        return std::unique_ptr<Sampler>(new HaltonSampler(seed));
+    default:
+        return std::unique_ptr<Sampler>(new IndependentSampler());
+    }
+}
+
+#endif
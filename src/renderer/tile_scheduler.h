@@ -0,0 +1,268 @@
+#ifndef TILE_SCHEDULER_H
+#define TILE_SCHEDULER_H
+
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 图像上的一块像素区域 [x0, x1) x [y0, y1)
+struct TileRect {
+    int x0, y0, x1, y1;
+
+    int width() const {
+        return x1 - x0;
+    }
+    int height() const {
+        return y1 - y0;
+    }
+};
+
+// Hilbert 曲线上第 d 个点在 n x n 网格中的坐标，n 为 2 的幂
+inline void hilbert_point(int n, int d, int &x, int &y) {
+    x = y = 0;
+    for (int s = 1; s < n; s *= 2) {
+        int rx = 1 & (d / 2);
+        int ry = 1 & (d ^ rx);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+        x += s * rx;
+        y += s * ry;
+        d /= 4;
+    }
+}
+
+// 按 Hilbert 曲线顺序切分区域得到的 tile，相邻的 tile 在图像上也相邻，
+// 连续渲染时访问的 BVH 节点和纹理大体相同
+inline std::vector<TileRect> hilbert_tiles(const TileRect &region,
+                                           int tile_size) {
+    int tiles_x = (region.width() + tile_size - 1) / tile_size;
+    int tiles_y = (region.height() + tile_size - 1) / tile_size;
+    int n = 1;
+    while (n < tiles_x || n < tiles_y) {
+        n *= 2;
+    }
+    std::vector<TileRect> tiles;
+    tiles.reserve(static_cast<size_t>(tiles_x) * tiles_y);
+    for (int d = 0; d < n * n; ++d) {
+        int tx, ty;
+        hilbert_point(n, d, tx, ty);
+        if (tx >= tiles_x || ty >= tiles_y) {
+            continue;
+        }
+        // 曲线从图像顶部开始，与窗口中自上而下的显示顺序一致
+        int x0 = region.x0 + tx * tile_size;
+        int y1 = region.y1 - ty * tile_size;
+        tiles.push_back({x0, std::max(y1 - tile_size, region.y0),
+                         std::min(x0 + tile_size, region.x1), y1});
+    }
+    return tiles;
+}
+
+// 工作窃取的 tile 调度器。每一遍先把 Hilbert 顺序的 tile 按连续的段
+// 分给各个线程的双端队列：线程从自己队列的前端取 tile，
+// 自己的队列空了再从其他线程队列的后端窃取，两端相距最远，局部性最好。
+// 排队的 tile 少于线程数时，取出的 tile 先四等分 (不小于 min_tile_size)，
+// 留下的子 tile 供空闲线程窃取，避免最后一个大 tile 拖住整遍渲染。
+// 像素的结果只取决于像素本身，与 tile 的划分和执行顺序无关
+class TileScheduler {
+  public:
+    // 每个工作槽 (parallel_for 的一个下标，通常对应一个线程) 的累计统计
+    struct WorkerStats {
+        double busy_seconds = 0.0; // 执行 tile 的时间
+        double idle_seconds = 0.0; // 每遍总时间中没有执行 tile 的时间
+        int tiles = 0;
+        int steals = 0;
+        int splits = 0;
+    };
+    struct Stats {
+        std::vector<WorkerStats> workers;
+
+        double max_idle_seconds() const {
+            double idle = 0.0;
+            for (const WorkerStats &w : workers) {
+                idle = std::max(idle, w.idle_seconds);
+            }
+            return idle;
+        }
+        int total_steals() const {
+            int steals = 0;
+            for (const WorkerStats &w : workers) {
+                steals += w.steals;
+            }
+            return steals;
+        }
+        int total_splits() const {
+            int splits = 0;
+            for (const WorkerStats &w : workers) {
+                splits += w.splits;
+            }
+            return splits;
+        }
+    };
+
+    explicit TileScheduler(int tile_size = 16, int min_tile_size = 4)
+        : m_tile_size(std::max(1, tile_size)),
+          m_min_tile_size(std::max(1, min_tile_size)) {
+    }
+
+    // 对 region 内的每个 tile 调用 fn(const TileRect &)，全部完成后返回
+    template <typename F>
+    void run(thread_pool &pool, const TileRect &region, F &&fn);
+
+    const Stats &stats() const {
+        return m_stats;
+    }
+    void reset_stats() {
+        m_stats.workers.clear();
+    }
+
+  private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<TileRect> tiles;
+    };
+
+    bool pop_local(int worker, TileRect &tile);
+    bool steal(int worker, TileRect &tile);
+    void split_if_needed(int worker, TileRect &tile);
+
+    int m_tile_size;
+    int m_min_tile_size;
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    // 还在队列中的 tile 数，以及排队和执行中的 tile 总数
+    std::atomic<int> m_queued{0};
+    std::atomic<int> m_pending{0};
+    Stats m_stats;
+};
+
+template <typename F>
+inline void TileScheduler::run(thread_pool &pool, const TileRect &region,
+                               F &&fn) {
+    using clock = std::chrono::high_resolution_clock;
+    const int workers = pool.size();
+    if (static_cast<int>(m_queues.size()) != workers) {
+        m_queues.clear();
+        for (int w = 0; w < workers; ++w) {
+            m_queues.emplace_back(new WorkerQueue());
+        }
+    }
+    if (static_cast<int>(m_stats.workers.size()) != workers) {
+        m_stats.workers.assign(workers, WorkerStats());
+    }
+
+    std::vector<TileRect> tiles = hilbert_tiles(region, m_tile_size);
+    const int count = static_cast<int>(tiles.size());
+    for (int k = 0; k < count; ++k) {
+        int owner = static_cast<int>(static_cast<long long>(k) * workers /
+                                     count);
+        m_queues[owner]->tiles.push_back(tiles[k]);
+    }
+    m_queued = count;
+    m_pending = count;
+
+    std::vector<double> busy(workers, 0.0);
+    auto pass_start = clock::now();
+    pool.parallel_for(workers, [&](int worker) {
+        TileRect tile;
+        while (m_pending.load() > 0) {
+            if (!pop_local(worker, tile) && !steal(worker, tile)) {
+                // 其他线程还可能拆分出新的子 tile
+                std::this_thread::yield();
+                continue;
+            }
+            split_if_needed(worker, tile);
+            auto tile_start = clock::now();
+            fn(tile);
+            std::chrono::duration<double> elapsed = clock::now() - tile_start;
+            busy[worker] += elapsed.count();
+            ++m_stats.workers[worker].tiles;
+            m_pending.fetch_sub(1);
+        }
+    });
+    std::chrono::duration<double> pass = clock::now() - pass_start;
+
+    for (int w = 0; w < workers; ++w) {
+        m_stats.workers[w].busy_seconds += busy[w];
+        m_stats.workers[w].idle_seconds +=
+            std::max(0.0, pass.count() - busy[w]);
+    }
+}
+
+inline bool TileScheduler::pop_local(int worker, TileRect &tile) {
+    WorkerQueue &queue = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tiles.empty()) {
+        return false;
+    }
+    tile = queue.tiles.front();
+    queue.tiles.pop_front();
+    m_queued.fetch_sub(1);
+    return true;
+}
+
+inline bool TileScheduler::steal(int worker, TileRect &tile) {
+    const int workers = static_cast<int>(m_queues.size());
+    for (int k = 1; k < workers; ++k) {
+        WorkerQueue &queue = *m_queues[(worker + k) % workers];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tiles.empty()) {
+            continue;
+        }
+        tile = queue.tiles.back();
+        queue.tiles.pop_back();
+        m_queued.fetch_sub(1);
+        ++m_stats.workers[worker].steals;
+        return true;
+    }
+    return false;
+}
+
+inline void TileScheduler::split_if_needed(int worker, TileRect &tile) {
+    const int workers = static_cast<int>(m_queues.size());
+    const bool split_x = tile.width() >= 2 * m_min_tile_size;
+    const bool split_y = tile.height() >= 2 * m_min_tile_size;
+    if (workers < 2 || m_queued.load() >= workers || (!split_x && !split_y)) {
+        return;
+    }
+
+    int xs[3] = {tile.x0, split_x ? tile.x0 + tile.width() / 2 : tile.x1,
+                 tile.x1};
+    int ys[3] = {tile.y0, split_y ? tile.y0 + tile.height() / 2 : tile.y1,
+                 tile.y1};
+    std::vector<TileRect> parts;
+    for (int b = 0; b < 2; ++b) {
+        for (int a = 0; a < 2; ++a) {
+            if (xs[a] < xs[a + 1] && ys[b] < ys[b + 1]) {
+                parts.push_back({xs[a], ys[b], xs[a + 1], ys[b + 1]});
+            }
+        }
+    }
+
+    // 自己继续处理第一块，其余放回队列前端，队列中只剩它们时才会被窃取
+    tile = parts[0];
+    const int extra = static_cast<int>(parts.size()) - 1;
+    m_pending.fetch_add(extra);
+    WorkerQueue &queue = *m_queues[worker];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (int k = extra; k >= 1; --k) {
+            queue.tiles.push_front(parts[k]);
+        }
+    }
+    m_queued.fetch_add(extra);
+    ++m_stats.workers[worker].splits;
+}
+
+#endif
@@ -0,0 +1,713 @@
+#ifndef WAVEFRONT_INTEGRATOR_H
+#define WAVEFRONT_INTEGRATOR_H
+
+#include "integrator.h"
+#include "light.h"
+#include "mis_path_integrator.h"
+#include "rtweekend.h"
+#include "sampler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// 渲染器每攒够这么多条路径就交给波前积分器追踪一次
+constexpr int kWavefrontBatchSize = 4096;
+
+// 波前追踪每次弹射依次经过的阶段
+enum class WavefrontStage { intersect, miss, shade, shadow, scatter };
+constexpr int kWavefrontStageCount = 5;
+
+inline const char *wavefront_stage_name(WavefrontStage stage) {
+    switch (stage) {
+    case WavefrontStage::intersect:
+        return "intersect";
+    case WavefrontStage::miss:
+        return "miss";
+    case WavefrontStage::shade:
+        return "shade";
+    case WavefrontStage::shadow:
+        return "shadow";
+    case WavefrontStage::scatter:
+        return "scatter";
+    }
+    return "";
+}
+
+// 一批路径的状态，按结构数组 (SoA) 存储，下标为路径编号。
+// 渲染器用 add 填入主光线、像素、样本序号和相机采样之后的随机流，
+// 追踪结束后从 radiance (和 features) 读出结果。
+// 各阶段的队列只存路径编号，排序时不搬动路径状态
+struct WavefrontBatch {
+    // 当前光线
+    std::vector<double> origin_x, origin_y, origin_z;
+    std::vector<double> direction_x, direction_y, direction_z;
+    std::vector<double> time;
+    // 路径来源
+    std::vector<int> pixel_x, pixel_y, sample_index;
+    std::vector<random_stream> rng;
+    // 路径状态
+    std::vector<color> throughput;
+    std::vector<color> radiance;
+    std::vector<double> prev_bsdf_pdf;
+    std::vector<char> specular_bounce;
+    std::vector<hit_record> rec;
+    std::vector<BounceSample> u;
+    std::vector<LightSample> light_sample;
+    std::vector<int> light_index;
+    std::vector<char> occluded;
+    std::vector<PathFeatures> features; // 只在需要 AOV 时填写
+    // 各阶段的工作队列
+    std::vector<int> active, next, hits, misses, shadow;
+    std::vector<std::pair<uint64_t, int>> sort_keys;
+
+    int size() const {
+        return static_cast<int>(pixel_x.size());
+    }
+
+    void clear() {
+        for (std::vector<double> *v :
+             {&origin_x, &origin_y, &origin_z, &direction_x, &direction_y,
+              &direction_z, &time}) {
+            v->clear();
+        }
+        pixel_x.clear();
+        pixel_y.clear();
+        sample_index.clear();
+        rng.clear();
+    }
+
+    void add(const ray &r, int x, int y, int sample, const random_stream &s) {
+        set_ray(size(), r, true);
+        pixel_x.push_back(x);
+        pixel_y.push_back(y);
+        sample_index.push_back(sample);
+        rng.push_back(s);
+    }
+
+    ray current_ray(int path) const {
+        return ray(point3(origin_x[path], origin_y[path], origin_z[path]),
+                   vec3(direction_x[path], direction_y[path],
+                        direction_z[path]),
+                   time[path]);
+    }
+
+    void set_ray(int path, const ray &r, bool append = false) {
+        const point3 o = r.origin();
+        const vec3 d = r.direction();
+        if (append) {
+            origin_x.push_back(o.x());
+            origin_y.push_back(o.y());
+            origin_z.push_back(o.z());
+            direction_x.push_back(d.x());
+            direction_y.push_back(d.y());
+            direction_z.push_back(d.z());
+            time.push_back(r.time());
+            return;
+        }
+        origin_x[path] = o.x();
+        origin_y[path] = o.y();
+        origin_z[path] = o.z();
+        direction_x[path] = d.x();
+        direction_y[path] = d.y();
+        direction_z[path] = d.z();
+        time[path] = r.time();
+    }
+};
+
+// 波前 (广度优先) 路径追踪：一批路径按阶段推进，每次弹射先对所有存活路径
+// 求交，再处理未命中的路径、按材质分组着色并采样光源、统一做阴影测试，
+// 最后采样 BSDF 生成下一批光线。求交前可按方向卦限和起点的 Morton 码
+// 排序，着色前可按材质排序，使相邻的光线访问相近的 BVH 节点和相同的材质。
+// 每条路径保存自己的随机流，且与 MISPathIntegrator 以相同的顺序消耗
+// 样本和随机数，因此结果与逐条追踪逐位相同，与排序方式无关。
+// 单条光线的 Li 沿用 MISPathIntegrator 的实现
+class WavefrontPathIntegrator : public MISPathIntegrator {
+  public:
+    // 单个阶段的累计耗时、处理数量和相干度：求交、未命中、阴影阶段为
+    // 相邻两条光线方向夹角余弦的平均值，着色、散射阶段为相邻两条路径
+    // 材质相同的比例，越接近 1 越相干
+    struct StageStats {
+        double seconds = 0.0;
+        uint64_t items = 0;
+        double coherence_sum = 0.0;
+        uint64_t coherence_pairs = 0;
+
+        double coherence() const {
+            return coherence_pairs > 0 ? coherence_sum / coherence_pairs : 0.0;
+        }
+    };
+    struct Stats {
+        StageStats stages[kWavefrontStageCount];
+        double sort_seconds = 0.0;
+        uint64_t batches = 0;
+        // 光线包遍历的计数，按路径的弹射次数 (不是 BVH 层级) 分别统计
+        // 主光线和阴影光线；BVH 各层的访问都累加在同一项中
+        std::vector<ray_packet_stats> camera_packets_by_bounce;
+        std::vector<ray_packet_stats> shadow_packets_by_bounce;
+    };
+
+    WavefrontPathIntegrator() = default;
+
+    // sort_rays: 求交前按方向和起点排序；sort_materials: 着色前按材质排序
+    void set_sorting(bool sort_rays, bool sort_materials) {
+        m_sort_rays = sort_rays;
+        m_sort_materials = sort_materials;
+    }
+
+    // 主光线和射向同一光源的阴影光线每 packet_size 条组成一个光线包遍历，
+    // 0 表示逐条遍历。包遍历访问图元的顺序不同，交点距离完全相同
+    // 或场景含体积介质时，结果可能与逐条追踪有细微差别
+    void set_packet_size(int packet_size) {
+        m_packet_size = std::max(0, std::min(packet_size, kMaxRayPacketSize));
+    }
+
+    // 追踪 batch 中的全部路径，结果写入 batch.radiance；
+    // record_features 为 true 时同时写入 batch.features
+    void trace_batch(WavefrontBatch &batch, const hittable &scene,
+                     const color &background,
+                     const std::vector<shared_ptr<Light>> &lights,
+                     Sampler &sampler, bool record_features) const;
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+        return m_stats;
+    }
+    void reset_stats() {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+        m_stats = Stats();
+    }
+    void print_stats(std::ostream &out) const {
+        Stats stats = this->stats();
+        out << "Wavefront: " << stats.batches << " batches, sorting "
+            << stats.sort_seconds << " seconds." << std::endl;
+        for (int s = 0; s < kWavefrontStageCount; ++s) {
+            const StageStats &stage = stats.stages[s];
+            out << "  " << wavefront_stage_name(static_cast<WavefrontStage>(s))
+                << ": " << stage.items << " items, " << stage.seconds
+                << " seconds, coherence " << stage.coherence() << std::endl;
+        }
+        auto print_packets = [&out](const char *name,
+                                    const std::vector<ray_packet_stats> &v) {
+            for (size_t bounce = 0; bounce < v.size(); ++bounce) {
+                if (v[bounce].lane_slots == 0) {
+                    continue;
+                }
+                out << "  " << name << " packets, bounce " << bounce
+                    << ": active lanes " << v[bounce].active_ratio() << ", "
+                    << v[bounce].node_visits << " node visits, "
+                    << v[bounce].fallback_rays << " single-ray fallbacks"
+                    << std::endl;
+            }
+        };
+        print_packets("camera", stats.camera_packets_by_bounce);
+        print_packets("shadow", stats.shadow_packets_by_bounce);
+    }
+
+  private:
+    // 把 count 条路径按顺序切成不超过 m_packet_size 条的光线包，
+    // 对每个包调用 fn(paths, n)
+    template <typename F>
+    void for_each_packet(const int *paths, size_t count, F &&fn) const {
+        for (size_t begin = 0; begin < count; begin += m_packet_size) {
+            int n = static_cast<int>(
+                std::min(count - begin, static_cast<size_t>(m_packet_size)));
+            fn(paths + begin, n);
+        }
+    }
+
+    void sort_by_ray(WavefrontBatch &batch, std::vector<int> &queue) const;
+    void sort_by_material(WavefrontBatch &batch,
+                          std::vector<int> &queue) const;
+    static void add_direction_coherence(StageStats &stats,
+                                        const WavefrontBatch &batch,
+                                        const std::vector<int> &queue);
+    static void add_material_coherence(StageStats &stats,
+                                       const WavefrontBatch &batch,
+                                       const std::vector<int> &queue);
+
+    // 场景较小时排序的开销大于收益，默认关闭
+    bool m_sort_rays = false;
+    bool m_sort_materials = false;
+    int m_packet_size = 0;
+    mutable std::mutex m_stats_mutex;
+    mutable Stats m_stats;
+};
+
+inline void WavefrontPathIntegrator::trace_batch(
+    WavefrontBatch &batch, const hittable &scene, const color &background,
+    const std::vector<shared_ptr<Light>> &lights, Sampler &sampler,
+    bool record_features) const {
+    using clock = std::chrono::high_resolution_clock;
+    const int count = batch.size();
+    batch.throughput.assign(count, color(1.0, 1.0, 1.0));
+    batch.radiance.assign(count, color(0.0, 0.0, 0.0));
+    batch.prev_bsdf_pdf.assign(count, 0.0);
+    batch.specular_bounce.assign(count, 0);
+    batch.rec.resize(count);
+    batch.u.resize(count);
+    batch.light_sample.resize(count);
+    batch.light_index.resize(count);
+    batch.occluded.resize(count);
+    if (record_features) {
+        batch.features.assign(count, PathFeatures());
+    }
+    batch.active.resize(count);
+    for (int p = 0; p < count; ++p) {
+        batch.active[p] = p;
+    }
+
+    Stats local;
+    local.batches = 1;
+    // 切换到第 p 条路径的随机流，处理完后写回
+    random_stream &stream = thread_random_stream();
+    const random_stream saved_stream = stream;
+    auto stage_time = [](clock::time_point start) {
+        std::chrono::duration<double> elapsed = clock::now() - start;
+        return elapsed.count();
+    };
+
+    for (int depth = 0; depth < m_max_depth && !batch.active.empty();
+         ++depth) {
+        if (m_sort_rays) {
+            auto start = clock::now();
+            sort_by_ray(batch, batch.active);
+            local.sort_seconds += stage_time(start);
+        }
+
+        // 求交
+        StageStats &intersect =
+            local.stages[static_cast<int>(WavefrontStage::intersect)];
+        auto start = clock::now();
+        batch.hits.clear();
+        batch.misses.clear();
+        if (depth == 0 && m_packet_size > 0) {
+            // 主光线按队列顺序成包，相邻的光线来自同一块 tile
+            if (local.camera_packets_by_bounce.empty()) {
+                local.camera_packets_by_bounce.resize(1);
+            }
+            auto trace_packet = [&](const int *paths, int n) {
+                ray rays[kMaxRayPacketSize];
+                double t_max[kMaxRayPacketSize] = {};
+                hit_record recs[kMaxRayPacketSize];
+                bool hit[kMaxRayPacketSize];
+                random_stream streams[kMaxRayPacketSize];
+                for (int i = 0; i < n; ++i) {
+                    rays[i] = batch.current_ray(paths[i]);
+                    t_max[i] = infinity;
+                    streams[i] = batch.rng[paths[i]];
+                }
+                scene.hit_packet(rays, n, 0.001, t_max, recs, hit, streams,
+                                 &local.camera_packets_by_bounce[0]);
+                for (int i = 0; i < n; ++i) {
+                    batch.rng[paths[i]] = streams[i];
+                    batch.rec[paths[i]] = recs[i];
+                    (hit[i] ? batch.hits : batch.misses).push_back(paths[i]);
+                }
+            };
+            for_each_packet(batch.active.data(), batch.active.size(),
+                            trace_packet);
+        } else {
+            for (int p : batch.active) {
+                stream = batch.rng[p];
+                bool hit = scene.hit(batch.current_ray(p), 0.001, infinity,
+                                     batch.rec[p]);
+                batch.rng[p] = stream;
+                (hit ? batch.hits : batch.misses).push_back(p);
+            }
+        }
+        intersect.seconds += stage_time(start);
+        intersect.items += batch.active.size();
+        add_direction_coherence(intersect, batch, batch.active);
+
+        // 未命中：背景或环境光
+        StageStats &miss = local.stages[static_cast<int>(WavefrontStage::miss)];
+        start = clock::now();
+        for (int p : batch.misses) {
+            const ray current_ray = batch.current_ray(p);
+            const color &throughput = batch.throughput[p];
+            color env_L(0, 0, 0);
+            bool found_env = false;
+            for (const auto &light : lights) {
+                if (light->is_infinite()) {
+                    env_L += light->Le(current_ray);
+                    found_env = true;
+                }
+            }
+
+            color L_env(0, 0, 0);
+            if (!found_env) {
+                L_env = throughput * background;
+            } else if (depth == 0 || batch.specular_bounce[p]) {
+                L_env = throughput * env_L;
+            } else {
+                double light_pdf = 0.0;
+                double light_select_pdf = 1.0 / lights.size();
+                for (const auto &light : lights) {
+                    light_pdf += light->pdf(current_ray.origin(),
+                                            current_ray.direction()) *
+                                 light_select_pdf;
+                }
+                double mis_weight =
+                    power_heuristic(batch.prev_bsdf_pdf[p], light_pdf);
+                L_env = throughput * env_L * mis_weight;
+            }
+            batch.radiance[p] += L_env;
+            if (record_features) {
+                batch.features[p].add_contribution(depth, L_env);
+            }
+        }
+        miss.seconds += stage_time(start);
+        miss.items += batch.misses.size();
+        add_direction_coherence(miss, batch, batch.misses);
+
+        if (m_sort_materials) {
+            auto sort_start = clock::now();
+            sort_by_material(batch, batch.hits);
+            local.sort_seconds += stage_time(sort_start);
+        }
+
+        // 着色：自发光 (带 MIS 权重) 和光源采样，阴影测试推迟到下一阶段
+        StageStats &shade =
+            local.stages[static_cast<int>(WavefrontStage::shade)];
+        start = clock::now();
+        batch.shadow.clear();
+        for (int p : batch.hits) {
+            stream = batch.rng[p];
+            const hit_record &rec = batch.rec[p];
+            const ray current_ray = batch.current_ray(p);
+            const color &throughput = batch.throughput[p];
+            if (record_features && depth == 0) {
+                batch.features[p].record_first_hit(current_ray, rec);
+            }
+            sampler.start_pixel_sample(batch.pixel_x[p], batch.pixel_y[p],
+                                       batch.sample_index[p]);
+            const BounceSample u = sampler.get_bounce(depth);
+            batch.u[p] = u;
+            vec3 wo = -unit_vector(current_ray.direction());
+
+            color emitted = rec.mat_ptr->emitted(rec, wo);
+            if (emitted.length_squared() > 0) {
+                color L_emit(0, 0, 0);
+                if (depth == 0 || batch.specular_bounce[p]) {
+                    L_emit = throughput * emitted;
+                } else if (!lights.empty()) {
+                    double light_pdf =
+                        compute_light_pdf(rec, wo, lights, current_ray);
+                    double mis_weight =
+                        power_heuristic(batch.prev_bsdf_pdf[p], light_pdf);
+                    L_emit = throughput * emitted * mis_weight;
+                } else {
+                    L_emit = throughput * emitted;
+                }
+                if (depth != 0) {
+                    L_emit = clamp_radiance(L_emit);
+                }
+                batch.radiance[p] += L_emit;
+                if (record_features) {
+                    batch.features[p].add_contribution(depth, L_emit);
+                }
+            }
+
+            const bool specular = rec.mat_ptr->is_specular();
+            batch.specular_bounce[p] = specular;
+            if (!specular && !lights.empty()) {
+                int light_count = static_cast<int>(lights.size());
+                int light_idx =
+                    std::min(static_cast<int>(u.light_select * light_count),
+                             light_count - 1);
+                LightSample ls = lights[light_idx]->sample(rec.p, u.light);
+                if (ls.pdf > 0 && ls.Li.length_squared() > 0) {
+                    batch.light_sample[p] = ls;
+                    batch.light_index[p] = light_idx;
+                    batch.shadow.push_back(p);
+                }
+            }
+            batch.rng[p] = stream;
+        }
+        shade.seconds += stage_time(start);
+        shade.items += batch.hits.size();
+        add_material_coherence(shade, batch, batch.hits);
+
+        // 阴影测试，未被遮挡的光源样本计入直接光照
+        StageStats &shadow =
+            local.stages[static_cast<int>(WavefrontStage::shadow)];
+        start = clock::now();
+        if (m_packet_size > 0) {
+            // 射向同一光源的阴影光线排在一起，再按队列顺序成包
+            std::stable_sort(batch.shadow.begin(), batch.shadow.end(),
+                             [&batch](int a, int b) {
+                                 return batch.light_index[a] <
+                                        batch.light_index[b];
+                             });
+            auto &shadow_packets = local.shadow_packets_by_bounce;
+            if (static_cast<int>(shadow_packets.size()) <= depth) {
+                shadow_packets.resize(depth + 1);
+            }
+            size_t begin = 0;
+            while (begin < batch.shadow.size()) {
+                size_t end = begin + 1;
+                while (end < batch.shadow.size() &&
+                       batch.light_index[batch.shadow[end]] ==
+                           batch.light_index[batch.shadow[begin]]) {
+                    ++end;
+                }
+                auto test_packet = [&](const int *paths, int n) {
+                    ray rays[kMaxRayPacketSize];
+                    double t_max[kMaxRayPacketSize] = {};
+                    bool occluded[kMaxRayPacketSize];
+                    random_stream streams[kMaxRayPacketSize];
+                    for (int i = 0; i < n; ++i) {
+                        const int p = paths[i];
+                        const LightSample &ls = batch.light_sample[p];
+                        rays[i] = spawn_shadow_ray(batch.rec[p], ls.wi,
+                                                   ls.dist, t_max[i]);
+                        streams[i] = batch.rng[p];
+                    }
+                    scene.occluded_packet(rays, n, 0.001, t_max, occluded,
+                                          streams, &shadow_packets[depth]);
+                    for (int i = 0; i < n; ++i) {
+                        batch.rng[paths[i]] = streams[i];
+                        batch.occluded[paths[i]] = occluded[i];
+                    }
+                };
+                for_each_packet(batch.shadow.data() + begin, end - begin,
+                                test_packet);
+                begin = end;
+            }
+        } else {
+            for (int p : batch.shadow) {
+                const LightSample &ls = batch.light_sample[p];
+                stream = batch.rng[p];
+                double t_max;
+                ray shadow_ray =
+                    spawn_shadow_ray(batch.rec[p], ls.wi, ls.dist, t_max);
+                batch.occluded[p] = scene.occluded(shadow_ray, 0.001, t_max);
+                batch.rng[p] = stream;
+            }
+        }
+        double shadow_coherence = 0.0;
+        for (size_t k = 0; k < batch.shadow.size(); ++k) {
+            const int p = batch.shadow[k];
+            const hit_record &rec = batch.rec[p];
+            const LightSample &ls = batch.light_sample[p];
+            if (k > 0) {
+                shadow_coherence +=
+                    dot(ls.wi, batch.light_sample[batch.shadow[k - 1]].wi);
+            }
+            if (batch.occluded[p]) {
+                continue;
+            }
+
+            vec3 wo = -unit_vector(vec3(batch.direction_x[p],
+                                        batch.direction_y[p],
+                                        batch.direction_z[p]));
+            double light_select_pdf = 1.0 / lights.size();
+            color f = rec.mat_ptr->eval(rec, wo, ls.wi);
+            double cos_theta = std::abs(dot(ls.wi, rec.normal));
+            color L_direct(0, 0, 0);
+            if (ls.is_delta) {
+                L_direct += f * ls.Li * cos_theta / light_select_pdf;
+            } else {
+                double bsdf_pdf = rec.mat_ptr->pdf(rec, wo, ls.wi);
+                double light_pdf = ls.pdf * light_select_pdf;
+                double mis_weight = power_heuristic(light_pdf, bsdf_pdf);
+                L_direct += f * ls.Li * cos_theta * mis_weight / light_pdf;
+            }
+            L_direct = clamp_radiance(batch.throughput[p] * L_direct);
+            batch.radiance[p] += L_direct;
+            if (record_features) {
+                batch.features[p].add_contribution(depth + 1, L_direct);
+            }
+        }
+        shadow.seconds += stage_time(start);
+        shadow.items += batch.shadow.size();
+        if (batch.shadow.size() > 1) {
+            shadow.coherence_sum += shadow_coherence;
+            shadow.coherence_pairs += batch.shadow.size() - 1;
+        }
+
+        // 散射：BSDF 采样生成下一条光线，之后做俄罗斯轮盘赌
+        StageStats &scatter =
+            local.stages[static_cast<int>(WavefrontStage::scatter)];
+        start = clock::now();
+        batch.next.clear();
+        for (int p : batch.hits) {
+            stream = batch.rng[p];
+            const hit_record &rec = batch.rec[p];
+            const ray current_ray = batch.current_ray(p);
+            const BounceSample &u = batch.u[p];
+            color &throughput = batch.throughput[p];
+            vec3 wo = -unit_vector(current_ray.direction());
+            bool alive = true;
+
+            BSDFSample bs;
+            if (!rec.mat_ptr->sample(rec, wo, u.bsdf, u.lobe, bs)) {
+                ray scattered;
+                color attenuation;
+                if (!rec.mat_ptr->scatter(current_ray, rec, attenuation,
+                                          scattered)) {
+                    alive = false;
+                } else {
+                    throughput *= attenuation;
+                    batch.set_ray(p, scattered);
+                    batch.specular_bounce[p] = false;
+                    batch.prev_bsdf_pdf[p] = 0.0;
+                }
+            } else if (bs.pdf < 1e-8 && !bs.is_specular) {
+                alive = false;
+            } else {
+                batch.specular_bounce[p] = bs.is_specular;
+                batch.prev_bsdf_pdf[p] = bs.is_specular ? 0.0 : bs.pdf;
+                double cos_theta = std::abs(dot(bs.wi, rec.normal));
+                if (bs.is_specular) {
+                    throughput *= bs.f;
+                } else {
+                    throughput *= bs.f * cos_theta / bs.pdf;
+                }
+                batch.set_ray(p, spawn_ray(rec, bs.wi, current_ray.time()));
+            }
+
+            if (alive && depth >= m_rr_start_depth) {
+                double p_survive =
+                    std::max({throughput.x(), throughput.y(), throughput.z()});
+                p_survive = clamp(p_survive, 0.05, 0.95);
+                if (u.russian_roulette > p_survive) {
+                    alive = false;
+                } else {
+                    throughput /= p_survive;
+                }
+            }
+            batch.rng[p] = stream;
+            if (alive) {
+                batch.next.push_back(p);
+            }
+        }
+        scatter.seconds += stage_time(start);
+        scatter.items += batch.hits.size();
+        add_material_coherence(scatter, batch, batch.hits);
+
+        batch.active.swap(batch.next);
+    }
+    stream = saved_stream;
+
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    for (int s = 0; s < kWavefrontStageCount; ++s) {
+        StageStats &total = m_stats.stages[s];
+        total.seconds += local.stages[s].seconds;
+        total.items += local.stages[s].items;
+        total.coherence_sum += local.stages[s].coherence_sum;
+        total.coherence_pairs += local.stages[s].coherence_pairs;
+    }
+    m_stats.sort_seconds += local.sort_seconds;
+    m_stats.batches += local.batches;
+    auto merge_packets = [](std::vector<ray_packet_stats> &total,
+                            const std::vector<ray_packet_stats> &part) {
+        if (total.size() < part.size()) {
+            total.resize(part.size());
+        }
+        for (size_t bounce = 0; bounce < part.size(); ++bounce) {
+            total[bounce].add(part[bounce]);
+        }
+    };
+    merge_packets(m_stats.camera_packets_by_bounce,
+                  local.camera_packets_by_bounce);
+    merge_packets(m_stats.shadow_packets_by_bounce,
+                  local.shadow_packets_by_bounce);
+}
+
+// 把 [0, 1] 内的值量化到 10 位后按位交错，三维 Morton 码共 30 位
+inline uint64_t wavefront_morton_code(double x, double y, double z) {
+    auto spread = [](double v) {
+        uint64_t b = static_cast<uint64_t>(clamp(v, 0.0, 1.0) * 1023.0);
+        b = (b | (b << 16)) & 0x030000ffull;
+        b = (b | (b << 8)) & 0x0300f00full;
+        b = (b | (b << 4)) & 0x030c30c3ull;
+        b = (b | (b << 2)) & 0x09249249ull;
+        return b;
+    };
+    return (spread(x) << 2) | (spread(y) << 1) | spread(z);
+}
+
+// 排序键：方向的卦限在高位，起点在本批光线包围盒中的 Morton 码在低位。
+// 键相同时按路径编号排序，结果是确定的
+inline void WavefrontPathIntegrator::sort_by_ray(
+    WavefrontBatch &batch, std::vector<int> &queue) const {
+    if (queue.size() < 2) {
+        return;
+    }
+    double lo[3] = {infinity, infinity, infinity};
+    double hi[3] = {-infinity, -infinity, -infinity};
+    for (int p : queue) {
+        const double o[3] = {batch.origin_x[p], batch.origin_y[p],
+                             batch.origin_z[p]};
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], o[a]);
+            hi[a] = std::max(hi[a], o[a]);
+        }
+    }
+    double scale[3];
+    for (int a = 0; a < 3; ++a) {
+        scale[a] = hi[a] > lo[a] ? 1.0 / (hi[a] - lo[a]) : 0.0;
+    }
+
+    batch.sort_keys.clear();
+    for (int p : queue) {
+        uint64_t octant = (batch.direction_x[p] < 0 ? 4 : 0) |
+                          (batch.direction_y[p] < 0 ? 2 : 0) |
+                          (batch.direction_z[p] < 0 ? 1 : 0);
+        uint64_t morton =
+            wavefront_morton_code((batch.origin_x[p] - lo[0]) * scale[0],
+                                  (batch.origin_y[p] - lo[1]) * scale[1],
+                                  (batch.origin_z[p] - lo[2]) * scale[2]);
+        batch.sort_keys.emplace_back((octant << 30) | morton, p);
+    }
+    std::sort(batch.sort_keys.begin(), batch.sort_keys.end());
+    for (size_t k = 0; k < queue.size(); ++k) {
+        queue[k] = batch.sort_keys[k].second;
+    }
+}
+
+inline void WavefrontPathIntegrator::sort_by_material(
+    WavefrontBatch &batch, std::vector<int> &queue) const {
+    batch.sort_keys.clear();
+    for (int p : queue) {
+        batch.sort_keys.emplace_back(batch.rec[p].mat_ptr->id(), p);
+    }
+    std::sort(batch.sort_keys.begin(), batch.sort_keys.end());
+    for (size_t k = 0; k < queue.size(); ++k) {
+        queue[k] = batch.sort_keys[k].second;
+    }
+}
+
+inline void WavefrontPathIntegrator::add_direction_coherence(
+    StageStats &stats, const WavefrontBatch &batch,
+    const std::vector<int> &queue) {
+    for (size_t k = 1; k < queue.size(); ++k) {
+        vec3 a(batch.direction_x[queue[k - 1]], batch.direction_y[queue[k - 1]],
+               batch.direction_z[queue[k - 1]]);
+        vec3 b(batch.direction_x[queue[k]], batch.direction_y[queue[k]],
+               batch.direction_z[queue[k]]);
+        stats.coherence_sum += dot(a, b) / std::sqrt(a.length_squared() *
+                                                     b.length_squared());
+        ++stats.coherence_pairs;
+    }
+}
+
+inline void WavefrontPathIntegrator::add_material_coherence(
+    StageStats &stats, const WavefrontBatch &batch,
+    const std::vector<int> &queue) {
+    for (size_t k = 1; k < queue.size(); ++k) {
+        stats.coherence_sum += batch.rec[queue[k - 1]].mat_ptr ==
+                                       batch.rec[queue[k]].mat_ptr
+                                   ? 1.0
+                                   : 0.0;
+        ++stats.coherence_pairs;
+    }
+}
+
+#endif
@@ -6,19 +6,27 @@
 #include "directional_light.h"
 #include "environmental_light.h"
 #include "hittable_list.h"
+#include "instance.h"
 #include "material.h"
+#include "mesh_cache.h"
 #include "moving_sphere.h"
+#include "obj_loader.h"
 #include "quad_light.h"
+#include "scene_arena.h"
 #include "sphere.h"
 #include "spot_light.h"
 
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
 shared_ptr<hittable> random_scene() {
     hittable_list world;
 
-    auto checker = make_shared<checker_texture>(color(0.2, 0.3, 0.1),
+    auto checker = make_pooled<checker_texture>(color(0.2, 0.3, 0.1),
                                                 color(0.9, 0.9, 0.9));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000,
-                                  make_shared<lambertian>(checker)));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000,
+                                  make_pooled<lambertian>(checker)));
 
     for (int a = -11; a < 11; a++) {
         for (int b = -11; b < 11; b++) {
@@ -31,40 +39,40 @@ shared_ptr<hittable> random_scene() {
 
                 if (choose_mat < 0.8) {
                     auto albedo = color::random() * color::random();
-                    sphere_material = make_shared<lambertian>(albedo);
+                    sphere_material = make_pooled<lambertian>(albedo);
                     auto center2 = center + vec3(0, random_double(0, .5), 0);
-                    world.add(make_shared<moving_sphere>(
+                    world.add(make_pooled<moving_sphere>(
                         center, center2, 0.0, 1.0, 0.2, sphere_material));
                 } else if (choose_mat < 0.95) {
                     auto albedo = color::random(0.5, 1);
                     auto fuzz = random_double(0, 0.5);
-                    sphere_material = make_shared<metal>(albedo, fuzz);
+                    sphere_material = make_pooled<metal>(albedo, fuzz);
                     world.add(
-                        make_shared<sphere>(center, 0.2, sphere_material));
+                        make_pooled<sphere>(center, 0.2, sphere_material));
                 }
             }
         }
     }
 
-    auto material1 = make_shared<dielectric>(1.5);
-    world.add(make_shared<sphere>(point3(0, 1, 0), 1.0, material1));
+    auto material1 = make_pooled<dielectric>(1.5);
+    world.add(make_pooled<sphere>(point3(0, 1, 0), 1.0, material1));
 
-    auto material2 = make_shared<lambertian>(color(0.4, 0.2, 0.1));
-    world.add(make_shared<sphere>(point3(-4, 1, 0), 1.0, material2));
+    auto material2 = make_pooled<lambertian>(color(0.4, 0.2, 0.1));
+    world.add(make_pooled<sphere>(point3(-4, 1, 0), 1.0, material2));
 
-    auto material3 = make_shared<metal>(color(0.7, 0.6, 0.5), 0.0);
-    world.add(make_shared<sphere>(point3(4, 1, 0), 1.0, material3));
+    auto material3 = make_pooled<metal>(color(0.7, 0.6, 0.5), 0.0);
+    world.add(make_pooled<sphere>(point3(4, 1, 0), 1.0, material3));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> example_light_scene() {
     hittable_list world;
 
-    auto checker = make_shared<checker_texture>(color(0.2, 0.3, 0.1),
+    auto checker = make_pooled<checker_texture>(color(0.2, 0.3, 0.1),
                                                 color(0.9, 0.9, 0.9));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000,
-                                  make_shared<lambertian>(checker)));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000,
+                                  make_pooled<lambertian>(checker)));
 
     for (int a = -11; a < 11; a++) {
         for (int b = -11; b < 11; b++) {
@@ -77,150 +85,154 @@ shared_ptr<hittable> example_light_scene() {
 
                 if (choose_mat < 0.3) {
                     auto albedo = color::random() * color::random();
-                    sphere_material = make_shared<lambertian>(albedo);
+                    sphere_material = make_pooled<lambertian>(albedo);
                     auto center2 = center + vec3(0, random_double(0, .5), 0);
                     world.add(
-                        make_shared<sphere>(center, 0.2, sphere_material));
+                        make_pooled<sphere>(center, 0.2, sphere_material));
                 } else if (choose_mat < 0.6) {
                     auto albedo = color::random(0.5, 1);
                     auto fuzz = random_double(0, 0.5);
-                    sphere_material = make_shared<metal>(albedo, fuzz);
+                    sphere_material = make_pooled<metal>(albedo, fuzz);
                     world.add(
-                        make_shared<sphere>(center, 0.2, sphere_material));
+                        make_pooled<sphere>(center, 0.2, sphere_material));
                 } else if (choose_mat < 0.95) {
                     auto difflight =
-                        make_shared<diffuse_light>(color::random() * 2);
-                    world.add(make_shared<sphere>(center, 0.2, difflight));
+                        make_pooled<diffuse_light>(color::random() * 2);
+                    world.add(make_pooled<sphere>(center, 0.2, difflight));
                 }
             }
         }
     }
 
-    auto material1 = make_shared<dielectric>(1.5);
-    world.add(make_shared<sphere>(point3(0, 1, 0), 1.0, material1));
+    auto material1 = make_pooled<dielectric>(1.5);
+    world.add(make_pooled<sphere>(point3(0, 1, 0), 1.0, material1));
 
-    auto material2 = make_shared<diffuse_light>(color(0.4, 0.2, 0.1) * 5);
-    world.add(make_shared<sphere>(point3(-4, 1, 0), 1.0, material2));
+    auto material2 = make_pooled<diffuse_light>(color(0.4, 0.2, 0.1) * 5);
+    world.add(make_pooled<sphere>(point3(-4, 1, 0), 1.0, material2));
 
-    auto material3 = make_shared<metal>(color(0.7, 0.6, 0.5), 0.0);
-    world.add(make_shared<sphere>(point3(4, 1, 0), 1.0, material3));
+    auto material3 = make_pooled<metal>(color(0.7, 0.6, 0.5), 0.0);
+    world.add(make_pooled<sphere>(point3(4, 1, 0), 1.0, material3));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> two_spheres() {
     hittable_list objects;
 
-    auto checker = make_shared<checker_texture>(color(0.2, 0.3, 0.1),
+    auto checker = make_pooled<checker_texture>(color(0.2, 0.3, 0.1),
                                                 color(0.9, 0.9, 0.9));
 
-    objects.add(make_shared<sphere>(point3(0, -10, 0), 10,
-                                    make_shared<lambertian>(checker)));
-    objects.add(make_shared<sphere>(point3(0, 10, 0), 10,
-                                    make_shared<lambertian>(checker)));
+    objects.add(make_pooled<sphere>(point3(0, -10, 0), 10,
+                                    make_pooled<lambertian>(checker)));
+    objects.add(make_pooled<sphere>(point3(0, 10, 0), 10,
+                                    make_pooled<lambertian>(checker)));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> two_perlin_spheres() {
     hittable_list objects;
 
-    auto pertext = make_shared<noise_texture>(4);
-    objects.add(make_shared<sphere>(point3(0, -1000, 0), 1000,
-                                    make_shared<lambertian>(pertext)));
-    objects.add(make_shared<sphere>(point3(0, 2, 0), 2,
-                                    make_shared<lambertian>(pertext)));
+    auto pertext = make_pooled<noise_texture>(4);
+    objects.add(make_pooled<sphere>(point3(0, -1000, 0), 1000,
+                                    make_pooled<lambertian>(pertext)));
+    objects.add(make_pooled<sphere>(point3(0, 2, 0), 2,
+                                    make_pooled<lambertian>(pertext)));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> earth() {
-    auto earth_texture = make_shared<image_texture>("earthmap.jpg");
-    auto earth_surface = make_shared<lambertian>(earth_texture);
-    auto globe = make_shared<sphere>(point3(0, 0, 0), 2, earth_surface);
+    auto earth_texture = make_pooled<image_texture>("earthmap.jpg");
+    auto earth_surface = make_pooled<lambertian>(earth_texture);
+    auto globe = make_pooled<sphere>(point3(0, 0, 0), 2, earth_surface);
 
-    return make_shared<bvh_node>(hittable_list(globe), 0, 1);
+    return make_pooled<bvh_node>(hittable_list(globe), 0, 1);
 }
 
 shared_ptr<hittable> simple_light() {
     hittable_list objects;
 
-    auto pertext = make_shared<lambertian>(color(0.4, 0.6, 0.3));
-    objects.add(make_shared<sphere>(point3(0, -1000, 0), 1000, pertext));
-    objects.add(make_shared<sphere>(point3(0, 2, 0), 2, pertext));
+    auto pertext = make_pooled<lambertian>(color(0.4, 0.6, 0.3));
+    objects.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, pertext));
+    objects.add(make_pooled<sphere>(point3(0, 2, 0), 2, pertext));
 
-    auto difflight = make_shared<diffuse_light>(color(4, 4, 4));
-    objects.add(make_shared<xy_rect>(3, 5, 1, 3, -2, difflight));
-    objects.add(make_shared<sphere>(vec3(0, 7, 0), 2, difflight));
+    auto difflight = make_pooled<diffuse_light>(color(4, 4, 4));
+    objects.add(make_pooled<xy_rect>(3, 5, 1, 3, -2, difflight));
+    objects.add(make_pooled<sphere>(vec3(0, 7, 0), 2, difflight));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> cornell_box() {
     hittable_list objects;
 
-    auto red = make_shared<lambertian>(color(.65, .05, .05));
-    auto white = make_shared<lambertian>(color(.73, .73, .73));
-    auto green = make_shared<lambertian>(color(.12, .45, .15));
-    auto light = make_shared<diffuse_light>(color(15, 15, 15));
+    auto red = make_pooled<lambertian>(color(.65, .05, .05));
+    auto white = make_pooled<lambertian>(color(.73, .73, .73));
+    auto green = make_pooled<lambertian>(color(.12, .45, .15));
+    auto light = make_pooled<diffuse_light>(color(15, 15, 15));
 
-    objects.add(make_shared<yz_rect>(0, 555, 0, 555, 555, green));
-    objects.add(make_shared<yz_rect>(0, 555, 0, 555, 0, red));
-    objects.add(make_shared<xz_rect>(213, 343, 227, 332, 554, light));
-    objects.add(make_shared<xz_rect>(0, 555, 0, 555, 0, white));
-    objects.add(make_shared<xz_rect>(0, 555, 0, 555, 555, white));
-    objects.add(make_shared<xy_rect>(0, 555, 0, 555, 555, white));
+    objects.add(make_pooled<yz_rect>(0, 555, 0, 555, 555, green));
+    objects.add(make_pooled<yz_rect>(0, 555, 0, 555, 0, red));
+    objects.add(make_pooled<xz_rect>(213, 343, 227, 332, 554, light));
+    objects.add(make_pooled<xz_rect>(0, 555, 0, 555, 0, white));
+    objects.add(make_pooled<xz_rect>(0, 555, 0, 555, 555, white));
+    objects.add(make_pooled<xy_rect>(0, 555, 0, 555, 555, white));
 
     shared_ptr<hittable> box1 =
-        make_shared<box>(point3(0, 0, 0), point3(165, 330, 165), white);
-    box1 = make_shared<rotate_y>(box1, 15);
-    box1 = make_shared<translate>(box1, vec3(265, 0, 295));
+        make_pooled<box>(point3(0, 0, 0), point3(165, 330, 165), white);
+    box1 = make_pooled<instance>(
+        box1, affine_transform::translation(vec3(265, 0, 295)) *
+                  affine_transform::rotation_y(15));
     objects.add(box1);
 
     shared_ptr<hittable> box2 =
-        make_shared<box>(point3(0, 0, 0), point3(165, 165, 165), white);
-    box2 = make_shared<rotate_y>(box2, -18);
-    box2 = make_shared<translate>(box2, vec3(130, 0, 65));
+        make_pooled<box>(point3(0, 0, 0), point3(165, 165, 165), white);
+    box2 = make_pooled<instance>(
+        box2, affine_transform::translation(vec3(130, 0, 65)) *
+                  affine_transform::rotation_y(-18));
     objects.add(box2);
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> cornell_smoke() {
     hittable_list objects;
 
-    auto red = make_shared<lambertian>(color(.65, .05, .05));
-    auto white = make_shared<lambertian>(color(.73, .73, .73));
-    auto green = make_shared<lambertian>(color(.12, .45, .15));
-    auto light = make_shared<diffuse_light>(color(7, 7, 7));
+    auto red = make_pooled<lambertian>(color(.65, .05, .05));
+    auto white = make_pooled<lambertian>(color(.73, .73, .73));
+    auto green = make_pooled<lambertian>(color(.12, .45, .15));
+    auto light = make_pooled<diffuse_light>(color(7, 7, 7));
 
-    objects.add(make_shared<yz_rect>(0, 555, 0, 555, 555, green));
-    objects.add(make_shared<yz_rect>(0, 555, 0, 555, 0, red));
-    objects.add(make_shared<xz_rect>(113, 443, 127, 432, 554, light));
-    objects.add(make_shared<xz_rect>(0, 555, 0, 555, 555, white));
-    objects.add(make_shared<xz_rect>(0, 555, 0, 555, 0, white));
-    objects.add(make_shared<xy_rect>(0, 555, 0, 555, 555, white));
+    objects.add(make_pooled<yz_rect>(0, 555, 0, 555, 555, green));
+    objects.add(make_pooled<yz_rect>(0, 555, 0, 555, 0, red));
+    objects.add(make_pooled<xz_rect>(113, 443, 127, 432, 554, light));
+    objects.add(make_pooled<xz_rect>(0, 555, 0, 555, 555, white));
+    objects.add(make_pooled<xz_rect>(0, 555, 0, 555, 0, white));
+    objects.add(make_pooled<xy_rect>(0, 555, 0, 555, 555, white));
 
     shared_ptr<hittable> box1 =
-        make_shared<box>(point3(0, 0, 0), point3(165, 330, 165), white);
-    box1 = make_shared<rotate_y>(box1, 15);
-    box1 = make_shared<translate>(box1, vec3(265, 0, 295));
-    box1 = make_shared<constant_medium>(box1, 0.01, color(0, 0, 0));
+        make_pooled<box>(point3(0, 0, 0), point3(165, 330, 165), white);
+    box1 = make_pooled<instance>(
+        box1, affine_transform::translation(vec3(265, 0, 295)) *
+                  affine_transform::rotation_y(15));
+    box1 = make_pooled<constant_medium>(box1, 0.01, color(0, 0, 0));
     objects.add(box1);
 
     shared_ptr<hittable> box2 =
-        make_shared<box>(point3(0, 0, 0), point3(165, 165, 165), white);
-    box2 = make_shared<rotate_y>(box2, -18);
-    box2 = make_shared<translate>(box2, vec3(130, 0, 65));
-    box2 = make_shared<constant_medium>(box2, 0.01, color(1, 1, 1));
+        make_pooled<box>(point3(0, 0, 0), point3(165, 165, 165), white);
+    box2 = make_pooled<instance>(
+        box2, affine_transform::translation(vec3(130, 0, 65)) *
+                  affine_transform::rotation_y(-18));
+    box2 = make_pooled<constant_medium>(box2, 0.01, color(1, 1, 1));
     objects.add(box2);
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> final_scene() {
     hittable_list boxes1;
-    auto ground = make_shared<lambertian>(color(0.48, 0.83, 0.53));
+    auto ground = make_pooled<lambertian>(color(0.48, 0.83, 0.53));
 
     const int boxes_per_side = 20;
     for (int i = 0; i < boxes_per_side; i++) {
@@ -233,103 +245,104 @@ shared_ptr<hittable> final_scene() {
             auto y1 = random_double(1, 101);
             auto z1 = z0 + w;
 
-            boxes1.add(make_shared<box>(point3(x0, y0, z0), point3(x1, y1, z1),
+            boxes1.add(make_pooled<box>(point3(x0, y0, z0), point3(x1, y1, z1),
                                         ground));
         }
     }
 
     hittable_list objects;
 
-    objects.add(make_shared<bvh_node>(boxes1, 0, 1));
+    objects.add(make_pooled<bvh_node>(boxes1, 0, 1));
 
-    auto light = make_shared<diffuse_light>(color(7, 7, 7));
-    objects.add(make_shared<xz_rect>(123, 423, 147, 412, 554, light));
+    auto light = make_pooled<diffuse_light>(color(7, 7, 7));
+    objects.add(make_pooled<xz_rect>(123, 423, 147, 412, 554, light));
 
     auto center1 = point3(400, 400, 200);
     auto center2 = center1 + vec3(30, 0, 0);
-    auto moving_sphere_material = make_shared<lambertian>(color(0.7, 0.3, 0.1));
-    objects.add(make_shared<moving_sphere>(center1, center2, 0, 1, 50,
+    auto moving_sphere_material = make_pooled<lambertian>(color(0.7, 0.3, 0.1));
+    objects.add(make_pooled<moving_sphere>(center1, center2, 0, 1, 50,
                                            moving_sphere_material));
 
-    objects.add(make_shared<sphere>(point3(260, 150, 45), 50,
-                                    make_shared<dielectric>(1.5)));
+    objects.add(make_pooled<sphere>(point3(260, 150, 45), 50,
+                                    make_pooled<dielectric>(1.5)));
     objects.add(
-        make_shared<sphere>(point3(0, 150, 145), 50,
-                            make_shared<metal>(color(0.8, 0.8, 0.9), 1.0)));
+        make_pooled<sphere>(point3(0, 150, 145), 50,
+                            make_pooled<metal>(color(0.8, 0.8, 0.9), 1.0)));
 
-    auto boundary = make_shared<sphere>(point3(360, 150, 145), 70,
-                                        make_shared<dielectric>(1.5));
+    auto boundary = make_pooled<sphere>(point3(360, 150, 145), 70,
+                                        make_pooled<dielectric>(1.5));
     objects.add(boundary);
     objects.add(
-        make_shared<constant_medium>(boundary, 0.2, color(0.2, 0.4, 0.9)));
+        make_pooled<constant_medium>(boundary, 0.2, color(0.2, 0.4, 0.9)));
 
-    boundary = make_shared<sphere>(point3(0, 0, 0), 5000,
-                                   make_shared<dielectric>(1.5));
-    objects.add(make_shared<constant_medium>(boundary, .0001, color(1, 1, 1)));
+    boundary = make_pooled<sphere>(point3(0, 0, 0), 5000,
+                                   make_pooled<dielectric>(1.5));
+    objects.add(make_pooled<constant_medium>(boundary, .0001, color(1, 1, 1)));
 
     auto emat =
-        make_shared<lambertian>(make_shared<image_texture>("earthmap.jpg"));
-    objects.add(make_shared<sphere>(point3(400, 200, 400), 100, emat));
+        make_pooled<lambertian>(make_pooled<image_texture>("earthmap.jpg"));
+    objects.add(make_pooled<sphere>(point3(400, 200, 400), 100, emat));
 
-    auto pertext = make_shared<noise_texture>(0.1);
-    objects.add(make_shared<sphere>(point3(220, 280, 300), 80,
-                                    make_shared<lambertian>(pertext)));
+    auto pertext = make_pooled<noise_texture>(0.1);
+    objects.add(make_pooled<sphere>(point3(220, 280, 300), 80,
+                                    make_pooled<lambertian>(pertext)));
 
     hittable_list boxes2;
-    auto white = make_shared<lambertian>(color(.73, .73, .73));
+    auto white = make_pooled<lambertian>(color(.73, .73, .73));
     int ns = 1000;
     for (int j = 0; j < ns; j++) {
-        boxes2.add(make_shared<sphere>(point3::random(0, 165), 10, white));
+        boxes2.add(make_pooled<sphere>(point3::random(0, 165), 10, white));
     }
 
-    objects.add(make_shared<translate>(
-        make_shared<rotate_y>(make_shared<bvh_node>(boxes2, 0.0, 1.0), 15),
-        vec3(-100, 270, 395)));
+    objects.add(make_pooled<instance>(
+        make_blas(boxes2, 0.0, 1.0),
+        affine_transform::translation(vec3(-100, 270, 395)) *
+            affine_transform::rotation_y(15)));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> pbr_test_scene() {
     hittable_list world;
 
-    auto checker = make_shared<checker_texture>(color(0.2, 0.3, 0.1),
+    auto checker = make_pooled<checker_texture>(color(0.2, 0.3, 0.1),
                                                 color(0.9, 0.9, 0.9));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000,
-                                  make_shared<lambertian>(checker)));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000,
+                                  make_pooled<lambertian>(checker)));
 
     // Left: Gold (Metallic)
-    auto gold_albedo = make_shared<solid_color>(0.8, 0.6, 0.2);
-    auto gold_rough = make_shared<solid_color>(0.1, 0.1, 0.1);
-    auto gold_metal = make_shared<solid_color>(1.0, 1.0, 1.0);
+    auto gold_albedo = make_pooled<solid_color>(0.8, 0.6, 0.2);
+    auto gold_rough = make_pooled<solid_color>(0.1, 0.1, 0.1);
+    auto gold_metal = make_pooled<solid_color>(1.0, 1.0, 1.0);
     auto gold_mat =
-        make_shared<PBRMaterial>(gold_albedo, gold_rough, gold_metal);
-    world.add(make_shared<sphere>(point3(-4, 1, 0), 1.0, gold_mat));
+        make_pooled<PBRMaterial>(gold_albedo, gold_rough, gold_metal);
+    world.add(make_pooled<sphere>(point3(-4, 1, 0), 1.0, gold_mat));
 
     // Middle: Silver/Textured (Metallic with Noise)
-    auto noise = make_shared<noise_texture>(4.0);
-    auto silver_rough = make_shared<solid_color>(0.2, 0.2, 0.2);
-    auto silver_metal = make_shared<solid_color>(1.0, 1.0, 1.0);
-    auto mid_mat = make_shared<PBRMaterial>(noise, silver_rough, silver_metal);
-    world.add(make_shared<sphere>(point3(0, 1, 0), 1.0, mid_mat));
+    auto noise = make_pooled<noise_texture>(4.0);
+    auto silver_rough = make_pooled<solid_color>(0.2, 0.2, 0.2);
+    auto silver_metal = make_pooled<solid_color>(1.0, 1.0, 1.0);
+    auto mid_mat = make_pooled<PBRMaterial>(noise, silver_rough, silver_metal);
+    world.add(make_pooled<sphere>(point3(0, 1, 0), 1.0, mid_mat));
 
     // Right: Blue Plastic (Dielectric-like PBR)
-    auto blue_albedo = make_shared<solid_color>(0.1, 0.2, 0.5);
-    auto blue_rough = make_shared<solid_color>(0.05, 0.05, 0.05);
-    auto blue_metal = make_shared<solid_color>(0.0, 0.0, 0.0);
+    auto blue_albedo = make_pooled<solid_color>(0.1, 0.2, 0.5);
+    auto blue_rough = make_pooled<solid_color>(0.05, 0.05, 0.05);
+    auto blue_metal = make_pooled<solid_color>(0.0, 0.0, 0.0);
     auto blue_mat =
-        make_shared<PBRMaterial>(blue_albedo, blue_rough, blue_metal);
-    world.add(make_shared<sphere>(point3(4, 1, 0), 1.0, blue_mat));
+        make_pooled<PBRMaterial>(blue_albedo, blue_rough, blue_metal);
+    world.add(make_pooled<sphere>(point3(4, 1, 0), 1.0, blue_mat));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> pbr_spheres_grid() {
     hittable_list world;
 
-    auto checker = make_shared<checker_texture>(color(0.2, 0.3, 0.1),
+    auto checker = make_pooled<checker_texture>(color(0.2, 0.3, 0.1),
                                                 color(0.9, 0.9, 0.9));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000,
-                                  make_shared<lambertian>(checker)));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000,
+                                  make_pooled<lambertian>(checker)));
 
     int rows = 7;
     int cols = 7;
@@ -340,36 +353,36 @@ shared_ptr<hittable> pbr_spheres_grid() {
             double metallic_val = (double)row / (rows - 1);
             double roughness_val = clamp((double)col / (cols - 1), 0.05, 1.0);
 
-            auto albedo = make_shared<solid_color>(0.5, 0.0, 0.0);
-            auto roughness = make_shared<solid_color>(
+            auto albedo = make_pooled<solid_color>(0.5, 0.0, 0.0);
+            auto roughness = make_pooled<solid_color>(
                 roughness_val, roughness_val, roughness_val);
-            auto metallic = make_shared<solid_color>(metallic_val, metallic_val,
+            auto metallic = make_pooled<solid_color>(metallic_val, metallic_val,
                                                      metallic_val);
 
-            auto mat = make_shared<PBRMaterial>(albedo, roughness, metallic);
+            auto mat = make_pooled<PBRMaterial>(albedo, roughness, metallic);
 
             double x = (col - (cols - 1) / 2.0) * spacing;
             double z = (row - (rows - 1) / 2.0) * spacing;
 
-            world.add(make_shared<sphere>(point3(x, 1, z), 1.0, mat));
+            world.add(make_pooled<sphere>(point3(x, 1, z), 1.0, mat));
         }
     }
 
-    auto light_mat = make_shared<diffuse_light>(color(30, 30, 30));
+    auto light_mat = make_pooled<diffuse_light>(color(30, 30, 30));
     // 将主光源移到相机上方 (y=60)，避免遮挡视线
-    world.add(make_shared<sphere>(point3(0, 60, 0), 10, light_mat));
+    world.add(make_pooled<sphere>(point3(0, 60, 0), 10, light_mat));
     // 调整侧面辅助光源的位置
-    world.add(make_shared<sphere>(point3(-20, 10, 20), 2, light_mat));
-    world.add(make_shared<sphere>(point3(20, 10, 20), 2, light_mat));
+    world.add(make_pooled<sphere>(point3(-20, 10, 20), 2, light_mat));
+    world.add(make_pooled<sphere>(point3(20, 10, 20), 2, light_mat));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> pbr_materials_gallery() {
     hittable_list world;
 
-    auto ground_mat = make_shared<lambertian>(color(0.5, 0.5, 0.5));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, ground_mat));
+    auto ground_mat = make_pooled<lambertian>(color(0.5, 0.5, 0.5));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, ground_mat));
 
     // Non-Metals (Metallic = 0.0)
     struct MaterialInfo {
@@ -400,41 +413,41 @@ shared_ptr<hittable> pbr_materials_gallery() {
 
     for (size_t i = 0; i < non_metals.size(); ++i) {
         auto &info = non_metals[i];
-        auto mat = make_shared<PBRMaterial>(
-            make_shared<solid_color>(info.albedo),
-            make_shared<solid_color>(info.roughness, info.roughness,
+        auto mat = make_pooled<PBRMaterial>(
+            make_pooled<solid_color>(info.albedo),
+            make_pooled<solid_color>(info.roughness, info.roughness,
                                      info.roughness),
-            make_shared<solid_color>(info.metallic, info.metallic,
+            make_pooled<solid_color>(info.metallic, info.metallic,
                                      info.metallic));
-        world.add(make_shared<sphere>(point3(start_x_nm + i * spacing, 1, -2),
+        world.add(make_pooled<sphere>(point3(start_x_nm + i * spacing, 1, -2),
                                       1.0, mat));
     }
 
     double start_x_m = -((metals.size() - 1) * spacing) / 2.0;
     for (size_t i = 0; i < metals.size(); ++i) {
         auto &info = metals[i];
-        auto mat = make_shared<PBRMaterial>(
-            make_shared<solid_color>(info.albedo),
-            make_shared<solid_color>(info.roughness, info.roughness,
+        auto mat = make_pooled<PBRMaterial>(
+            make_pooled<solid_color>(info.albedo),
+            make_pooled<solid_color>(info.roughness, info.roughness,
                                      info.roughness),
-            make_shared<solid_color>(info.metallic, info.metallic,
+            make_pooled<solid_color>(info.metallic, info.metallic,
                                      info.metallic));
-        world.add(make_shared<sphere>(point3(start_x_m + i * spacing, 1, 2),
+        world.add(make_pooled<sphere>(point3(start_x_m + i * spacing, 1, 2),
                                       1.0, mat));
     }
 
     // Lights
-    auto light_mat = make_shared<diffuse_light>(color(10, 10, 10));
-    world.add(make_shared<sphere>(point3(0, 20, 10), 5, light_mat));
+    auto light_mat = make_pooled<diffuse_light>(color(10, 10, 10));
+    world.add(make_pooled<sphere>(point3(0, 20, 10), 5, light_mat));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> pbr_reference_scene() {
     hittable_list world;
 
-    auto ground_mat = make_shared<lambertian>(color(0.2, 0.2, 0.2));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, ground_mat));
+    auto ground_mat = make_pooled<lambertian>(color(0.2, 0.2, 0.2));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, ground_mat));
 
     struct MaterialInfo {
         color albedo;
@@ -469,13 +482,13 @@ shared_ptr<hittable> pbr_reference_scene() {
     double start_x = -((metals.size() - 1) * spacing) / 2.0;
     for (size_t i = 0; i < metals.size(); ++i) {
         auto &info = metals[i];
-        auto mat = make_shared<PBRMaterial>(
-            make_shared<solid_color>(info.albedo),
-            make_shared<solid_color>(info.roughness, info.roughness,
+        auto mat = make_pooled<PBRMaterial>(
+            make_pooled<solid_color>(info.albedo),
+            make_pooled<solid_color>(info.roughness, info.roughness,
                                      info.roughness),
-            make_shared<solid_color>(info.metallic, info.metallic,
+            make_pooled<solid_color>(info.metallic, info.metallic,
                                      info.metallic));
-        world.add(make_shared<sphere>(point3(start_x + i * spacing, 1, row_z),
+        world.add(make_pooled<sphere>(point3(start_x + i * spacing, 1, row_z),
                                       1.0, mat));
     }
 
@@ -484,13 +497,13 @@ shared_ptr<hittable> pbr_reference_scene() {
     start_x = -((non_metals.size() - 1) * spacing) / 2.0;
     for (size_t i = 0; i < non_metals.size(); ++i) {
         auto &info = non_metals[i];
-        auto mat = make_shared<PBRMaterial>(
-            make_shared<solid_color>(info.albedo),
-            make_shared<solid_color>(info.roughness, info.roughness,
+        auto mat = make_pooled<PBRMaterial>(
+            make_pooled<solid_color>(info.albedo),
+            make_pooled<solid_color>(info.roughness, info.roughness,
                                      info.roughness),
-            make_shared<solid_color>(info.metallic, info.metallic,
+            make_pooled<solid_color>(info.metallic, info.metallic,
                                      info.metallic));
-        world.add(make_shared<sphere>(point3(start_x + i * spacing, 1, row_z),
+        world.add(make_pooled<sphere>(point3(start_x + i * spacing, 1, row_z),
                                       1.0, mat));
     }
 
@@ -500,160 +513,160 @@ shared_ptr<hittable> pbr_reference_scene() {
     color gold_albedo(1.000, 0.766, 0.336);
     for (size_t i = 0; i < roughness_gradient.size(); ++i) {
         double r = roughness_gradient[i];
-        auto mat = make_shared<PBRMaterial>(
-            make_shared<solid_color>(gold_albedo),
-            make_shared<solid_color>(r, r, r),
-            make_shared<solid_color>(1.0, 1.0, 1.0)); // Metallic = 1.0
-        world.add(make_shared<sphere>(point3(start_x + i * spacing, 1, row_z),
+        auto mat = make_pooled<PBRMaterial>(
+            make_pooled<solid_color>(gold_albedo),
+            make_pooled<solid_color>(r, r, r),
+            make_pooled<solid_color>(1.0, 1.0, 1.0)); // Metallic = 1.0
+        world.add(make_pooled<sphere>(point3(start_x + i * spacing, 1, row_z),
                                       1.0, mat));
     }
 
     // Lights
-    auto light_mat = make_shared<diffuse_light>(color(10, 10, 10));
-    world.add(make_shared<sphere>(point3(0, 30, 10), 8, light_mat));
-    world.add(make_shared<sphere>(point3(-20, 10, 20), 2, light_mat));
-    world.add(make_shared<sphere>(point3(20, 10, 20), 2, light_mat));
+    auto light_mat = make_pooled<diffuse_light>(color(10, 10, 10));
+    world.add(make_pooled<sphere>(point3(0, 30, 10), 8, light_mat));
+    world.add(make_pooled<sphere>(point3(-20, 10, 20), 2, light_mat));
+    world.add(make_pooled<sphere>(point3(20, 10, 20), 2, light_mat));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> point_light_scene() {
     hittable_list world;
 
-    auto ground_mat = make_shared<lambertian>(color(0.5, 0.5, 0.5));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, ground_mat));
+    auto ground_mat = make_pooled<lambertian>(color(0.5, 0.5, 0.5));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, ground_mat));
 
     // Diffuse Sphere
-    auto lambert = make_shared<lambertian>(color(0.8, 0.2, 0.2));
-    world.add(make_shared<sphere>(point3(0, 1, 0), 1.0, lambert));
+    auto lambert = make_pooled<lambertian>(color(0.8, 0.2, 0.2));
+    world.add(make_pooled<sphere>(point3(0, 1, 0), 1.0, lambert));
 
     // PBR Metal Sphere
-    auto albedo = make_shared<solid_color>(0.9, 0.9, 0.9);
-    auto roughness = make_shared<solid_color>(0.05, 0.05, 0.05); // Smooth
-    auto metallic = make_shared<solid_color>(1.0, 1.0, 1.0);
-    auto metal_mat = make_shared<PBRMaterial>(albedo, roughness, metallic);
-    world.add(make_shared<sphere>(point3(-3, 1, 0), 1.0, metal_mat));
+    auto albedo = make_pooled<solid_color>(0.9, 0.9, 0.9);
+    auto roughness = make_pooled<solid_color>(0.05, 0.05, 0.05); // Smooth
+    auto metallic = make_pooled<solid_color>(1.0, 1.0, 1.0);
+    auto metal_mat = make_pooled<PBRMaterial>(albedo, roughness, metallic);
+    world.add(make_pooled<sphere>(point3(-3, 1, 0), 1.0, metal_mat));
 
     // PBR Dielectric-like Sphere
-    auto d_albedo = make_shared<solid_color>(0.2, 0.2, 0.8);
-    auto d_roughness = make_shared<solid_color>(0.1, 0.1, 0.1);
-    auto d_metallic = make_shared<solid_color>(0.0, 0.0, 0.0);
+    auto d_albedo = make_pooled<solid_color>(0.2, 0.2, 0.8);
+    auto d_roughness = make_pooled<solid_color>(0.1, 0.1, 0.1);
+    auto d_metallic = make_pooled<solid_color>(0.0, 0.0, 0.0);
     auto plastic_mat =
-        make_shared<PBRMaterial>(d_albedo, d_roughness, d_metallic);
-    world.add(make_shared<sphere>(point3(3, 1, 0), 1.0, plastic_mat));
+        make_pooled<PBRMaterial>(d_albedo, d_roughness, d_metallic);
+    world.add(make_pooled<sphere>(point3(3, 1, 0), 1.0, plastic_mat));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> mis_demo() {
     hittable_list world;
 
-    auto ground_mat = make_shared<lambertian>(color(0.5, 0.5, 0.5));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, ground_mat));
+    auto ground_mat = make_pooled<lambertian>(color(0.5, 0.5, 0.5));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, ground_mat));
 
     // Smooth Metal (Roughness 0.05) - BSDF sampling dominates for specular
     // reflection
     auto smooth_metal =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.9, 0.9, 0.9),
-                                 make_shared<solid_color>(0.05, 0.05, 0.05),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(-4, 1, 0), 1.0, smooth_metal));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.9, 0.9, 0.9),
+                                 make_pooled<solid_color>(0.05, 0.05, 0.05),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(-4, 1, 0), 1.0, smooth_metal));
 
     // Rough Metal (Roughness 0.5) - NEE dominates
     auto rough_metal =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.9, 0.9, 0.9),
-                                 make_shared<solid_color>(0.5, 0.5, 0.5),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(0, 1, 0), 1.0, rough_metal));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.9, 0.9, 0.9),
+                                 make_pooled<solid_color>(0.5, 0.5, 0.5),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(0, 1, 0), 1.0, rough_metal));
 
     // Diffuse - NEE dominates
-    auto diffuse = make_shared<lambertian>(color(0.2, 0.2, 0.8));
-    world.add(make_shared<sphere>(point3(4, 1, 0), 1.0, diffuse));
+    auto diffuse = make_pooled<lambertian>(color(0.2, 0.2, 0.8));
+    world.add(make_pooled<sphere>(point3(4, 1, 0), 1.0, diffuse));
 
     // Emissive Sphere (BSDF sampling only, as it's not in lights list)
-    auto light_mat = make_shared<diffuse_light>(color(10, 5, 5));
-    world.add(make_shared<sphere>(point3(0, 1, -3), 1.0, light_mat));
+    auto light_mat = make_pooled<diffuse_light>(color(10, 5, 5));
+    world.add(make_pooled<sphere>(point3(0, 1, -3), 1.0, light_mat));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> mis_comparison_scene() {
     hittable_list world;
 
-    auto ground_mat = make_shared<lambertian>(color(0.5, 0.5, 0.5));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, ground_mat));
+    auto ground_mat = make_pooled<lambertian>(color(0.5, 0.5, 0.5));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, ground_mat));
 
     // 1. Smooth Metal (Roughness 0.001) - NEE struggles with Large Light, BSDF
     // wins
-    auto smooth_metal = make_shared<PBRMaterial>(
-        make_shared<solid_color>(0.9, 0.6, 0.2), // Gold
-        make_shared<solid_color>(0.001, 0.001, 0.001),
-        make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(-2.5, 1, 0), 1.0, smooth_metal));
+    auto smooth_metal = make_pooled<PBRMaterial>(
+        make_pooled<solid_color>(0.9, 0.6, 0.2), // Gold
+        make_pooled<solid_color>(0.001, 0.001, 0.001),
+        make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(-2.5, 1, 0), 1.0, smooth_metal));
 
     // 2. Rough Metal (Roughness 0.4) - NEE is fine
-    auto rough_metal = make_shared<PBRMaterial>(
-        make_shared<solid_color>(0.8, 0.8, 0.8), // Silver
-        make_shared<solid_color>(0.4, 0.4, 0.4),
-        make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(0, 1, 0), 1.0, rough_metal));
+    auto rough_metal = make_pooled<PBRMaterial>(
+        make_pooled<solid_color>(0.8, 0.8, 0.8), // Silver
+        make_pooled<solid_color>(0.4, 0.4, 0.4),
+        make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(0, 1, 0), 1.0, rough_metal));
 
     // 3. Glass (Transmission)
-    auto glass = make_shared<dielectric>(1.5);
-    world.add(make_shared<sphere>(point3(2.5, 1, 0), 1.0, glass));
+    auto glass = make_pooled<dielectric>(1.5);
+    world.add(make_pooled<sphere>(point3(2.5, 1, 0), 1.0, glass));
 
     // Lights are added in select_scene via config.lights
     // But we need visual representation here
 
     // Large Area Light (Top)
-    auto light_mat = make_shared<diffuse_light>(color(5, 5, 5));
+    auto light_mat = make_pooled<diffuse_light>(color(5, 5, 5));
     // Centered at (0, 10, 0), size 20x20
     // Using xz_rect for top light (y is constant)
     // xz_rect normal is (0, 1, 0) (up), so we need to flip it to face down
-    world.add(make_shared<flip_face>(
-        make_shared<xz_rect>(-10, 10, -10, 10, 10, light_mat)));
+    world.add(make_pooled<flip_face>(
+        make_pooled<xz_rect>(-10, 10, -10, 10, 10, light_mat)));
 
     // Small Intense Light (Right Side)
-    auto small_light_mat = make_shared<diffuse_light>(color(50, 50, 50));
+    auto small_light_mat = make_pooled<diffuse_light>(color(50, 50, 50));
     // Centered at (6, 4, 2), size 0.5x0.5 facing -X
     // Using yz_rect for side light (x is constant)
     // yz_rect normal is (1, 0, 0) (right), so we need to flip it to face left
     // (-X)
-    world.add(make_shared<flip_face>(
-        make_shared<yz_rect>(3.75, 4.25, 1.75, 2.25, 6, small_light_mat)));
+    world.add(make_pooled<flip_face>(
+        make_pooled<yz_rect>(3.75, 4.25, 1.75, 2.25, 6, small_light_mat)));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> soft_shadow_demo() {
     hittable_list world;
 
     // 1. 地面 (接收阴影)
-    auto ground_mat = make_shared<lambertian>(color(0.8, 0.8, 0.8));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, ground_mat));
+    auto ground_mat = make_pooled<lambertian>(color(0.8, 0.8, 0.8));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, ground_mat));
 
     // 2. 悬浮球体 (产生明显的软阴影)
     // 离地面越高，光源越大，半影区(Penumbra)越明显
-    auto red_mat = make_shared<lambertian>(color(0.8, 0.2, 0.2));
-    world.add(make_shared<sphere>(point3(0, 2, 0), 1.0, red_mat));
+    auto red_mat = make_pooled<lambertian>(color(0.8, 0.2, 0.2));
+    world.add(make_pooled<sphere>(point3(0, 2, 0), 1.0, red_mat));
 
     // 3. 贴近地面的立方体 (阴影较硬)
-    auto blue_mat = make_shared<lambertian>(color(0.2, 0.2, 0.8));
-    world.add(make_shared<box>(point3(-4, 0, -1), point3(-2, 2, 1), blue_mat));
+    auto blue_mat = make_pooled<lambertian>(color(0.2, 0.2, 0.8));
+    world.add(make_pooled<box>(point3(-4, 0, -1), point3(-2, 2, 1), blue_mat));
 
     // 4. 金属球 (反射面光源形状)
-    auto metal_mat = make_shared<metal>(color(0.8, 0.8, 0.8), 0.1);
-    world.add(make_shared<sphere>(point3(3.5, 1, 0), 1.0, metal_mat));
+    auto metal_mat = make_pooled<metal>(color(0.8, 0.8, 0.8), 0.1);
+    world.add(make_pooled<sphere>(point3(3.5, 1, 0), 1.0, metal_mat));
 
     // 5. 可见的面光源几何体 (用于直接观察)
     // 光源参数: Center(0, 8, 0), Size 4x4
     // Corner Q = (-2, 8, -2), u = (4, 0, 0), v = (0, 0, 4)
-    auto light_emit = make_shared<diffuse_light>(color(10, 10, 10));
+    auto light_emit = make_pooled<diffuse_light>(color(10, 10, 10));
     // 注意：xz_rect 默认法线向上(0,1,0)，我们需要它向下照，所以用 flip_face
-    world.add(make_shared<flip_face>(
-        make_shared<xz_rect>(-2, 2, -2, 2, 8, light_emit)));
+    world.add(make_pooled<flip_face>(
+        make_pooled<xz_rect>(-2, 2, -2, 2, 8, light_emit)));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> hdr_demo_scene() {
@@ -661,156 +674,158 @@ shared_ptr<hittable> hdr_demo_scene() {
 
     // 悬空球体展示
     // 1. 完美镜面 (Chrome)
-    auto chrome = make_shared<metal>(color(0.9, 0.9, 0.9), 0.0);
-    world.add(make_shared<sphere>(point3(-4, 1, 0), 1.0, chrome));
+    auto chrome = make_pooled<metal>(color(0.9, 0.9, 0.9), 0.0);
+    world.add(make_pooled<sphere>(point3(-4, 1, 0), 1.0, chrome));
 
     // 2. 粗糙金属 (Rough Gold)
-    auto rough_gold = make_shared<PBRMaterial>(
-        make_shared<solid_color>(1.0, 0.71, 0.29), // Gold
-        make_shared<solid_color>(0.2, 0.2, 0.2),   // Roughness
-        make_shared<solid_color>(1.0, 1.0, 1.0));  // Metallic
-    world.add(make_shared<sphere>(point3(0, 1, 0), 1.0, rough_gold));
+    auto rough_gold = make_pooled<PBRMaterial>(
+        make_pooled<solid_color>(1.0, 0.71, 0.29), // Gold
+        make_pooled<solid_color>(0.2, 0.2, 0.2),   // Roughness
+        make_pooled<solid_color>(1.0, 1.0, 1.0));  // Metallic
+    world.add(make_pooled<sphere>(point3(0, 1, 0), 1.0, rough_gold));
 
     // 3. 玻璃 (Glass)
-    auto glass = make_shared<dielectric>(1.5);
-    world.add(make_shared<sphere>(point3(4, 1, 0), 1.0, glass));
+    auto glass = make_pooled<dielectric>(1.5);
+    world.add(make_pooled<sphere>(point3(4, 1, 0), 1.0, glass));
 
     // 4. 漫反射 (Matte White)
-    // auto matte = make_shared<lambertian>(color(0.8, 0.8, 0.8));
-    // world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, matte)); // 地面
+    // auto matte = make_pooled<lambertian>(color(0.8, 0.8, 0.8));
+    // world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, matte)); // 地面
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> directional_light_scene() {
     hittable_list objects;
 
     // Ground
-    auto ground_material = make_shared<lambertian>(color(0.8, 0.8, 0.8));
+    auto ground_material = make_pooled<lambertian>(color(0.8, 0.8, 0.8));
     objects.add(
-        make_shared<sphere>(point3(0, -1000, 0), 1000, ground_material));
+        make_pooled<sphere>(point3(0, -1000, 0), 1000, ground_material));
 
     // Identical boxes to demonstrate parallel shadows
-    auto mat_red = make_shared<lambertian>(color(0.8, 0.1, 0.1));
-    auto mat_green = make_shared<lambertian>(color(0.1, 0.8, 0.1));
-    auto mat_blue = make_shared<lambertian>(color(0.1, 0.1, 0.8));
+    auto mat_red = make_pooled<lambertian>(color(0.8, 0.1, 0.1));
+    auto mat_green = make_pooled<lambertian>(color(0.1, 0.8, 0.1));
+    auto mat_blue = make_pooled<lambertian>(color(0.1, 0.1, 0.8));
 
     // Three tall boxes
     objects.add(
-        make_shared<box>(point3(-4, 0, -2), point3(-3, 3, -1), mat_red));
+        make_pooled<box>(point3(-4, 0, -2), point3(-3, 3, -1), mat_red));
     objects.add(
-        make_shared<box>(point3(-0.5, 0, -2), point3(0.5, 3, -1), mat_green));
-    objects.add(make_shared<box>(point3(3, 0, -2), point3(4, 3, -1), mat_blue));
+        make_pooled<box>(point3(-0.5, 0, -2), point3(0.5, 3, -1), mat_green));
+    objects.add(make_pooled<box>(point3(3, 0, -2), point3(4, 3, -1), mat_blue));
 
     // Ray Tracing features: Mirror and Glass
-    auto material_metal = make_shared<metal>(color(0.8, 0.8, 0.8), 0.0);
-    objects.add(make_shared<sphere>(point3(-2, 1, 2), 1.0, material_metal));
+    auto material_metal = make_pooled<metal>(color(0.8, 0.8, 0.8), 0.0);
+    objects.add(make_pooled<sphere>(point3(-2, 1, 2), 1.0, material_metal));
 
-    auto material_glass = make_shared<dielectric>(1.5);
-    objects.add(make_shared<sphere>(point3(2, 1, 2), 1.0, material_glass));
+    auto material_glass = make_pooled<dielectric>(1.5);
+    objects.add(make_pooled<sphere>(point3(2, 1, 2), 1.0, material_glass));
 
     // Floating sphere to show shadow on ground clearly
-    auto material_diffuse = make_shared<lambertian>(color(0.8, 0.5, 0.2));
-    objects.add(make_shared<sphere>(point3(0, 5, 0), 1.0, material_diffuse));
+    auto material_diffuse = make_pooled<lambertian>(color(0.8, 0.5, 0.2));
+    objects.add(make_pooled<sphere>(point3(0, 5, 0), 1.0, material_diffuse));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> spot_light_scene() {
     hittable_list objects;
 
-    auto ground = make_shared<lambertian>(color(0.5, 0.5, 0.5));
-    objects.add(make_shared<sphere>(point3(0, -1000, 0), 1000, ground));
+    auto ground = make_pooled<lambertian>(color(0.5, 0.5, 0.5));
+    objects.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, ground));
 
-    auto white = make_shared<lambertian>(color(0.9, 0.9, 0.9));
-    objects.add(make_shared<sphere>(point3(0, 1, 0), 1, white));
+    auto white = make_pooled<lambertian>(color(0.9, 0.9, 0.9));
+    objects.add(make_pooled<sphere>(point3(0, 1, 0), 1, white));
 
-    auto red = make_shared<lambertian>(color(0.8, 0.1, 0.1));
-    objects.add(make_shared<box>(point3(-2, 0, -1), point3(-1, 2, 0), red));
+    auto red = make_pooled<lambertian>(color(0.8, 0.1, 0.1));
+    objects.add(make_pooled<box>(point3(-2, 0, -1), point3(-1, 2, 0), red));
 
-    auto blue = make_shared<lambertian>(color(0.1, 0.1, 0.8));
-    objects.add(make_shared<box>(point3(1, 0, -1), point3(2, 2, 0), blue));
+    auto blue = make_pooled<lambertian>(color(0.1, 0.1, 0.8));
+    objects.add(make_pooled<box>(point3(1, 0, -1), point3(2, 2, 0), blue));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> environment_light_scene() {
     hittable_list objects;
 
     // Metal sphere to show reflection
-    auto material_metal = make_shared<metal>(color(0.8, 0.8, 0.8), 0.0);
-    objects.add(make_shared<sphere>(point3(-2, 1, 0), 1.0, material_metal));
+    auto material_metal = make_pooled<metal>(color(0.8, 0.8, 0.8), 0.0);
+    objects.add(make_pooled<sphere>(point3(-2, 1, 0), 1.0, material_metal));
 
     // Glass sphere to show refraction
-    auto material_glass = make_shared<dielectric>(1.5);
-    objects.add(make_shared<sphere>(point3(0, 1, 0), 1.0, material_glass));
+    auto material_glass = make_pooled<dielectric>(1.5);
+    objects.add(make_pooled<sphere>(point3(0, 1, 0), 1.0, material_glass));
 
     // Diffuse sphere to show lighting
-    auto material_diffuse = make_shared<lambertian>(color(0.8, 0.5, 0.2));
-    objects.add(make_shared<sphere>(point3(2, 1, 0), 1.0, material_diffuse));
+    auto material_diffuse = make_pooled<lambertian>(color(0.8, 0.5, 0.2));
+    objects.add(make_pooled<sphere>(point3(2, 1, 0), 1.0, material_diffuse));
 
     // Ground
-    auto ground_material = make_shared<lambertian>(color(0.5, 0.5, 0.5));
+    auto ground_material = make_pooled<lambertian>(color(0.5, 0.5, 0.5));
     objects.add(
-        make_shared<sphere>(point3(0, -1000, 0), 1000, ground_material));
+        make_pooled<sphere>(point3(0, -1000, 0), 1000, ground_material));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> quad_light_scene() {
     hittable_list objects;
 
-    auto ground = make_shared<lambertian>(color(0.5, 0.5, 0.5));
-    objects.add(make_shared<sphere>(point3(0, -1000, 0), 1000, ground));
+    auto ground = make_pooled<lambertian>(color(0.5, 0.5, 0.5));
+    objects.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, ground));
 
-    auto sphere_mat = make_shared<lambertian>(color(0.1, 0.2, 0.5));
-    objects.add(make_shared<sphere>(point3(0, 2, 0), 2, sphere_mat));
+    auto sphere_mat = make_pooled<lambertian>(color(0.1, 0.2, 0.5));
+    objects.add(make_pooled<sphere>(point3(0, 2, 0), 2, sphere_mat));
 
     // Visible light geometry (must match QuadLight parameters)
     // x: -2 to 2, z: -2 to 2, y: 7
     // Use flip_face to make the normal point downward (-Y)
-    auto light_mat = make_shared<diffuse_light>(color(15, 15, 15));
-    auto light_rect = make_shared<xz_rect>(-2, 2, -2, 2, 7, light_mat);
-    objects.add(make_shared<flip_face>(light_rect));
+    auto light_mat = make_pooled<diffuse_light>(color(15, 15, 15));
+    auto light_rect = make_pooled<xz_rect>(-2, 2, -2, 2, 7, light_mat);
+    objects.add(make_pooled<flip_face>(light_rect));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> cornell_box_nee() {
     hittable_list objects;
 
-    auto red = make_shared<lambertian>(color(.65, .05, .05));
-    auto white = make_shared<lambertian>(color(.73, .73, .73));
-    auto green = make_shared<lambertian>(color(.12, .45, .15));
-    auto light = make_shared<diffuse_light>(color(15, 15, 15));
+    auto red = make_pooled<lambertian>(color(.65, .05, .05));
+    auto white = make_pooled<lambertian>(color(.73, .73, .73));
+    auto green = make_pooled<lambertian>(color(.12, .45, .15));
+    auto light = make_pooled<diffuse_light>(color(15, 15, 15));
 
-    objects.add(make_shared<yz_rect>(0, 555, 0, 555, 555, green));
-    objects.add(make_shared<yz_rect>(0, 555, 0, 555, 0, red));
+    objects.add(make_pooled<yz_rect>(0, 555, 0, 555, 555, green));
+    objects.add(make_pooled<yz_rect>(0, 555, 0, 555, 0, red));
     // Flip face so light emits downward
-    objects.add(make_shared<flip_face>(
-        make_shared<xz_rect>(213, 343, 227, 332, 554, light)));
-    objects.add(make_shared<xz_rect>(0, 555, 0, 555, 0, white));
-    objects.add(make_shared<xz_rect>(0, 555, 0, 555, 555, white));
-    objects.add(make_shared<xy_rect>(0, 555, 0, 555, 555, white));
+    objects.add(make_pooled<flip_face>(
+        make_pooled<xz_rect>(213, 343, 227, 332, 554, light)));
+    objects.add(make_pooled<xz_rect>(0, 555, 0, 555, 0, white));
+    objects.add(make_pooled<xz_rect>(0, 555, 0, 555, 555, white));
+    objects.add(make_pooled<xy_rect>(0, 555, 0, 555, 555, white));
 
     shared_ptr<hittable> box1 =
-        make_shared<box>(point3(0, 0, 0), point3(165, 330, 165), white);
-    box1 = make_shared<rotate_y>(box1, 15);
-    box1 = make_shared<translate>(box1, vec3(265, 0, 295));
+        make_pooled<box>(point3(0, 0, 0), point3(165, 330, 165), white);
+    box1 = make_pooled<instance>(
+        box1, affine_transform::translation(vec3(265, 0, 295)) *
+                  affine_transform::rotation_y(15));
     objects.add(box1);
 
     shared_ptr<hittable> box2 =
-        make_shared<box>(point3(0, 0, 0), point3(165, 165, 165), white);
-    box2 = make_shared<rotate_y>(box2, -18);
-    box2 = make_shared<translate>(box2, vec3(130, 0, 65));
+        make_pooled<box>(point3(0, 0, 0), point3(165, 165, 165), white);
+    box2 = make_pooled<instance>(
+        box2, affine_transform::translation(vec3(130, 0, 65)) *
+                  affine_transform::rotation_y(-18));
     objects.add(box2);
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 shared_ptr<hittable> final_scene_nee() {
     hittable_list boxes1;
-    auto ground = make_shared<lambertian>(color(0.48, 0.83, 0.53));
+    auto ground = make_pooled<lambertian>(color(0.48, 0.83, 0.53));
 
     const int boxes_per_side = 20;
     for (int i = 0; i < boxes_per_side; i++) {
@@ -823,62 +838,63 @@ shared_ptr<hittable> final_scene_nee() {
             auto y1 = random_double(1, 101);
             auto z1 = z0 + w;
 
-            boxes1.add(make_shared<box>(point3(x0, y0, z0), point3(x1, y1, z1),
+            boxes1.add(make_pooled<box>(point3(x0, y0, z0), point3(x1, y1, z1),
                                         ground));
         }
     }
 
     hittable_list objects;
 
-    objects.add(make_shared<bvh_node>(boxes1, 0, 1));
+    objects.add(make_pooled<bvh_node>(boxes1, 0, 1));
 
-    auto light = make_shared<diffuse_light>(color(7, 7, 7));
+    auto light = make_pooled<diffuse_light>(color(7, 7, 7));
     // Flip face so light emits downward
-    objects.add(make_shared<flip_face>(
-        make_shared<xz_rect>(123, 423, 147, 412, 554, light)));
+    objects.add(make_pooled<flip_face>(
+        make_pooled<xz_rect>(123, 423, 147, 412, 554, light)));
 
     auto center1 = point3(400, 400, 200);
     auto center2 = center1 + vec3(30, 0, 0);
-    auto moving_sphere_material = make_shared<lambertian>(color(0.7, 0.3, 0.1));
-    objects.add(make_shared<moving_sphere>(center1, center2, 0, 1, 50,
+    auto moving_sphere_material = make_pooled<lambertian>(color(0.7, 0.3, 0.1));
+    objects.add(make_pooled<moving_sphere>(center1, center2, 0, 1, 50,
                                            moving_sphere_material));
 
-    objects.add(make_shared<sphere>(point3(260, 150, 45), 50,
-                                    make_shared<dielectric>(1.5)));
+    objects.add(make_pooled<sphere>(point3(260, 150, 45), 50,
+                                    make_pooled<dielectric>(1.5)));
     objects.add(
-        make_shared<sphere>(point3(0, 150, 145), 50,
-                            make_shared<metal>(color(0.8, 0.8, 0.9), 1.0)));
+        make_pooled<sphere>(point3(0, 150, 145), 50,
+                            make_pooled<metal>(color(0.8, 0.8, 0.9), 1.0)));
 
-    auto boundary = make_shared<sphere>(point3(360, 150, 145), 70,
-                                        make_shared<dielectric>(1.5));
+    auto boundary = make_pooled<sphere>(point3(360, 150, 145), 70,
+                                        make_pooled<dielectric>(1.5));
     objects.add(boundary);
     objects.add(
-        make_shared<constant_medium>(boundary, 0.2, color(0.2, 0.4, 0.9)));
+        make_pooled<constant_medium>(boundary, 0.2, color(0.2, 0.4, 0.9)));
 
-    boundary = make_shared<sphere>(point3(0, 0, 0), 5000,
-                                   make_shared<dielectric>(1.5));
-    objects.add(make_shared<constant_medium>(boundary, .0001, color(1, 1, 1)));
+    boundary = make_pooled<sphere>(point3(0, 0, 0), 5000,
+                                   make_pooled<dielectric>(1.5));
+    objects.add(make_pooled<constant_medium>(boundary, .0001, color(1, 1, 1)));
 
     auto emat =
-        make_shared<lambertian>(make_shared<image_texture>("earthmap.jpg"));
-    objects.add(make_shared<sphere>(point3(400, 200, 400), 100, emat));
+        make_pooled<lambertian>(make_pooled<image_texture>("earthmap.jpg"));
+    objects.add(make_pooled<sphere>(point3(400, 200, 400), 100, emat));
 
-    auto pertext = make_shared<noise_texture>(0.1);
-    objects.add(make_shared<sphere>(point3(220, 280, 300), 80,
-                                    make_shared<lambertian>(pertext)));
+    auto pertext = make_pooled<noise_texture>(0.1);
+    objects.add(make_pooled<sphere>(point3(220, 280, 300), 80,
+                                    make_pooled<lambertian>(pertext)));
 
     hittable_list boxes2;
-    auto white = make_shared<lambertian>(color(.73, .73, .73));
+    auto white = make_pooled<lambertian>(color(.73, .73, .73));
     int ns = 1000;
     for (int j = 0; j < ns; j++) {
-        boxes2.add(make_shared<sphere>(point3::random(0, 165), 10, white));
+        boxes2.add(make_pooled<sphere>(point3::random(0, 165), 10, white));
     }
 
-    objects.add(make_shared<translate>(
-        make_shared<rotate_y>(make_shared<bvh_node>(boxes2, 0.0, 1.0), 15),
-        vec3(-100, 270, 395)));
+    objects.add(make_pooled<instance>(
+        make_blas(boxes2, 0.0, 1.0),
+        affine_transform::translation(vec3(-100, 270, 395)) *
+            affine_transform::rotation_y(15)));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 // ============================================================================
@@ -891,57 +907,57 @@ shared_ptr<hittable> materials_showcase() {
     hittable_list world;
 
     // 地面：棋盘格纹理
-    auto checker = make_shared<checker_texture>(color(0.1, 0.1, 0.1),
+    auto checker = make_pooled<checker_texture>(color(0.1, 0.1, 0.1),
                                                 color(0.9, 0.9, 0.9));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000,
-                                  make_shared<lambertian>(checker)));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000,
+                                  make_pooled<lambertian>(checker)));
 
     // 中心：大玻璃球 - 展示折射和全内反射
-    auto glass = make_shared<dielectric>(1.5);
-    world.add(make_shared<sphere>(point3(0, 1.5, 0), 1.5, glass));
+    auto glass = make_pooled<dielectric>(1.5);
+    world.add(make_pooled<sphere>(point3(0, 1.5, 0), 1.5, glass));
     // 玻璃球内部的小球，增加视觉效果
-    world.add(make_shared<sphere>(point3(0, 1.5, 0), -1.4, glass));
+    world.add(make_pooled<sphere>(point3(0, 1.5, 0), -1.4, glass));
 
     // 左侧：完美镜面金属球
-    auto mirror = make_shared<metal>(color(0.95, 0.95, 0.95), 0.0);
-    world.add(make_shared<sphere>(point3(-4, 1, 0), 1.0, mirror));
+    auto mirror = make_pooled<metal>(color(0.95, 0.95, 0.95), 0.0);
+    world.add(make_pooled<sphere>(point3(-4, 1, 0), 1.0, mirror));
 
     // 右侧：金色PBR金属球
-    auto gold = make_shared<PBRMaterial>(
-        make_shared<solid_color>(1.0, 0.766, 0.336), // Gold albedo
-        make_shared<solid_color>(0.1, 0.1, 0.1),     // Low roughness
-        make_shared<solid_color>(1.0, 1.0, 1.0));    // Full metallic
-    world.add(make_shared<sphere>(point3(4, 1, 0), 1.0, gold));
+    auto gold = make_pooled<PBRMaterial>(
+        make_pooled<solid_color>(1.0, 0.766, 0.336), // Gold albedo
+        make_pooled<solid_color>(0.1, 0.1, 0.1),     // Low roughness
+        make_pooled<solid_color>(1.0, 1.0, 1.0));    // Full metallic
+    world.add(make_pooled<sphere>(point3(4, 1, 0), 1.0, gold));
 
     // 后排左：铜色粗糙金属
     auto copper =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.955, 0.638, 0.538),
-                                 make_shared<solid_color>(0.4, 0.4, 0.4),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(-2.5, 0.7, -3), 0.7, copper));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.955, 0.638, 0.538),
+                                 make_pooled<solid_color>(0.4, 0.4, 0.4),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(-2.5, 0.7, -3), 0.7, copper));
 
     // 后排中：蓝色塑料（非金属PBR）
     auto blue_plastic =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.1, 0.2, 0.8),
-                                 make_shared<solid_color>(0.05, 0.05, 0.05),
-                                 make_shared<solid_color>(0.0, 0.0, 0.0));
-    world.add(make_shared<sphere>(point3(0, 0.7, -3), 0.7, blue_plastic));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.1, 0.2, 0.8),
+                                 make_pooled<solid_color>(0.05, 0.05, 0.05),
+                                 make_pooled<solid_color>(0.0, 0.0, 0.0));
+    world.add(make_pooled<sphere>(point3(0, 0.7, -3), 0.7, blue_plastic));
 
     // 后排右：红色漫反射
-    auto red_diffuse = make_shared<lambertian>(color(0.8, 0.1, 0.1));
-    world.add(make_shared<sphere>(point3(2.5, 0.7, -3), 0.7, red_diffuse));
+    auto red_diffuse = make_pooled<lambertian>(color(0.8, 0.1, 0.1));
+    world.add(make_pooled<sphere>(point3(2.5, 0.7, -3), 0.7, red_diffuse));
 
     // 前排小球：不同粗糙度的银色金属
     for (int i = 0; i < 5; ++i) {
         double roughness = i * 0.25;
-        auto mat = make_shared<PBRMaterial>(
-            make_shared<solid_color>(0.9, 0.9, 0.9),
-            make_shared<solid_color>(roughness, roughness, roughness),
-            make_shared<solid_color>(1.0, 1.0, 1.0));
-        world.add(make_shared<sphere>(point3(-3 + i * 1.5, 0.4, 3), 0.4, mat));
+        auto mat = make_pooled<PBRMaterial>(
+            make_pooled<solid_color>(0.9, 0.9, 0.9),
+            make_pooled<solid_color>(roughness, roughness, roughness),
+            make_pooled<solid_color>(1.0, 1.0, 1.0));
+        world.add(make_pooled<sphere>(point3(-3 + i * 1.5, 0.4, 3), 0.4, mat));
     }
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 // Scene 2: Cornell Box Extended - 扩展康奈尔盒
@@ -949,39 +965,40 @@ shared_ptr<hittable> materials_showcase() {
 shared_ptr<hittable> cornell_box_extended() {
     hittable_list objects;
 
-    auto red = make_shared<lambertian>(color(.65, .05, .05));
-    auto white = make_shared<lambertian>(color(.73, .73, .73));
-    auto green = make_shared<lambertian>(color(.12, .45, .15));
-    auto light = make_shared<diffuse_light>(color(15, 15, 15));
+    auto red = make_pooled<lambertian>(color(.65, .05, .05));
+    auto white = make_pooled<lambertian>(color(.73, .73, .73));
+    auto green = make_pooled<lambertian>(color(.12, .45, .15));
+    auto light = make_pooled<diffuse_light>(color(15, 15, 15));
 
     // 墙壁
-    objects.add(make_shared<yz_rect>(0, 555, 0, 555, 555, green)); // 左墙
-    objects.add(make_shared<yz_rect>(0, 555, 0, 555, 0, red));     // 右墙
-    objects.add(make_shared<flip_face>(
-        make_shared<xz_rect>(213, 343, 227, 332, 554, light)));    // 顶灯
-    objects.add(make_shared<xz_rect>(0, 555, 0, 555, 0, white));   // 地板
-    objects.add(make_shared<xz_rect>(0, 555, 0, 555, 555, white)); // 天花板
-    objects.add(make_shared<xy_rect>(0, 555, 0, 555, 555, white)); // 后墙
+    objects.add(make_pooled<yz_rect>(0, 555, 0, 555, 555, green)); // 左墙
+    objects.add(make_pooled<yz_rect>(0, 555, 0, 555, 0, red));     // 右墙
+    objects.add(make_pooled<flip_face>(
+        make_pooled<xz_rect>(213, 343, 227, 332, 554, light)));    // 顶灯
+    objects.add(make_pooled<xz_rect>(0, 555, 0, 555, 0, white));   // 地板
+    objects.add(make_pooled<xz_rect>(0, 555, 0, 555, 555, white)); // 天花板
+    objects.add(make_pooled<xy_rect>(0, 555, 0, 555, 555, white)); // 后墙
 
     // 左侧：高的白色盒子
     shared_ptr<hittable> box1 =
-        make_shared<box>(point3(0, 0, 0), point3(165, 330, 165), white);
-    box1 = make_shared<rotate_y>(box1, 15);
-    box1 = make_shared<translate>(box1, vec3(265, 0, 295));
+        make_pooled<box>(point3(0, 0, 0), point3(165, 330, 165), white);
+    box1 = make_pooled<instance>(
+        box1, affine_transform::translation(vec3(265, 0, 295)) *
+                  affine_transform::rotation_y(15));
     objects.add(box1);
 
     // 右侧：玻璃球代替原来的小盒子
-    auto glass = make_shared<dielectric>(1.5);
-    objects.add(make_shared<sphere>(point3(190, 90, 190), 90, glass));
+    auto glass = make_pooled<dielectric>(1.5);
+    objects.add(make_pooled<sphere>(point3(190, 90, 190), 90, glass));
 
     // 添加一个金属球在盒子上
     auto gold =
-        make_shared<PBRMaterial>(make_shared<solid_color>(1.0, 0.766, 0.336),
-                                 make_shared<solid_color>(0.15, 0.15, 0.15),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    objects.add(make_shared<sphere>(point3(350, 380, 350), 50, gold));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(1.0, 0.766, 0.336),
+                                 make_pooled<solid_color>(0.15, 0.15, 0.15),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    objects.add(make_pooled<sphere>(point3(350, 380, 350), 50, gold));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 // Scene 3: Interior Lighting Scene - 室内照明场景
@@ -990,69 +1007,69 @@ shared_ptr<hittable> interior_lighting_scene() {
     hittable_list objects;
 
     // 地板
-    auto floor_mat = make_shared<PBRMaterial>(
-        make_shared<solid_color>(0.3, 0.2, 0.15), // 木地板色
-        make_shared<solid_color>(0.6, 0.6, 0.6),
-        make_shared<solid_color>(0.0, 0.0, 0.0));
-    objects.add(make_shared<xz_rect>(-10, 10, -10, 10, 0, floor_mat));
+    auto floor_mat = make_pooled<PBRMaterial>(
+        make_pooled<solid_color>(0.3, 0.2, 0.15), // 木地板色
+        make_pooled<solid_color>(0.6, 0.6, 0.6),
+        make_pooled<solid_color>(0.0, 0.0, 0.0));
+    objects.add(make_pooled<xz_rect>(-10, 10, -10, 10, 0, floor_mat));
 
     // 后墙
-    auto wall_mat = make_shared<lambertian>(color(0.9, 0.9, 0.85));
-    objects.add(make_shared<xy_rect>(-10, 10, 0, 8, -5, wall_mat));
+    auto wall_mat = make_pooled<lambertian>(color(0.9, 0.9, 0.85));
+    objects.add(make_pooled<xy_rect>(-10, 10, 0, 8, -5, wall_mat));
 
     // 左墙
-    objects.add(make_shared<yz_rect>(0, 8, -5, 10, -10, wall_mat));
+    objects.add(make_pooled<yz_rect>(0, 8, -5, 10, -10, wall_mat));
 
     // 右墙
-    objects.add(make_shared<yz_rect>(0, 8, -5, 10, 10, wall_mat));
+    objects.add(make_pooled<yz_rect>(0, 8, -5, 10, 10, wall_mat));
 
     // 天花板
-    auto ceiling_mat = make_shared<lambertian>(color(0.95, 0.95, 0.95));
-    objects.add(make_shared<xz_rect>(-10, 10, -5, 10, 8, ceiling_mat));
+    auto ceiling_mat = make_pooled<lambertian>(color(0.95, 0.95, 0.95));
+    objects.add(make_pooled<xz_rect>(-10, 10, -5, 10, 8, ceiling_mat));
 
     // 中央桌子（简化为一个扁盒子）
     auto table_mat =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.4, 0.25, 0.1),
-                                 make_shared<solid_color>(0.3, 0.3, 0.3),
-                                 make_shared<solid_color>(0.0, 0.0, 0.0));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.4, 0.25, 0.1),
+                                 make_pooled<solid_color>(0.3, 0.3, 0.3),
+                                 make_pooled<solid_color>(0.0, 0.0, 0.0));
     objects.add(
-        make_shared<box>(point3(-2, 0, -1), point3(2, 1, 3), table_mat));
+        make_pooled<box>(point3(-2, 0, -1), point3(2, 1, 3), table_mat));
 
     // 桌上物品
     // 1. 镜面金属球
-    auto chrome = make_shared<metal>(color(0.9, 0.9, 0.9), 0.0);
-    objects.add(make_shared<sphere>(point3(-1, 1.5, 1), 0.5, chrome));
+    auto chrome = make_pooled<metal>(color(0.9, 0.9, 0.9), 0.0);
+    objects.add(make_pooled<sphere>(point3(-1, 1.5, 1), 0.5, chrome));
 
     // 2. 玻璃杯（简化为球）
-    auto glass = make_shared<dielectric>(1.5);
-    objects.add(make_shared<sphere>(point3(0.5, 1.4, 1.5), 0.4, glass));
+    auto glass = make_pooled<dielectric>(1.5);
+    objects.add(make_pooled<sphere>(point3(0.5, 1.4, 1.5), 0.4, glass));
 
     // 3. 红色花瓶（简化为球）
     auto red_ceramic =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.7, 0.1, 0.1),
-                                 make_shared<solid_color>(0.2, 0.2, 0.2),
-                                 make_shared<solid_color>(0.0, 0.0, 0.0));
-    objects.add(make_shared<sphere>(point3(1, 1.6, 0.5), 0.6, red_ceramic));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.7, 0.1, 0.1),
+                                 make_pooled<solid_color>(0.2, 0.2, 0.2),
+                                 make_pooled<solid_color>(0.0, 0.0, 0.0));
+    objects.add(make_pooled<sphere>(point3(1, 1.6, 0.5), 0.6, red_ceramic));
 
     // 墙上的装饰：小金属球阵列
     for (int i = 0; i < 3; ++i) {
         for (int j = 0; j < 3; ++j) {
-            auto metal_mat = make_shared<PBRMaterial>(
-                make_shared<solid_color>(0.8, 0.8, 0.8),
-                make_shared<solid_color>(0.1 + j * 0.2, 0.1 + j * 0.2,
+            auto metal_mat = make_pooled<PBRMaterial>(
+                make_pooled<solid_color>(0.8, 0.8, 0.8),
+                make_pooled<solid_color>(0.1 + j * 0.2, 0.1 + j * 0.2,
                                          0.1 + j * 0.2),
-                make_shared<solid_color>(1.0, 1.0, 1.0));
-            objects.add(make_shared<sphere>(
+                make_pooled<solid_color>(1.0, 1.0, 1.0));
+            objects.add(make_pooled<sphere>(
                 point3(-4 + i * 2, 3 + j * 1.2, -4.8), 0.3, metal_mat));
         }
     }
 
     // 天花板灯（发光矩形）
-    auto ceiling_light = make_shared<diffuse_light>(color(8, 8, 7));
-    objects.add(make_shared<flip_face>(
-        make_shared<xz_rect>(-1, 1, 0, 2, 7.99, ceiling_light)));
+    auto ceiling_light = make_pooled<diffuse_light>(color(8, 8, 7));
+    objects.add(make_pooled<flip_face>(
+        make_pooled<xz_rect>(-1, 1, 0, 2, 7.99, ceiling_light)));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 // Scene 4: Jewelry Display - 珠宝展示台
@@ -1061,68 +1078,68 @@ shared_ptr<hittable> jewelry_display() {
     hittable_list world;
 
     // 展示台底座
-    auto pedestal_mat = make_shared<PBRMaterial>(
-        make_shared<solid_color>(0.02, 0.02, 0.02), // 近乎黑色
-        make_shared<solid_color>(0.1, 0.1, 0.1),    // 低粗糙度，有光泽
-        make_shared<solid_color>(0.0, 0.0, 0.0));
+    auto pedestal_mat = make_pooled<PBRMaterial>(
+        make_pooled<solid_color>(0.02, 0.02, 0.02), // 近乎黑色
+        make_pooled<solid_color>(0.1, 0.1, 0.1),    // 低粗糙度，有光泽
+        make_pooled<solid_color>(0.0, 0.0, 0.0));
     // 圆形底座用多个同心圆球模拟
-    world.add(make_shared<sphere>(point3(0, -100, 0), 100.3, pedestal_mat));
+    world.add(make_pooled<sphere>(point3(0, -100, 0), 100.3, pedestal_mat));
 
     // 中心：钻石（用玻璃球模拟，折射率高一点）
-    auto diamond = make_shared<dielectric>(2.4); // 钻石折射率约2.4
-    world.add(make_shared<sphere>(point3(0, 1.2, 0), 1.0, diamond));
+    auto diamond = make_pooled<dielectric>(2.4); // 钻石折射率约2.4
+    world.add(make_pooled<sphere>(point3(0, 1.2, 0), 1.0, diamond));
     // 内部空心增加闪烁效果
-    world.add(make_shared<sphere>(point3(0, 1.2, 0), -0.6, diamond));
+    world.add(make_pooled<sphere>(point3(0, 1.2, 0), -0.6, diamond));
 
     // 左侧：金戒指（用金色球模拟）
     auto gold =
-        make_shared<PBRMaterial>(make_shared<solid_color>(1.0, 0.766, 0.336),
-                                 make_shared<solid_color>(0.1, 0.1, 0.1),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(-2.5, 0.6, 0), 0.6, gold));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(1.0, 0.766, 0.336),
+                                 make_pooled<solid_color>(0.1, 0.1, 0.1),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(-2.5, 0.6, 0), 0.6, gold));
     // 戒指上的小钻石
-    world.add(make_shared<sphere>(point3(-2.5, 1.25, 0), 0.2, diamond));
+    world.add(make_pooled<sphere>(point3(-2.5, 1.25, 0), 0.2, diamond));
 
     // 右侧：银项链球
     auto silver =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.97, 0.96, 0.91),
-                                 make_shared<solid_color>(0.15, 0.15, 0.15),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(2.5, 0.5, 0), 0.5, silver));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.97, 0.96, 0.91),
+                                 make_pooled<solid_color>(0.15, 0.15, 0.15),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(2.5, 0.5, 0), 0.5, silver));
 
     // 后排装饰球
     // 玫瑰金
     auto rose_gold =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.92, 0.72, 0.65),
-                                 make_shared<solid_color>(0.2, 0.2, 0.2),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(-1.5, 0.4, -2), 0.4, rose_gold));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.92, 0.72, 0.65),
+                                 make_pooled<solid_color>(0.2, 0.2, 0.2),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(-1.5, 0.4, -2), 0.4, rose_gold));
 
     // 铂金
     auto platinum =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.9, 0.89, 0.87),
-                                 make_shared<solid_color>(0.05, 0.05, 0.05),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(0, 0.35, -2.2), 0.35, platinum));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.9, 0.89, 0.87),
+                                 make_pooled<solid_color>(0.05, 0.05, 0.05),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(0, 0.35, -2.2), 0.35, platinum));
 
     // 铜
     auto copper =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.955, 0.638, 0.538),
-                                 make_shared<solid_color>(0.25, 0.25, 0.25),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(1.5, 0.4, -2), 0.4, copper));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.955, 0.638, 0.538),
+                                 make_pooled<solid_color>(0.25, 0.25, 0.25),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(1.5, 0.4, -2), 0.4, copper));
 
     // 前排小珍珠
-    auto pearl = make_shared<PBRMaterial>(
-        make_shared<solid_color>(0.95, 0.93, 0.88),
-        make_shared<solid_color>(0.3, 0.3, 0.3),
-        make_shared<solid_color>(0.0, 0.0, 0.0)); // 珍珠是非金属
+    auto pearl = make_pooled<PBRMaterial>(
+        make_pooled<solid_color>(0.95, 0.93, 0.88),
+        make_pooled<solid_color>(0.3, 0.3, 0.3),
+        make_pooled<solid_color>(0.0, 0.0, 0.0)); // 珍珠是非金属
     for (int i = 0; i < 5; ++i) {
         world.add(
-            make_shared<sphere>(point3(-1.5 + i * 0.75, 0.2, 2), 0.2, pearl));
+            make_pooled<sphere>(point3(-1.5 + i * 0.75, 0.2, 2), 0.2, pearl));
     }
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 // Scene 4 Simplified: Jewelry Display Simplified - 珠宝展示台（简化版）
@@ -1131,62 +1148,62 @@ shared_ptr<hittable> jewelry_display_simplified() {
     hittable_list world;
 
     // 展示台底座
-    auto pedestal_mat = make_shared<PBRMaterial>(
-        make_shared<solid_color>(0.02, 0.02, 0.02), // 近乎黑色
-        make_shared<solid_color>(0.1, 0.1, 0.1),    // 低粗糙度，有光泽
-        make_shared<solid_color>(0.0, 0.0, 0.0));
+    auto pedestal_mat = make_pooled<PBRMaterial>(
+        make_pooled<solid_color>(0.02, 0.02, 0.02), // 近乎黑色
+        make_pooled<solid_color>(0.1, 0.1, 0.1),    // 低粗糙度，有光泽
+        make_pooled<solid_color>(0.0, 0.0, 0.0));
     // 圆形底座用多个同心圆球模拟
-    world.add(make_shared<sphere>(point3(0, -100, 0), 100.3, pedestal_mat));
+    world.add(make_pooled<sphere>(point3(0, -100, 0), 100.3, pedestal_mat));
 
     // 中心：钻石（用玻璃球模拟，折射率高一点）
-    auto diamond = make_shared<dielectric>(2.4); // 钻石折射率约2.4
-    world.add(make_shared<sphere>(point3(0, 1.2, 0), 1.0, diamond));
+    auto diamond = make_pooled<dielectric>(2.4); // 钻石折射率约2.4
+    world.add(make_pooled<sphere>(point3(0, 1.2, 0), 1.0, diamond));
     // 内部空心增加闪烁效果
-    world.add(make_shared<sphere>(point3(0, 1.2, 0), -0.6, diamond));
+    world.add(make_pooled<sphere>(point3(0, 1.2, 0), -0.6, diamond));
 
     // 左侧：金戒指（用金色球模拟）
     auto gold =
-        make_shared<PBRMaterial>(make_shared<solid_color>(1.0, 0.766, 0.336),
-                                 make_shared<solid_color>(0.1, 0.1, 0.1),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(-2.5, 0.6, 0), 0.6, gold));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(1.0, 0.766, 0.336),
+                                 make_pooled<solid_color>(0.1, 0.1, 0.1),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(-2.5, 0.6, 0), 0.6, gold));
 
     // 戒指上的小钻石 -> 移到地面单独展示
     // 放在金戒指前面一点，地面上 (y=0.5, radius=0.2) - 调整高度以避免陷入底座
-    world.add(make_shared<sphere>(point3(-2.5, 0.5, 1.5), 0.2, diamond));
+    world.add(make_pooled<sphere>(point3(-2.5, 0.5, 1.5), 0.2, diamond));
 
     // 右侧：银项链球
     auto silver =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.97, 0.96, 0.91),
-                                 make_shared<solid_color>(0.15, 0.15, 0.15),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(2.5, 0.5, 0), 0.5, silver));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.97, 0.96, 0.91),
+                                 make_pooled<solid_color>(0.15, 0.15, 0.15),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(2.5, 0.5, 0), 0.5, silver));
 
     // 后排装饰球
     // 玫瑰金
     auto rose_gold =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.92, 0.72, 0.65),
-                                 make_shared<solid_color>(0.2, 0.2, 0.2),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(-1.5, 0.4, -2), 0.4, rose_gold));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.92, 0.72, 0.65),
+                                 make_pooled<solid_color>(0.2, 0.2, 0.2),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(-1.5, 0.4, -2), 0.4, rose_gold));
 
     // 铂金
     auto platinum =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.9, 0.89, 0.87),
-                                 make_shared<solid_color>(0.05, 0.05, 0.05),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(0, 0.35, -2.2), 0.35, platinum));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.9, 0.89, 0.87),
+                                 make_pooled<solid_color>(0.05, 0.05, 0.05),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(0, 0.35, -2.2), 0.35, platinum));
 
     // 铜
     auto copper =
-        make_shared<PBRMaterial>(make_shared<solid_color>(0.955, 0.638, 0.538),
-                                 make_shared<solid_color>(0.25, 0.25, 0.25),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(1.5, 0.4, -2), 0.4, copper));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(0.955, 0.638, 0.538),
+                                 make_pooled<solid_color>(0.25, 0.25, 0.25),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(1.5, 0.4, -2), 0.4, copper));
 
     // 前排小珍珠 -> 已移除
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 // Scene 5: Glass Caustics Scene - 玻璃焦散场景
@@ -1195,48 +1212,48 @@ shared_ptr<hittable> glass_caustics_scene() {
     hittable_list objects;
 
     // 白色地面，便于观察caustics
-    auto white_ground = make_shared<lambertian>(color(0.9, 0.9, 0.9));
-    objects.add(make_shared<sphere>(point3(0, -1000, 0), 1000, white_ground));
+    auto white_ground = make_pooled<lambertian>(color(0.9, 0.9, 0.9));
+    objects.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, white_ground));
 
     // 后墙
-    objects.add(make_shared<xy_rect>(-10, 10, 0, 10, -5, white_ground));
+    objects.add(make_pooled<xy_rect>(-10, 10, 0, 10, -5, white_ground));
 
     // 大玻璃球
-    auto glass = make_shared<dielectric>(1.5);
-    objects.add(make_shared<sphere>(point3(0, 2, 0), 2, glass));
+    auto glass = make_pooled<dielectric>(1.5);
+    objects.add(make_pooled<sphere>(point3(0, 2, 0), 2, glass));
 
     // 小玻璃球阵列
     for (int i = 0; i < 3; ++i) {
         objects.add(
-            make_shared<sphere>(point3(-3 + i * 3, 0.8, 3), 0.8, glass));
+            make_pooled<sphere>(point3(-3 + i * 3, 0.8, 3), 0.8, glass));
     }
 
     // 彩色玻璃球
     // 红色玻璃（用带颜色的金属模拟彩色玻璃效果）
-    auto red_glass = make_shared<dielectric>(1.5);
-    objects.add(make_shared<sphere>(point3(-4, 1, -2), 1.0, red_glass));
+    auto red_glass = make_pooled<dielectric>(1.5);
+    objects.add(make_pooled<sphere>(point3(-4, 1, -2), 1.0, red_glass));
 
     // 水晶球（高折射率）
-    auto crystal = make_shared<dielectric>(2.0);
-    objects.add(make_shared<sphere>(point3(4, 1.2, -1.5), 1.2, crystal));
-    objects.add(make_shared<sphere>(point3(4, 1.2, -1.5), -1.0, crystal));
+    auto crystal = make_pooled<dielectric>(2.0);
+    objects.add(make_pooled<sphere>(point3(4, 1.2, -1.5), 1.2, crystal));
+    objects.add(make_pooled<sphere>(point3(4, 1.2, -1.5), -1.0, crystal));
 
     // 金属球作为对比
-    auto mirror = make_shared<metal>(color(0.95, 0.95, 0.95), 0.0);
-    objects.add(make_shared<sphere>(point3(-4, 0.7, 2), 0.7, mirror));
+    auto mirror = make_pooled<metal>(color(0.95, 0.95, 0.95), 0.0);
+    objects.add(make_pooled<sphere>(point3(-4, 0.7, 2), 0.7, mirror));
 
     auto gold =
-        make_shared<PBRMaterial>(make_shared<solid_color>(1.0, 0.766, 0.336),
-                                 make_shared<solid_color>(0.1, 0.1, 0.1),
-                                 make_shared<solid_color>(1.0, 1.0, 1.0));
-    objects.add(make_shared<sphere>(point3(4, 0.6, 2.5), 0.6, gold));
+        make_pooled<PBRMaterial>(make_pooled<solid_color>(1.0, 0.766, 0.336),
+                                 make_pooled<solid_color>(0.1, 0.1, 0.1),
+                                 make_pooled<solid_color>(1.0, 1.0, 1.0));
+    objects.add(make_pooled<sphere>(point3(4, 0.6, 2.5), 0.6, gold));
 
     // 顶部面光源
-    auto light = make_shared<diffuse_light>(color(12, 12, 12));
+    auto light = make_pooled<diffuse_light>(color(12, 12, 12));
     objects.add(
-        make_shared<flip_face>(make_shared<xz_rect>(-3, 3, -3, 3, 10, light)));
+        make_pooled<flip_face>(make_pooled<xz_rect>(-3, 3, -3, 3, 10, light)));
 
-    return make_shared<bvh_node>(objects, 0, 1);
+    return make_pooled<bvh_node>(objects, 0, 1);
 }
 
 // Scene 6: PBR Texture Demo - PBR 贴图演示
@@ -1247,57 +1264,57 @@ shared_ptr<hittable> pbr_texture_demo() {
     // 1. Oak Floor (Non-Metal)
     // 注意：路径相对于 build/ 目录
     auto oak_albedo =
-        make_shared<image_texture>("tex/oak/oak_veneer_01_diff_1k.png");
+        make_pooled<image_texture>("tex/oak/oak_veneer_01_diff_1k.png");
     auto oak_rough =
-        make_shared<image_texture>("tex/oak/oak_veneer_01_rough_1k.png");
+        make_pooled<image_texture>("tex/oak/oak_veneer_01_rough_1k.png");
     auto oak_normal =
-        make_shared<image_texture>("tex/oak/oak_veneer_01_nor_dx_1k.png");
+        make_pooled<image_texture>("tex/oak/oak_veneer_01_nor_dx_1k.png");
     auto oak_metal =
-        make_shared<solid_color>(0.0, 0.0, 0.0); // Wood is non-metal
+        make_pooled<solid_color>(0.0, 0.0, 0.0); // Wood is non-metal
 
     auto mat_oak =
-        make_shared<PBRMaterial>(oak_albedo, oak_rough, oak_metal, oak_normal);
+        make_pooled<PBRMaterial>(oak_albedo, oak_rough, oak_metal, oak_normal);
 
     // Floor plane (20x20)
-    world.add(make_shared<xz_rect>(-10, 10, -10, 10, 0, mat_oak));
+    world.add(make_pooled<xz_rect>(-10, 10, -10, 10, 0, mat_oak));
 
     // 2. Brick Wall (Non-Metal)
     auto brick_albedo =
-        make_shared<image_texture>("tex/brick/red_brick_diff_1k.png");
+        make_pooled<image_texture>("tex/brick/red_brick_diff_1k.png");
     auto brick_rough =
-        make_shared<image_texture>("tex/brick/red_brick_rough_1k.png");
+        make_pooled<image_texture>("tex/brick/red_brick_rough_1k.png");
     auto brick_normal =
-        make_shared<image_texture>("tex/brick/red_brick_nor_dx_1k.png");
-    auto brick_metal = make_shared<solid_color>(0.0, 0.0, 0.0);
+        make_pooled<image_texture>("tex/brick/red_brick_nor_dx_1k.png");
+    auto brick_metal = make_pooled<solid_color>(0.0, 0.0, 0.0);
 
-    auto mat_brick = make_shared<PBRMaterial>(brick_albedo, brick_rough,
+    auto mat_brick = make_pooled<PBRMaterial>(brick_albedo, brick_rough,
                                               brick_metal, brick_normal);
 
     // Wall box
     world.add(
-        make_shared<box>(point3(-5, 0, -5), point3(-2, 3, -2), mat_brick));
+        make_pooled<box>(point3(-5, 0, -5), point3(-2, 3, -2), mat_brick));
 
     // 3. Rusted Metal Sphere (Metal)
     auto rust_albedo =
-        make_shared<image_texture>("tex/rust/rusty_metal_04_diff_1k.png");
+        make_pooled<image_texture>("tex/rust/rusty_metal_04_diff_1k.png");
     auto rust_rough =
-        make_shared<image_texture>("tex/rust/rusty_metal_04_rough_1k.png");
+        make_pooled<image_texture>("tex/rust/rusty_metal_04_rough_1k.png");
     auto rust_metal =
-        make_shared<image_texture>("tex/rust/rusty_metal_04_metal_1k.png");
+        make_pooled<image_texture>("tex/rust/rusty_metal_04_metal_1k.png");
     auto rust_normal =
-        make_shared<image_texture>("tex/rust/rusty_metal_04_nor_dx_1k.png");
+        make_pooled<image_texture>("tex/rust/rusty_metal_04_nor_dx_1k.png");
 
-    auto mat_rust = make_shared<PBRMaterial>(rust_albedo, rust_rough,
+    auto mat_rust = make_pooled<PBRMaterial>(rust_albedo, rust_rough,
                                              rust_metal, rust_normal);
 
-    world.add(make_shared<sphere>(point3(2, 1.5, 2), 1.5, mat_rust));
+    world.add(make_pooled<sphere>(point3(2, 1.5, 2), 1.5, mat_rust));
 
     // Lights
-    auto light_mat = make_shared<diffuse_light>(color(15, 15, 15));
-    world.add(make_shared<sphere>(point3(0, 10, 5), 2, light_mat));
-    world.add(make_shared<sphere>(point3(-5, 5, 5), 1, light_mat));
+    auto light_mat = make_pooled<diffuse_light>(color(15, 15, 15));
+    world.add(make_pooled<sphere>(point3(0, 10, 5), 2, light_mat));
+    world.add(make_pooled<sphere>(point3(-5, 5, 5), 1, light_mat));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 // Scene 7: PBR Floating Spheres with Environment Light
@@ -1307,55 +1324,55 @@ shared_ptr<hittable> pbr_floating_spheres_env() {
 
     // 1. Oak Sphere (Left)
     auto oak_albedo =
-        make_shared<image_texture>("tex/oak/oak_veneer_01_diff_1k.png");
+        make_pooled<image_texture>("tex/oak/oak_veneer_01_diff_1k.png");
     auto oak_rough =
-        make_shared<image_texture>("tex/oak/oak_veneer_01_rough_1k.png");
+        make_pooled<image_texture>("tex/oak/oak_veneer_01_rough_1k.png");
     auto oak_normal =
-        make_shared<image_texture>("tex/oak/oak_veneer_01_nor_dx_1k.png");
-    auto oak_metal = make_shared<solid_color>(0.0, 0.0, 0.0);
+        make_pooled<image_texture>("tex/oak/oak_veneer_01_nor_dx_1k.png");
+    auto oak_metal = make_pooled<solid_color>(0.0, 0.0, 0.0);
     auto mat_oak =
-        make_shared<PBRMaterial>(oak_albedo, oak_rough, oak_metal, oak_normal);
+        make_pooled<PBRMaterial>(oak_albedo, oak_rough, oak_metal, oak_normal);
 
-    world.add(make_shared<sphere>(point3(-3.0, 0, 0), 1.2, mat_oak));
+    world.add(make_pooled<sphere>(point3(-3.0, 0, 0), 1.2, mat_oak));
 
     // 2. Brick Sphere (Middle)
     auto brick_albedo =
-        make_shared<image_texture>("tex/brick/red_brick_diff_1k.png");
+        make_pooled<image_texture>("tex/brick/red_brick_diff_1k.png");
     auto brick_rough =
-        make_shared<image_texture>("tex/brick/red_brick_rough_1k.png");
+        make_pooled<image_texture>("tex/brick/red_brick_rough_1k.png");
     auto brick_normal =
-        make_shared<image_texture>("tex/brick/red_brick_nor_dx_1k.png");
-    auto brick_metal = make_shared<solid_color>(0.0, 0.0, 0.0);
-    auto mat_brick = make_shared<PBRMaterial>(brick_albedo, brick_rough,
+        make_pooled<image_texture>("tex/brick/red_brick_nor_dx_1k.png");
+    auto brick_metal = make_pooled<solid_color>(0.0, 0.0, 0.0);
+    auto mat_brick = make_pooled<PBRMaterial>(brick_albedo, brick_rough,
                                               brick_metal, brick_normal);
 
-    world.add(make_shared<sphere>(point3(0, 0, 0), 1.2, mat_brick));
+    world.add(make_pooled<sphere>(point3(0, 0, 0), 1.2, mat_brick));
 
     // 3. Rusted Metal Sphere (Right)
     auto rust_albedo =
-        make_shared<image_texture>("tex/rust/rusty_metal_04_diff_1k.png");
+        make_pooled<image_texture>("tex/rust/rusty_metal_04_diff_1k.png");
     auto rust_rough =
-        make_shared<image_texture>("tex/rust/rusty_metal_04_rough_1k.png");
+        make_pooled<image_texture>("tex/rust/rusty_metal_04_rough_1k.png");
     auto rust_metal =
-        make_shared<image_texture>("tex/rust/rusty_metal_04_metal_1k.png");
+        make_pooled<image_texture>("tex/rust/rusty_metal_04_metal_1k.png");
     auto rust_normal =
-        make_shared<image_texture>("tex/rust/rusty_metal_04_nor_dx_1k.png");
-    auto mat_rust = make_shared<PBRMaterial>(rust_albedo, rust_rough,
+        make_pooled<image_texture>("tex/rust/rusty_metal_04_nor_dx_1k.png");
+    auto mat_rust = make_pooled<PBRMaterial>(rust_albedo, rust_rough,
                                              rust_metal, rust_normal);
 
-    world.add(make_shared<sphere>(point3(3.0, 0, 0), 1.2, mat_rust));
+    world.add(make_pooled<sphere>(point3(3.0, 0, 0), 1.2, mat_rust));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 // Scene 37: PBR Spheres Grid with Explicit Lights (for NEE/MIS)
 shared_ptr<hittable> pbr_spheres_grid_lights() {
     hittable_list world;
 
-    auto checker = make_shared<checker_texture>(color(0.2, 0.3, 0.1),
+    auto checker = make_pooled<checker_texture>(color(0.2, 0.3, 0.1),
                                                 color(0.5, 0.5, 0.5));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000,
-                                  make_shared<lambertian>(checker)));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000,
+                                  make_pooled<lambertian>(checker)));
 
     int rows = 7;
     int cols = 7;
@@ -1366,39 +1383,39 @@ shared_ptr<hittable> pbr_spheres_grid_lights() {
             double metallic_val = (double)row / (rows - 1);
             double roughness_val = clamp((double)col / (cols - 1), 0.05, 1.0);
 
-            auto albedo = make_shared<solid_color>(0.5, 0.0, 0.0);
-            auto roughness = make_shared<solid_color>(
+            auto albedo = make_pooled<solid_color>(0.5, 0.0, 0.0);
+            auto roughness = make_pooled<solid_color>(
                 roughness_val, roughness_val, roughness_val);
-            auto metallic = make_shared<solid_color>(metallic_val, metallic_val,
+            auto metallic = make_pooled<solid_color>(metallic_val, metallic_val,
                                                      metallic_val);
 
-            auto mat = make_shared<PBRMaterial>(albedo, roughness, metallic);
+            auto mat = make_pooled<PBRMaterial>(albedo, roughness, metallic);
 
             double x = (col - (cols - 1) / 2.0) * spacing;
             double z = (row - (rows - 1) / 2.0) * spacing;
 
-            world.add(make_shared<sphere>(point3(x, 1, z), 1.0, mat));
+            world.add(make_pooled<sphere>(point3(x, 1, z), 1.0, mat));
         }
     }
 
-    auto light_mat = make_shared<diffuse_light>(color(15, 15, 15));
+    auto light_mat = make_pooled<diffuse_light>(color(15, 15, 15));
 
     // Main Light (Top) - Quad
     // Center (0, 60, 0), Size 30x30
-    world.add(make_shared<flip_face>(
-        make_shared<xz_rect>(-15, 15, -15, 15, 60, light_mat)));
+    world.add(make_pooled<flip_face>(
+        make_pooled<xz_rect>(-15, 15, -15, 15, 60, light_mat)));
 
     // Side Light 1 (Left) - Quad
     // Center (-20, 10, 20), Size 6x6
-    world.add(make_shared<flip_face>(
-        make_shared<xz_rect>(-23, -17, 17, 23, 10, light_mat)));
+    world.add(make_pooled<flip_face>(
+        make_pooled<xz_rect>(-23, -17, 17, 23, 10, light_mat)));
 
     // Side Light 2 (Right) - Quad
     // Center (20, 10, 20), Size 6x6
-    world.add(make_shared<flip_face>(
-        make_shared<xz_rect>(17, 23, 17, 23, 10, light_mat)));
+    world.add(make_pooled<flip_face>(
+        make_pooled<xz_rect>(17, 23, 17, 23, 10, light_mat)));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> multi_light_demo() {
@@ -1406,79 +1423,79 @@ shared_ptr<hittable> multi_light_demo() {
 
     // 1. Environment / Stage
     // Floor: Checker texture
-    auto checker = make_shared<checker_texture>(color(0.1, 0.1, 0.1),
+    auto checker = make_pooled<checker_texture>(color(0.1, 0.1, 0.1),
                                                 color(0.5, 0.5, 0.5));
-    auto floor_mat = make_shared<lambertian>(checker);
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, floor_mat));
+    auto floor_mat = make_pooled<lambertian>(checker);
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, floor_mat));
 
     // Back Wall (Matte White)
-    auto white_wall = make_shared<lambertian>(color(0.73, 0.73, 0.73));
-    world.add(make_shared<xy_rect>(-10, 10, 0, 10, -5, white_wall));
+    auto white_wall = make_pooled<lambertian>(color(0.73, 0.73, 0.73));
+    world.add(make_pooled<xy_rect>(-10, 10, 0, 10, -5, white_wall));
 
     // 2. Podiums (Dark Grey Matte)
-    auto podium_mat = make_shared<lambertian>(color(0.2, 0.2, 0.2));
+    auto podium_mat = make_pooled<lambertian>(color(0.2, 0.2, 0.2));
 
     // Left Podium (Short)
     world.add(
-        make_shared<box>(point3(-3.5, 0, -1), point3(-1.5, 1, 1), podium_mat));
+        make_pooled<box>(point3(-3.5, 0, -1), point3(-1.5, 1, 1), podium_mat));
 
     // Center Podium (Tall)
-    world.add(make_shared<box>(point3(-1, 0, -1), point3(1, 2, 1), podium_mat));
+    world.add(make_pooled<box>(point3(-1, 0, -1), point3(1, 2, 1), podium_mat));
 
     // Right Podium (Medium)
     world.add(
-        make_shared<box>(point3(1.5, 0, -1), point3(3.5, 1.5, 1), podium_mat));
+        make_pooled<box>(point3(1.5, 0, -1), point3(3.5, 1.5, 1), podium_mat));
 
     // 3. Objects
     // Left: Glass Sphere (on Short Podium)
-    auto glass_mat = make_shared<dielectric>(1.5);
-    world.add(make_shared<sphere>(point3(-2.5, 1.8, 0), 0.8, glass_mat));
+    auto glass_mat = make_pooled<dielectric>(1.5);
+    world.add(make_pooled<sphere>(point3(-2.5, 1.8, 0), 0.8, glass_mat));
     // Inner bubble for interest
-    world.add(make_shared<sphere>(point3(-2.5, 1.8, 0), -0.6, glass_mat));
+    world.add(make_pooled<sphere>(point3(-2.5, 1.8, 0), -0.6, glass_mat));
 
     // Center: Gold Sphere (on Tall Podium) - The "Hero" object
     auto gold_mat =
-        make_shared<metal>(color(1.0, 0.71, 0.29), 0.05); // Slightly rough gold
-    world.add(make_shared<sphere>(point3(0, 2.8, 0), 0.8, gold_mat));
+        make_pooled<metal>(color(1.0, 0.71, 0.29), 0.05); // Slightly rough gold
+    world.add(make_pooled<sphere>(point3(0, 2.8, 0), 0.8, gold_mat));
 
     // Right: Rough Red Sphere (on Medium Podium)
-    auto rough_red = make_shared<lambertian>(color(0.65, 0.05, 0.05));
-    world.add(make_shared<sphere>(point3(2.5, 2.3, 0), 0.8, rough_red));
+    auto rough_red = make_pooled<lambertian>(color(0.65, 0.05, 0.05));
+    world.add(make_pooled<sphere>(point3(2.5, 2.3, 0), 0.8, rough_red));
 
     // 4. Visible Light Geometry (Quad Light Source)
     // Positioned top-right, angled towards center
     // We'll define the actual light in select_scene, this is just the visible
     // mesh
-    auto light_mat = make_shared<diffuse_light>(color(8, 8, 10)); // Cool white
+    auto light_mat = make_pooled<diffuse_light>(color(8, 8, 10)); // Cool white
     // A panel floating top right: Center approx (4, 6, 2)
     // Let's make it look like a softbox
     world.add(
-        make_shared<flip_face>(make_shared<xz_rect>(2, 6, 0, 4, 6, light_mat)));
+        make_pooled<flip_face>(make_pooled<xz_rect>(2, 6, 0, 4, 6, light_mat)));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> cmy_shadows_demo() {
     hittable_list world;
 
     // White Wall (Back)
-    auto white_mat = make_shared<lambertian>(color(1.0, 1.0, 1.0));
-    world.add(make_shared<xy_rect>(-10, 10, 0, 10, -2, white_mat));
+    auto white_mat = make_pooled<lambertian>(color(1.0, 1.0, 1.0));
+    world.add(make_pooled<xy_rect>(-10, 10, 0, 10, -2, white_mat));
 
     // White Floor
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, white_mat));
+    world.add(make_pooled<sphere>(point3(0, -1000, 0), 1000, white_mat));
 
     // Central Occluder (Sphere)
     // Placed slightly above ground
-    auto occluder_mat = make_shared<lambertian>(color(1.0, 1.0, 1.0));
-    world.add(make_shared<sphere>(point3(0, 1.5, 2), 1.0, occluder_mat));
+    auto occluder_mat = make_pooled<lambertian>(color(1.0, 1.0, 1.0));
+    world.add(make_pooled<sphere>(point3(0, 1.5, 2), 1.0, occluder_mat));
 
     // Rod holding the sphere (optional, for realism)
-    auto rod_mat = make_shared<metal>(color(0.7, 0.7, 0.7), 0.1);
+    auto rod_mat = make_pooled<metal>(color(0.7, 0.7, 0.7), 0.1);
     world.add(
-        make_shared<box>(point3(-0.1, 0, 1.9), point3(0.1, 0.5, 2.1), rod_mat));
+        make_pooled<box>(point3(-0.1, 0, 1.9), point3(0.1, 0.5, 2.1), rod_mat));
 
-    return make_shared<bvh_node>(world, 0, 1);
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 shared_ptr<hittable> infinity_mirror_demo() {
@@ -1486,38 +1503,160 @@ shared_ptr<hittable> infinity_mirror_demo() {
 
     // Mirror Room
     auto mirror =
-        make_shared<metal>(color(0.95, 0.95, 0.95), 0.0); // Perfect mirror
-    auto dark_floor = make_shared<lambertian>(color(0.05, 0.05, 0.05));
+        make_pooled<metal>(color(0.95, 0.95, 0.95), 0.0); // Perfect mirror
+    auto dark_floor = make_pooled<lambertian>(color(0.05, 0.05, 0.05));
 
     // Floor
-    world.add(make_shared<xz_rect>(-5, 5, -5, 5, 0, dark_floor));
+    world.add(make_pooled<xz_rect>(-5, 5, -5, 5, 0, dark_floor));
     // Ceiling
-    world.add(make_shared<xz_rect>(-5, 5, -5, 5, 5, mirror));
+    world.add(make_pooled<xz_rect>(-5, 5, -5, 5, 5, mirror));
     // Back Wall
-    world.add(make_shared<xy_rect>(-5, 5, 0, 5, -5, mirror));
+    world.add(make_pooled<xy_rect>(-5, 5, 0, 5, -5, mirror));
     // Left Wall
-    world.add(make_shared<yz_rect>(0, 5, -5, 5, -5, mirror));
+    world.add(make_pooled<yz_rect>(0, 5, -5, 5, -5, mirror));
     // Right Wall
-    world.add(make_shared<yz_rect>(0, 5, -5, 5, 5, mirror));
+    world.add(make_pooled<yz_rect>(0, 5, -5, 5, 5, mirror));
     // Front Wall (behind camera, to close the box)
     // We leave a gap or make it one-way? Let's just close it.
     // The camera will be inside.
-    world.add(make_shared<xy_rect>(-5, 5, 0, 5, 5, mirror));
+    world.add(make_pooled<xy_rect>(-5, 5, 0, 5, 5, mirror));
 
     // Glowing Objects Inside
-    auto light_red = make_shared<diffuse_light>(color(4, 0.5, 0.5));
-    auto light_blue = make_shared<diffuse_light>(color(0.5, 0.5, 4));
-    auto light_green = make_shared<diffuse_light>(color(0.5, 4, 0.5));
+    auto light_red = make_pooled<diffuse_light>(color(4, 0.5, 0.5));
+    auto light_blue = make_pooled<diffuse_light>(color(0.5, 0.5, 4));
+    auto light_green = make_pooled<diffuse_light>(color(0.5, 4, 0.5));
 
-    world.add(make_shared<sphere>(point3(-2, 1, 0), 0.5, light_red));
-    world.add(make_shared<sphere>(point3(2, 1, 0), 0.5, light_blue));
-    world.add(make_shared<sphere>(point3(0, 3, -2), 0.5, light_green));
+    world.add(make_pooled<sphere>(point3(-2, 1, 0), 0.5, light_red));
+    world.add(make_pooled<sphere>(point3(2, 1, 0), 0.5, light_blue));
+    world.add(make_pooled<sphere>(point3(0, 3, -2), 0.5, light_green));
 
     // Central Object
-    auto chrome = make_shared<metal>(color(0.8, 0.8, 0.8), 0.1);
-    world.add(make_shared<sphere>(point3(0, 1, 0), 1.0, chrome));
+    auto chrome = make_pooled<metal>(color(0.8, 0.8, 0.8), 0.1);
+    world.add(make_pooled<sphere>(point3(0, 1, 0), 1.0, chrome));
+
+    return make_pooled<bvh_node>(world, 0, 1);
+}
+
+// Instancing Demo: 上万个实例共享同一个 BLAS，
+// 内存中只保存一份几何体和一份底层 BVH
+shared_ptr<hittable> instancing_demo() {
+    hittable_list world;
+
+    auto ground = make_pooled<lambertian>(color(0.35, 0.3, 0.25));
+    world.add(make_pooled<xz_rect>(-300, 300, -300, 300, 0, ground));
+
+    // 共享的几何体：树干 + 由小球组成的树冠
+    hittable_list tree;
+    auto bark = make_pooled<lambertian>(color(0.4, 0.25, 0.1));
+    auto leaves = make_pooled<lambertian>(color(0.15, 0.5, 0.15));
+    tree.add(make_pooled<box>(point3(-0.15, 0, -0.15), point3(0.15, 1.5, 0.15),
+                              bark));
+    for (int i = 0; i < 64; i++) {
+        vec3 offset = random_in_unit_sphere();
+        tree.add(make_pooled<sphere>(point3(0, 2.2, 0) + offset,
+                                     random_double(0.25, 0.45), leaves));
+    }
+    auto blas = make_blas(tree, 0, 1);
+
+    hittable_list instances;
+    const int trees_per_side = 100;
+    for (int i = 0; i < trees_per_side; i++) {
+        for (int j = 0; j < trees_per_side; j++) {
+            vec3 position(-200 + i * 4 + random_double(-1, 1), 0,
+                          -200 + j * 4 + random_double(-1, 1));
+            affine_transform to_world =
+                affine_transform::translation(position) *
+                affine_transform::rotation(vec3(random_double(-0.1, 0.1), 1,
+                                                random_double(-0.1, 0.1)),
+                                           random_double(0, 360)) *
+                affine_transform::scaling(random_double(0.6, 1.4));
+            instances.add(make_pooled<instance>(blas, to_world));
+        }
+    }
+    world.add(make_pooled<bvh_node>(instances, 0, 1));
+
+    return make_pooled<bvh_node>(world, 0, 1);
+}
+
+// 程序生成的圆环网格，找不到 OBJ 模型时代替使用
+static shared_ptr<triangle_mesh> torus_mesh(double major_radius,
+                                            double minor_radius, int rings,
+                                            int sides,
+                                            shared_ptr<material> m) {
+    mesh_data data;
+    for (int i = 0; i <= rings; i++) {
+        double u = 2 * pi * i / rings;
+        for (int j = 0; j <= sides; j++) {
+            double v = 2 * pi * j / sides;
+            vec3 normal(cos(u) * cos(v), sin(v), sin(u) * cos(v));
+            point3 center(major_radius * cos(u), minor_radius,
+                          major_radius * sin(u));
+            point3 p = center + minor_radius * normal;
+            data.positions.insert(data.positions.end(),
+                                  {float(p.x()), float(p.y()), float(p.z())});
+            data.normals.insert(
+                data.normals.end(),
+                {float(normal.x()), float(normal.y()), float(normal.z())});
+            data.uvs.insert(data.uvs.end(),
+                            {float(i) / rings, float(j) / sides});
+        }
+    }
+    for (int i = 0; i < rings; i++) {
+        for (int j = 0; j < sides; j++) {
+            uint32_t a = i * (sides + 1) + j;
+            uint32_t b = a + sides + 1;
+            data.indices.insert(data.indices.end(),
+                                {a, a + 1, b, b, a + 1, b + 1});
+        }
+    }
+    return make_pooled<triangle_mesh>(std::move(data), m);
+}
+
+// Mesh Demo: 加载 OBJ 模型（首次加载后写出 .rtmesh 缓存，之后直接映射），
+// 缩放到统一大小后用实例摆放三份。模型路径取环境变量 RT_MESH_OBJ，
+// 未设置时找当前目录下的 bunny.obj，都没有时用程序生成的圆环代替
+shared_ptr<hittable> mesh_demo() {
+    hittable_list world;
+
+    auto checker = make_pooled<checker_texture>(color(0.2, 0.3, 0.1),
+                                                color(0.9, 0.9, 0.9));
+    world.add(make_pooled<xz_rect>(-20, 20, -20, 20, 0,
+                                   make_pooled<lambertian>(checker)));
+
+    auto model_material = make_pooled<metal>(color(0.8, 0.6, 0.3), 0.2);
+    const char *env_path = std::getenv("RT_MESH_OBJ");
+    const char *path = env_path ? env_path : "bunny.obj";
+    shared_ptr<hittable> model;
+    if (env_path || std::ifstream(path).good()) {
+        model = load_obj_cached(path, model_material);
+    }
+    if (!model) {
+        if (!env_path) {
+            std::cout << "Mesh demo: no '" << path
+                      << "' found (set RT_MESH_OBJ to choose a model), "
+                         "using a procedural torus."
+                      << std::endl;
+        }
+        model = torus_mesh(1.0, 0.35, 256, 64, model_material);
+    }
 
-    return make_shared<bvh_node>(world, 0, 1);
+    // 把模型底面中心移到原点，最长边缩放到 2
+    aabb box;
+    model->bounding_box(0, 1, box);
+    vec3 extent = box.max() - box.min();
+    double scale = 2.0 / std::max({extent.x(), extent.y(), extent.z()});
+    vec3 base(0.5 * (box.min().x() + box.max().x()), box.min().y(),
+              0.5 * (box.min().z() + box.max().z()));
+    affine_transform fit = affine_transform::scaling(scale) *
+                           affine_transform::translation(-base);
+
+    for (int i = -1; i <= 1; i++) {
+        world.add(make_pooled<instance>(
+            model, affine_transform::translation(vec3(2.5 * i, 0, 0)) *
+                       affine_transform::rotation_y(30.0 * i) * fit));
+    }
+
+    return make_pooled<bvh_node>(world, 0, 1);
 }
 
 SceneConfig select_scene(int scene_id) {
@@ -1658,7 +1797,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookat = point3(0, 1, 0);
         config.vfov = 30.0;
         config.lights.push_back(
-            make_shared<PointLight>(point3(0, 6, 2), color(50, 50, 50)));
+            make_pooled<PointLight>(point3(0, 6, 2), color(50, 50, 50)));
         break;
 
     case 16:
@@ -1672,7 +1811,7 @@ SceneConfig select_scene(int scene_id) {
         config.vfov = 30.0;
         // Add PointLight (NEE sampling)
         config.lights.push_back(
-            make_shared<PointLight>(point3(5, 10, 5), color(100, 100, 100)));
+            make_pooled<PointLight>(point3(5, 10, 5), color(100, 100, 100)));
         break;
 
     case 17:
@@ -1685,7 +1824,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookat = point3(0, 2, 0);
         config.vfov = 30.0;
         config.lights.push_back(
-            make_shared<DirectionalLight>(vec3(-1, -1, -0.5), color(3, 3, 3)));
+            make_pooled<DirectionalLight>(vec3(-1, -1, -0.5), color(3, 3, 3)));
         break;
     case 18:
         config.world = spot_light_scene();
@@ -1696,7 +1835,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookfrom = point3(0, 5, 10);
         config.lookat = point3(0, 1, 0);
         config.vfov = 30.0;
-        config.lights.push_back(make_shared<SpotLight>(
+        config.lights.push_back(make_pooled<SpotLight>(
             point3(0, 8, 4), vec3(0, -1, -0.5), 20.0, color(2000, 2000, 2000)));
         break;
     case 19:
@@ -1708,7 +1847,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookfrom = point3(0, 2, 10);
         config.lookat = point3(0, 1, 0);
         config.vfov = 30.0;
-        config.lights.push_back(make_shared<EnvironmentLight>("sky.hdr"));
+        config.lights.push_back(make_pooled<EnvironmentLight>("sky.hdr"));
         break;
     case 20:
         config.world = quad_light_scene();
@@ -1722,7 +1861,7 @@ SceneConfig select_scene(int scene_id) {
         // Add QuadLight (NEE sampling)
         // Q = (-2, 7, -2), u = (4, 0, 0), v = (0, 0, 4)
         config.lights.push_back(
-            make_shared<QuadLight>(point3(-2, 7, -2), vec3(4, 0, 0),
+            make_pooled<QuadLight>(point3(-2, 7, -2), vec3(4, 0, 0),
                                    vec3(0, 0, 4), color(15, 15, 15)));
         break;
 
@@ -1739,7 +1878,7 @@ SceneConfig select_scene(int scene_id) {
         // Add QuadLight: xz_rect(213, 343, 227, 332, 554)
         // Q = (213, 554, 227), u = (130, 0, 0), v = (0, 0, 105)
         config.lights.push_back(
-            make_shared<QuadLight>(point3(213, 554, 227), vec3(130, 0, 0),
+            make_pooled<QuadLight>(point3(213, 554, 227), vec3(130, 0, 0),
                                    vec3(0, 0, 105), color(15, 15, 15)));
         break;
 
@@ -1755,7 +1894,7 @@ SceneConfig select_scene(int scene_id) {
         // Add QuadLight: xz_rect(123, 423, 147, 412, 554)
         // Q = (123, 554, 147), u = (300, 0, 0), v = (0, 0, 265)
         config.lights.push_back(
-            make_shared<QuadLight>(point3(123, 554, 147), vec3(300, 0, 0),
+            make_pooled<QuadLight>(point3(123, 554, 147), vec3(300, 0, 0),
                                    vec3(0, 0, 265), color(7, 7, 7)));
         break;
 
@@ -1771,12 +1910,12 @@ SceneConfig select_scene(int scene_id) {
 
         // Large Light (Top)
         config.lights.push_back(
-            make_shared<QuadLight>(point3(-10, 10, -10), vec3(20, 0, 0),
+            make_pooled<QuadLight>(point3(-10, 10, -10), vec3(20, 0, 0),
                                    vec3(0, 0, 20), color(5, 5, 5)));
 
         // Small Light (Right)
         config.lights.push_back(
-            make_shared<QuadLight>(point3(6, 4, 2), vec3(0, 0.5, 0),
+            make_pooled<QuadLight>(point3(6, 4, 2), vec3(0, 0.5, 0),
                                    vec3(0, 0, 0.5), color(50, 50, 50)));
         break;
 
@@ -1790,7 +1929,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookat = point3(0, 1, 0);
         config.vfov = 30.0;
         config.lights.push_back(
-            make_shared<EnvironmentLight>("brown_photostudio_02_4k.hdr"));
+            make_pooled<EnvironmentLight>("brown_photostudio_02_4k.hdr"));
         break;
 
     case 25: // cedar_bridge_sunset_2_4k.hdr
@@ -1803,7 +1942,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookat = point3(0, 1, 0);
         config.vfov = 30.0;
         config.lights.push_back(
-            make_shared<EnvironmentLight>("cedar_bridge_sunset_2_4k.hdr"));
+            make_pooled<EnvironmentLight>("cedar_bridge_sunset_2_4k.hdr"));
         break;
 
     case 26: // rnl_probe.hdr
@@ -1815,7 +1954,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookfrom = point3(0, 3, 10);
         config.lookat = point3(0, 1, 0);
         config.vfov = 30.0;
-        config.lights.push_back(make_shared<EnvironmentLight>("rnl_probe.hdr"));
+        config.lights.push_back(make_pooled<EnvironmentLight>("rnl_probe.hdr"));
         break;
 
     case 27: // stpeters_probe.hdr
@@ -1828,7 +1967,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookat = point3(0, 1, 0);
         config.vfov = 30.0;
         config.lights.push_back(
-            make_shared<EnvironmentLight>("stpeters_probe.hdr"));
+            make_pooled<EnvironmentLight>("stpeters_probe.hdr"));
         break;
 
     case 28: // uffizi_probe.hdr
@@ -1841,7 +1980,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookat = point3(0, 1, 0);
         config.vfov = 30.0;
         config.lights.push_back(
-            make_shared<EnvironmentLight>("uffizi_probe.hdr"));
+            make_pooled<EnvironmentLight>("uffizi_probe.hdr"));
         break;
 
         // ========================================================================
@@ -1858,7 +1997,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookat = point3(0, 1, 0);
         config.vfov = 35.0;
         config.lights.push_back(
-            make_shared<EnvironmentLight>("brown_photostudio_02_4k.hdr"));
+            make_pooled<EnvironmentLight>("brown_photostudio_02_4k.hdr"));
         break;
 
     case 31: // Cornell Box Extended - 扩展康奈尔盒
@@ -1873,7 +2012,7 @@ SceneConfig select_scene(int scene_id) {
         config.aperture = 0.0;
         // QuadLight 对应顶部灯
         config.lights.push_back(
-            make_shared<QuadLight>(point3(213, 554, 227), vec3(130, 0, 0),
+            make_pooled<QuadLight>(point3(213, 554, 227), vec3(130, 0, 0),
                                    vec3(0, 0, 105), color(15, 15, 15)));
         break;
 
@@ -1887,10 +2026,10 @@ SceneConfig select_scene(int scene_id) {
         config.lookat = point3(0, 2, 0);
         config.vfov = 50.0;
         // 天花板面光源
-        config.lights.push_back(make_shared<QuadLight>(
+        config.lights.push_back(make_pooled<QuadLight>(
             point3(-1, 7.99, 0), vec3(2, 0, 0), vec3(0, 0, 2), color(8, 8, 7)));
         // 聚光灯照亮桌面
-        config.lights.push_back(make_shared<SpotLight>(
+        config.lights.push_back(make_pooled<SpotLight>(
             point3(0, 6, 4), vec3(0, -1, -0.3), 25.0, color(800, 800, 750)));
         break;
 
@@ -1904,7 +2043,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookat = point3(0, 0.8, 0);
         config.vfov = 35.0;
         config.lights.push_back(
-            make_shared<EnvironmentLight>("brown_photostudio_02_4k.hdr"));
+            make_pooled<EnvironmentLight>("brown_photostudio_02_4k.hdr"));
         break;
 
     case 34: // Glass Caustics Scene - 玻璃焦散场景
@@ -1918,7 +2057,7 @@ SceneConfig select_scene(int scene_id) {
         config.vfov = 40.0;
         // 顶部面光源
         config.lights.push_back(
-            make_shared<QuadLight>(point3(-3, 10, -3), vec3(6, 0, 0),
+            make_pooled<QuadLight>(point3(-3, 10, -3), vec3(6, 0, 0),
                                    vec3(0, 0, 6), color(12, 12, 12)));
         break;
 
@@ -1935,7 +2074,7 @@ SceneConfig select_scene(int scene_id) {
         // 改用面光源 (QuadLight) 以获得软阴影和更好的 MIS 效果
         // 位于上方，面积 4x4，强度 25
         config.lights.push_back(
-            make_shared<QuadLight>(point3(-2, 10, -2), vec3(4, 0, 0),
+            make_pooled<QuadLight>(point3(-2, 10, -2), vec3(4, 0, 0),
                                    vec3(0, 0, 4), color(25, 25, 25)));
         break;
 
@@ -1951,7 +2090,7 @@ SceneConfig select_scene(int scene_id) {
 
         // 使用 HDR 环境光
         config.lights.push_back(
-            make_shared<EnvironmentLight>("brown_photostudio_02_4k.hdr"));
+            make_pooled<EnvironmentLight>("brown_photostudio_02_4k.hdr"));
         break;
 
     case 37: // PBR Spheres Grid with NEE/MIS
@@ -1968,17 +2107,17 @@ SceneConfig select_scene(int scene_id) {
         // Add QuadLights
         // Main Light: Q=(-15, 60, -15), u=(30, 0, 0), v=(0, 0, 30)
         config.lights.push_back(
-            make_shared<QuadLight>(point3(-15, 60, -15), vec3(30, 0, 0),
+            make_pooled<QuadLight>(point3(-15, 60, -15), vec3(30, 0, 0),
                                    vec3(0, 0, 30), color(15, 15, 15)));
 
         // Side Light 1: Q=(-23, 10, 17), u=(6, 0, 0), v=(0, 0, 6)
         config.lights.push_back(
-            make_shared<QuadLight>(point3(-23, 10, 17), vec3(6, 0, 0),
+            make_pooled<QuadLight>(point3(-23, 10, 17), vec3(6, 0, 0),
                                    vec3(0, 0, 6), color(15, 15, 15)));
 
         // Side Light 2: Q=(17, 10, 17), u=(6, 0, 0), v=(0, 0, 6)
         config.lights.push_back(
-            make_shared<QuadLight>(point3(17, 10, 17), vec3(6, 0, 0),
+            make_pooled<QuadLight>(point3(17, 10, 17), vec3(6, 0, 0),
                                    vec3(0, 0, 6), color(15, 15, 15)));
         break;
 
@@ -1995,7 +2134,7 @@ SceneConfig select_scene(int scene_id) {
         // Add QuadLight for NEE
         // Center(0, 8, 0), Size 4x4 -> Q(-2, 8, -2), u(4, 0, 0), v(0, 0, 4)
         config.lights.push_back(
-            make_shared<QuadLight>(point3(-2, 8, -2), vec3(4, 0, 0),
+            make_pooled<QuadLight>(point3(-2, 8, -2), vec3(4, 0, 0),
                                    vec3(0, 0, 4), color(10, 10, 10)));
         break;
 
@@ -2009,7 +2148,7 @@ SceneConfig select_scene(int scene_id) {
         config.lookat = point3(0, 0.8, 0);
         config.vfov = 35.0;
         config.lights.push_back(
-            make_shared<EnvironmentLight>("brown_photostudio_02_4k.hdr"));
+            make_pooled<EnvironmentLight>("brown_photostudio_02_4k.hdr"));
         break;
 
     case 40: // Multi-Light Demo
@@ -2025,24 +2164,24 @@ SceneConfig select_scene(int scene_id) {
 
         // 1. Spot Light (Main Key Light for Center Gold Sphere)
         // Positioned high up, targeting the gold sphere (0, 2.8, 0)
-        config.lights.push_back(make_shared<SpotLight>(
+        config.lights.push_back(make_pooled<SpotLight>(
             point3(0, 10, 2), vec3(0, -1, -0.1), 25.0, color(80, 80, 70)));
 
         // 2. Point Light (Warm Accent for Right Rough Sphere)
         // Positioned near the right sphere to create dramatic side lighting
         config.lights.push_back(
-            make_shared<PointLight>(point3(4, 4, 2), color(30, 15, 5)));
+            make_pooled<PointLight>(point3(4, 4, 2), color(30, 15, 5)));
 
         // 3. Quad Light (Cool Fill/Softbox for Left Glass Sphere)
         // Matches geometry: xz_rect(2, 6, 0, 4, 6) -> Q=(2, 6, 0), u=(4, 0, 0),
         // v=(0, 0, 4) Note: The geometry was xz_rect(2, 6, 0, 4, 6) which means
         // x in [2,6], z in [0,4], y=6 Q=(2, 6, 0), u=(4, 0, 0), v=(0, 0, 4)
-        config.lights.push_back(make_shared<QuadLight>(
+        config.lights.push_back(make_pooled<QuadLight>(
             point3(2, 6, 0), vec3(4, 0, 0), vec3(0, 0, 4), color(8, 8, 10)));
 
         // 4. Directional Light (Rim Light / Moon)
         // Coming from behind-left
-        config.lights.push_back(make_shared<DirectionalLight>(
+        config.lights.push_back(make_pooled<DirectionalLight>(
             vec3(1, -0.5, -1), color(0.1, 0.1, 0.3)));
         break;
 
@@ -2060,13 +2199,13 @@ SceneConfig select_scene(int scene_id) {
         // All at same height (y=5), spread wider for clearer separation
         // Red (Left)
         config.lights.push_back(
-            make_shared<PointLight>(point3(-2.5, 5, 5), color(40, 0, 0)));
+            make_pooled<PointLight>(point3(-2.5, 5, 5), color(40, 0, 0)));
         // Green (Back Center) - moved back in Z to create depth separation
         config.lights.push_back(
-            make_shared<PointLight>(point3(0, 5, 8), color(0, 40, 0)));
+            make_pooled<PointLight>(point3(0, 5, 8), color(0, 40, 0)));
         // Blue (Right)
         config.lights.push_back(
-            make_shared<PointLight>(point3(2.5, 5, 5), color(0, 0, 40)));
+            make_pooled<PointLight>(point3(2.5, 5, 5), color(0, 0, 40)));
         break;
 
     case 42: // Infinity Mirror Room
@@ -2082,6 +2221,28 @@ SceneConfig select_scene(int scene_id) {
         // No external lights, lit by emissive spheres
         break;
 
+    case 43: // Instancing Demo - 共享 BLAS 的大规模实例
+        config.world = instancing_demo();
+        config.aspect_ratio = 16.0 / 9.0;
+        config.image_width = 800;
+        config.samples_per_pixel = 100;
+        config.background = color(0.70, 0.80, 1.00);
+        config.lookfrom = point3(0, 25, 90);
+        config.lookat = point3(0, 0, 0);
+        config.vfov = 40.0;
+        break;
+
+    case 44: // Mesh Demo - OBJ 三角网格
+        config.world = mesh_demo();
+        config.aspect_ratio = 16.0 / 9.0;
+        config.image_width = 800;
+        config.samples_per_pixel = 100;
+        config.background = color(0.70, 0.80, 1.00);
+        config.lookfrom = point3(0, 4, 10);
+        config.lookat = point3(0, 1, 0);
+        config.vfov = 35.0;
+        break;
+
     case 10:
     default:
         config.world = two_perlin_spheres();
@@ -65,5 +65,7 @@ shared_ptr<hittable> multi_light_demo();
 // Fun Demos
 shared_ptr<hittable> cmy_shadows_demo();
 shared_ptr<hittable> infinity_mirror_demo();
+shared_ptr<hittable> instancing_demo();
+shared_ptr<hittable> mesh_demo();
 
 #endif
\ No newline at end of file